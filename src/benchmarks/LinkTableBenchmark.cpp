@@ -0,0 +1,108 @@
+/**
+ * @file LinkTableBenchmark.cpp
+ * @brief Measures the throughput of the batched inertia computation of LinkTable, compared with
+ * the per-link computation it replaces.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/LinkTable.h>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/Geometry>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+namespace {
+
+struct LinkSample {
+    double mass;
+    Eigen::Vector3d com;
+    Eigen::Matrix3d inertia;
+    Eigen::Matrix3d csysPart_R_link;
+    Eigen::Vector3d csysPart_p_link;
+};
+
+std::vector<LinkSample> generateLinks(std::size_t nr_of_links)
+{
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> uniform(0.1, 1.0);
+    std::vector<LinkSample> links(nr_of_links);
+    for (auto& link : links) {
+        link.mass = uniform(generator);
+        link.com = Eigen::Vector3d::Random() * 100.0;
+        const Eigen::Matrix3d R = Eigen::Quaterniond::UnitRandom().toRotationMatrix();
+        const Eigen::Vector3d moments(uniform(generator), uniform(generator), uniform(generator));
+        link.inertia = R * moments.asDiagonal() * R.transpose() * 1e3;
+        link.csysPart_R_link = Eigen::Quaterniond::UnitRandom().toRotationMatrix();
+        link.csysPart_p_link = Eigen::Vector3d::Random() * 0.1;
+    }
+    return links;
+}
+
+template <class Function>
+double measureSeconds(std::size_t repetitions, Function&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < repetitions; r++) {
+        fn();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t nr_of_links = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    const std::size_t repetitions = 100;
+    const std::array<double, 3> scale{ 0.001, 0.001, 0.001 };
+    const Eigen::Array3d s(scale[0], scale[1], scale[2]);
+    const auto links = generateLinks(nr_of_links);
+
+    LinkTable table;
+    table.reserve(nr_of_links);
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        table.add("link" + std::to_string(l), links[l].mass, links[l].com, links[l].inertia, links[l].csysPart_R_link, links[l].csysPart_p_link);
+    }
+
+    const double batch_seconds = measureSeconds(repetitions, [&]() { table.computeInertias(scale); });
+
+    // Per-link computation, as done during the traversal before the link table
+    std::vector<Eigen::Vector3d> coms(nr_of_links);
+    std::vector<Eigen::Matrix3d> inertias(nr_of_links);
+    std::vector<bool> consistent(nr_of_links);
+    const double per_link_seconds = measureSeconds(repetitions, [&]() {
+        for (std::size_t l = 0; l < nr_of_links; l++) {
+            const auto& R = links[l].csysPart_R_link;
+            Eigen::Matrix3d scaled = links[l].inertia;
+            scaled.array().colwise() *= s;
+            scaled.array().rowwise() *= s.transpose();
+            coms[l] = R.transpose() * ((links[l].com.array() * s).matrix() - links[l].csysPart_p_link);
+            inertias[l] = R.transpose() * scaled * R;
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+            solver.computeDirect(inertias[l], Eigen::EigenvaluesOnly);
+            const Eigen::Vector3d& m = solver.eigenvalues();
+            consistent[l] = links[l].mass > 0.0 && m.minCoeff() >= 0.0 && m(0) + m(1) >= m(2);
+        }
+    });
+
+    double max_error = 0.0;
+    std::size_t consistency_mismatches = 0;
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        consistency_mismatches += table.isPhysicallyConsistent(l) != consistent[l] ? 1 : 0;
+        max_error = std::max(max_error, (table.getCenterOfMass(l) - coms[l]).cwiseAbs().maxCoeff());
+        max_error = std::max(max_error, (table.getInertia(l) - inertias[l]).cwiseAbs().maxCoeff());
+    }
+
+    std::cout << "Links: " << nr_of_links << std::endl;
+    std::cout << "Batched: " << batch_seconds * 1e3 << " ms, " << nr_of_links / batch_seconds << " links/s" << std::endl;
+    std::cout << "Per link: " << per_link_seconds * 1e3 << " ms, " << nr_of_links / per_link_seconds << " links/s" << std::endl;
+    std::cout << "Max difference: " << max_error << ", consistency mismatches: " << consistency_mismatches << std::endl;
+    return max_error < 1e-12 && consistency_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file NameMapBenchmark.cpp
+ * @brief Measures memory and lookup time of the link and joint bookkeeping on a synthetic chain of links,
+ * comparing NameMap with the std::map keyed by strings it replaces.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/NameInterner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+
+namespace {
+
+std::size_t allocated_bytes = 0; ///< Bytes currently allocated through CountingAllocator.
+
+/**
+ * @brief Allocator counting the bytes allocated by the containers under test.
+ */
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        allocated_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, std::size_t n)
+    {
+        allocated_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(ptr, n);
+    }
+};
+
+template <class T, class U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) { return false; }
+
+using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+template <class T>
+using CountedStringMap = std::map<CountedString, T, std::less<CountedString>, CountingAllocator<std::pair<const CountedString, T>>>;
+
+/**
+ * @brief Stand-in for JointInfo before the name interner, holding copies of the part names.
+ */
+struct JointRecord {
+    CountedString datum_name;
+    CountedString parent_link_name;
+    CountedString child_link_name;
+};
+
+/**
+ * @brief Stand-in for JointInfo, holding the ids of the part names.
+ */
+struct InternedJointRecord {
+    CountedString datum_name;
+    NameInterner::Id parent_link_id;
+    NameInterner::Id child_link_id;
+};
+
+/**
+ * @brief Stand-in for LinkInfo, holding the same strings.
+ */
+struct LinkRecord {
+    CountedString name;
+    CountedString link_frame_name;
+};
+
+template <class T>
+using CountedNameMap = NameMap<T, CountingAllocator<T>>;
+
+std::string partName(std::size_t l)
+{
+    return "SIM_ROBOT_PART_" + std::to_string(l) + "_PRT";
+}
+
+CountedString toCounted(const std::string& text)
+{
+    return CountedString(text.begin(), text.end());
+}
+
+void fill(std::size_t nr_of_links, CountedStringMap<LinkRecord>& links, CountedStringMap<JointRecord>& joints)
+{
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        const CountedString part_name = toCounted(partName(l));
+        links.insert(std::make_pair(part_name, LinkRecord{ toCounted("link_" + std::to_string(l)), "CSYS" }));
+        if (l > 0) {
+            const CountedString parent_name = toCounted(partName(l - 1));
+            joints.insert(std::make_pair(parent_name + "--" + part_name, JointRecord{ toCounted("AXIS_" + std::to_string(l)), parent_name, part_name }));
+        }
+    }
+}
+
+void fill(std::size_t nr_of_links, CountedNameMap<LinkRecord>& links, CountedNameMap<InternedJointRecord>& joints)
+{
+    auto& names = *links.getNames();
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        const std::string part_name = partName(l);
+        links.insert(std::make_pair(part_name, LinkRecord{ toCounted("link_" + std::to_string(l)), "CSYS" }));
+        if (l > 0) {
+            const std::string parent_name = partName(l - 1);
+            joints.insert(std::make_pair(parent_name + "--" + part_name,
+                                         InternedJointRecord{ toCounted("AXIS_" + std::to_string(l)), names.intern(parent_name), names.intern(part_name) }));
+        }
+    }
+}
+
+/**
+ * @brief Looks up the parent and child links of every joint, as done when the joints are added to the model.
+ */
+std::size_t resolveJoints(const CountedStringMap<LinkRecord>& links, const CountedStringMap<JointRecord>& joints,
+                          const std::vector<CountedString>& joint_names)
+{
+    std::size_t found = 0;
+    for (const auto& joint_name : joint_names) {
+        const auto joint = joints.find(joint_name);
+        if (joint != joints.end() && links.find(joint->second.parent_link_name) != links.end() &&
+            links.find(joint->second.child_link_name) != links.end()) {
+            found++;
+        }
+    }
+    return found;
+}
+
+std::size_t resolveJoints(const CountedNameMap<LinkRecord>& links, const CountedNameMap<InternedJointRecord>& joints,
+                          const std::vector<std::string>& joint_names)
+{
+    std::size_t found = 0;
+    for (const auto& joint_name : joint_names) {
+        const auto joint = joints.find(joint_name);
+        if (joint != joints.end() && links.find(joint->second.parent_link_id) != links.end() &&
+            links.find(joint->second.child_link_id) != links.end()) {
+            found++;
+        }
+    }
+    return found;
+}
+
+template <class Function>
+double measureSeconds(std::size_t repetitions, Function&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < repetitions; r++) {
+        fn();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t nr_of_links = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    const std::size_t repetitions = 20;
+
+    std::vector<std::string> joint_names;
+    for (std::size_t l = 1; l < nr_of_links; l++) {
+        joint_names.push_back(partName(l - 1) + "--" + partName(l));
+    }
+    std::shuffle(joint_names.begin(), joint_names.end(), std::mt19937(0));
+    std::vector<CountedString> counted_joint_names;
+    for (const auto& joint_name : joint_names) {
+        counted_joint_names.push_back(toCounted(joint_name));
+    }
+
+    // The bytes allocated by the maps and by the strings they hold, the table of names reports its own usage
+    std::size_t bytes_before = allocated_bytes;
+    CountedStringMap<LinkRecord> string_links;
+    CountedStringMap<JointRecord> string_joints;
+    fill(nr_of_links, string_links, string_joints);
+    const std::size_t string_map_bytes = allocated_bytes - bytes_before;
+
+    bytes_before = allocated_bytes;
+    auto names = std::make_shared<NameInterner>();
+    CountedNameMap<LinkRecord> interned_links(names);
+    CountedNameMap<InternedJointRecord> interned_joints(names);
+    fill(nr_of_links, interned_links, interned_joints);
+    const std::size_t name_map_bytes = allocated_bytes - bytes_before + names->getMemoryUsage();
+
+    std::size_t string_found = 0, interned_found = 0;
+    const double string_map_seconds = measureSeconds(repetitions, [&]() { string_found = resolveJoints(string_links, string_joints, counted_joint_names); });
+    const double name_map_seconds = measureSeconds(repetitions, [&]() { interned_found = resolveJoints(interned_links, interned_joints, joint_names); });
+
+    std::cout << "Links: " << nr_of_links << ", joints: " << joint_names.size() << std::endl;
+    std::cout << "std::map: " << string_map_bytes / 1024 << " KiB, " << string_map_seconds * 1e3 << " ms to resolve the joints" << std::endl;
+    std::cout << "NameMap:  " << name_map_bytes / 1024 << " KiB, " << name_map_seconds * 1e3 << " ms to resolve the joints" << std::endl;
+    return string_found == joint_names.size() && interned_found == joint_names.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
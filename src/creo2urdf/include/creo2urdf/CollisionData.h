@@ -0,0 +1,102 @@
+/** @file CollisionData.h
+ *  @brief Contains declarations for precomputing the collision data of the exported meshes.
+ *
+ * For each collision mesh a bounding volume hierarchy and a sparse signed distance field are built
+ * and written as binary files, so that collision checkers do not have to compute them at startup.
+ * These functions do not use the Creo API, so they can be run in parallel on the meshes.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef COLLISION_DATA_H
+#define COLLISION_DATA_H
+
+#include <creo2urdf/Mesh.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A node of a bounding volume hierarchy of axis-aligned boxes, stored depth first.
+ * The left child of an internal node is the following node.
+ */
+struct BvhNode {
+    Eigen::Vector3f min_corner{ Eigen::Vector3f::Zero() }; ///< Minimum corner of the box.
+    Eigen::Vector3f max_corner{ Eigen::Vector3f::Zero() }; ///< Maximum corner of the box.
+    std::uint32_t offset{ 0 }; ///< For a leaf the first triangle, otherwise the index of the right child.
+    std::uint32_t count{ 0 };  ///< Number of triangles of a leaf, 0 for internal nodes.
+};
+
+/**
+ * @brief A bounding volume hierarchy, with the triangles of the mesh reordered so that each leaf
+ * references a contiguous range.
+ */
+struct Bvh {
+    TriangleMesh mesh;           ///< The reordered mesh.
+    std::vector<BvhNode> nodes;  ///< The nodes, the first one is the root.
+};
+
+/**
+ * @brief A signed distance field sampled on a regular grid, storing only the bricks of voxels close to the surface.
+ */
+struct SparseSdf {
+    static constexpr std::uint32_t brick_size = 8; ///< Number of voxels along each side of a brick.
+    Eigen::Vector3d origin{ Eigen::Vector3d::Zero() }; ///< Position of the first voxel.
+    double voxel_size{ 0.0 }; ///< Distance between two voxels.
+    std::array<std::uint32_t, 3> nr_of_bricks{ { 0, 0, 0 } }; ///< Number of bricks along each axis.
+    std::vector<std::array<std::uint32_t, 3>> brick_indices; ///< Grid coordinates of the stored bricks.
+    std::vector<float> values; ///< Distances of the voxels of the stored bricks, x fastest, negative inside.
+};
+
+/**
+ * @brief Builds a bounding volume hierarchy by splitting the triangles at the median of the longest axis.
+ * @param mesh The mesh.
+ * @param max_leaf_size The maximum number of triangles of a leaf.
+ * @return The hierarchy.
+ */
+Bvh buildBvh(const TriangleMesh& mesh, std::uint32_t max_leaf_size = 4);
+
+/**
+ * @brief Computes the signed distance field of a closed mesh in a narrow band around its surface.
+ * @param bvh The hierarchy of the mesh.
+ * @param voxel_size The distance between two voxels, in m.
+ * @param band_width The width of the band around the surface, in voxels.
+ * @param max_resolution The maximum number of voxels along each axis, the voxel size is increased if needed.
+ * @return The sparse signed distance field.
+ */
+SparseSdf computeSparseSdf(const Bvh& bvh, double voxel_size, double band_width, std::uint32_t max_resolution);
+
+/**
+ * @brief Checks whether the surfaces of two meshes intersect or touch, by traversing their hierarchies.
+ * A mesh completely contained in the other one is not detected.
+ * @param a The hierarchy of the first mesh.
+ * @param b The hierarchy of the second mesh.
+ * @param R The rotation from the frame of the second mesh to the frame of the first one.
+ * @param p The position of the origin of the frame of the second mesh in the frame of the first one.
+ * @return True if the surfaces intersect, false otherwise.
+ */
+bool meshesIntersect(const Bvh& a, const Bvh& b, const Eigen::Matrix3d& R, const Eigen::Vector3d& p);
+
+/**
+ * @brief Writes a hierarchy as binary file, with little-endian 32-bit fields.
+ * @param filename The path of the file.
+ * @param bvh The hierarchy.
+ * @return True if successful, false otherwise.
+ */
+bool writeBvhFile(const std::string& filename, const Bvh& bvh);
+
+/**
+ * @brief Writes a sparse signed distance field as binary file, with little-endian 32-bit fields.
+ * @param filename The path of the file.
+ * @param sdf The signed distance field.
+ * @return True if successful, false otherwise.
+ */
+bool writeSdfFile(const std::string& filename, const SparseSdf& sdf);
+
+#endif // !COLLISION_DATA_H
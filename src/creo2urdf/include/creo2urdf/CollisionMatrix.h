@@ -0,0 +1,97 @@
+/** @file CollisionMatrix.h
+ *  @brief Contains declarations for the CollisionMatrix class.
+ *
+ * The CollisionMatrix class classifies the pairs of links of a model as never, always or sometimes
+ * in contact over sampled joint configurations, and exports the pairs that can be skipped by
+ * planners and simulators. The bounding boxes only prove that a pair is never in contact, a pair
+ * is always in contact only if the meshes of the links intersect in every configuration.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef COLLISION_MATRIX_H
+#define COLLISION_MATRIX_H
+
+#include <creo2urdf/CollisionData.h>
+
+#include <string>
+#include <vector>
+
+#include <iDynTree/Model/Model.h>
+
+/**
+ * @brief Classification of a pair of links.
+ */
+enum class ContactClass {
+    Never,     ///< The links are never in contact.
+    Always,    ///< The links are in contact in every configuration.
+    Sometimes, ///< The links are in contact only in some configurations.
+    Adjacent   ///< The links are connected by a joint.
+};
+
+/**
+ * @brief Allowed-collision matrix of a model, computed by checking the bounding boxes of the
+ * collision geometries of every pair of links in sampled joint configurations, and the meshes
+ * of the pairs whose boxes overlap in all of them.
+ */
+class CollisionMatrix {
+public:
+    /**
+     * @brief Samples uniformly the joint configurations inside the position limits of the model.
+     * The revolute joints without limits are sampled in [-pi, pi], the other joints without limits are kept at 0.
+     * @param model The model.
+     * @param nr_of_samples The number of configurations to sample.
+     * @param seed The seed of the random generator, to make the sampling reproducible.
+     * @return The sampled joint configurations, ordered as the DOFs of the model.
+     */
+    static std::vector<iDynTree::VectorDynSize> sampleJointConfigurations(const iDynTree::Model& model, std::size_t nr_of_samples, unsigned int seed);
+
+    /**
+     * @brief Classifies every pair of links. The configurations are processed in parallel.
+     * @param model The model.
+     * @param link_boxes The bounding boxes of the collision geometries of each link, in the link frame, indexed by link index.
+     * @param link_meshes The hierarchies of the collision meshes of each link, in the link frame, indexed by link index.
+     * A link with geometries that are not meshes is never classified as always in contact.
+     * @param samples The joint configurations.
+     * @return True if successful, false otherwise.
+     */
+    bool compute(const iDynTree::Model& model, const std::vector<std::vector<OrientedBox>>& link_boxes,
+                 const std::vector<std::vector<Bvh>>& link_meshes, const std::vector<iDynTree::VectorDynSize>& samples);
+
+    /**
+     * @brief Gets the classification of a pair of links.
+     * @param first The index of the first link.
+     * @param second The index of the second link.
+     * @return The classification of the pair.
+     */
+    ContactClass getContactClass(std::size_t first, std::size_t second) const;
+
+    /**
+     * @brief Writes the pairs that do not need to be checked as an SRDF file with a disable_collisions list.
+     * @param filename The path of the SRDF file.
+     * @param robot_name The name of the robot.
+     * @return True if successful, false otherwise.
+     */
+    bool writeSRDF(const std::string& filename, const std::string& robot_name) const;
+
+    /**
+     * @brief Builds the gazebo blobs assigning a collide bitmask to each link, so that only the pairs
+     * that are sometimes in contact share a bit.
+     * @param xml_blobs The XML blobs, one for each link with collision geometries.
+     * @param max_bits The number of bits available in the bitmask.
+     * @return True if successful, false if the bits are not enough to represent the matrix.
+     */
+    bool buildGazeboCollisionFilterBlobs(std::vector<std::string>& xml_blobs, std::size_t max_bits = 16) const;
+
+private:
+    std::vector<std::string> m_link_names; ///< Names of the links, indexed by link index.
+    std::vector<bool> m_has_geometry; ///< Flags indicating whether each link has collision geometries.
+    std::vector<ContactClass> m_contact_classes; ///< Classification of every pair, stored as a full matrix.
+};
+
+#endif // !COLLISION_MATRIX_H
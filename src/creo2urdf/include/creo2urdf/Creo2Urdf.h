@@ -15,6 +15,16 @@
 #include <creo2urdf/Utils.h>
 #include <creo2urdf/Sensorizer.h>
 #include <creo2urdf/ElementTreeManager.h>
+#include <creo2urdf/ModelComparator.h>
+#include <creo2urdf/Mirror.h>
+#include <creo2urdf/LinkTable.h>
+#include <creo2urdf/FrameGraph.h>
+#include <creo2urdf/NameInterner.h>
+#include <creo2urdf/RenameTable.h>
+#include <creo2urdf/JointTable.h>
+#include <creo2urdf/ElementTreeCache.h>
+#include <creo2urdf/ModelRegistry.h>
+#include <creo2urdf/Shard.h>
 
 #include <pfcShrinkwrap.h>
 #include <pfcAssembly.h>
@@ -24,7 +34,8 @@
 #include <iDynTree/KinDynComputations.h>
 #include <iDynTree/Model/Traversal.h>
 
-#include <rapidcsv.h>
+#include <thread>
+
 
 
 /**
@@ -49,15 +60,19 @@ public:
      *  - Populates the data members of creo2urdf from the config
      *  - For each element in the assembly
      *      -# Create the elementTree and store the joint info between part and parent
-     *      -# Get the mass properties of the current part
+     *      -# Get the mass properties of the current part and store them in the link table
      *      -# Instantiate an iDynTree link from the current part
-     *      -# Add mesh to the link
+     *      -# Add mesh to the link, mirroring the one of the mirror image of the part if already exported
+     *  - Compute the inertias of all the links in one batch
+     *  - Optionally cross-check the link inertias with the ones integrated from the exported meshes
      *  - For each element in the joint info map
      *      -# Create a iDynTree joint between parts
      *  - Add the sensors to the iDynTree Model
      *  - Add the exported frames to the links
      *  - Add the export options to the iDynTree model exporter
+     *  - Optionally compute the allowed-collision matrix, written as srdf and gazebo blobs
      *  - Export the iDynTree model to urdf file
+     *  - Reload the urdf and check that it reproduces the iDynTree model
      */
     void OnCommand() override;
 
@@ -67,6 +82,12 @@ public:
                                                                                                                                        m_csv_path(csv_path),
                                                                                                                                        m_output_path(output_path),
                                                                                                                                        m_root_asm_model_ptr(asm_model_ptr) { }
+    Creo2Urdf(const std::string& yaml_path, const std::string& csv_path, const std::string& output_path, const std::string& asm_path,
+              const ShardSpec& shard = ShardSpec()) : m_yaml_path(yaml_path),
+                                                      m_csv_path(csv_path),
+                                                      m_output_path(output_path),
+                                                      m_asm_path(asm_path),
+                                                      shard(shard) { }
 
 private:
     /**
@@ -78,21 +99,79 @@ private:
     bool exportModelToUrdf(iDynTree::Model mdl, iDynTree::ModelExporterOptions options);
 
     /**
-     * @brief Compute spatial inertia from Creo mass properties. 
-     * The mass properties are overridden by the YAML configuration if present in the file.
-     * 
-     * @param mass_prop The Creo mass properties.
-     * @param H The 3D transform matrix to express the center of mass in the link frame.
+     * @brief Reload the exported URDF and check that it reproduces the iDynTree model, sensors included.
+     * The differences found are printed and written to roundtrip_report.txt in the output folder.
+     * @param mdl The iDynTree model that was exported.
+     * @param base_link The base link used in the export.
+     * @param sensorizer The sensorizer holding the sensors exported as xml blobs.
+     * @return True if the reloaded model is equivalent to the exported one, false otherwise.
+     */
+    bool checkExportedUrdf(const iDynTree::Model& mdl, const std::string& base_link, const Sensorizer& sensorizer);
+
+    /**
+     * @brief Stores the Creo mass properties of a link in the link table, together with the mass and
+     * inertia assigned in the YAML configuration, if any.
+     *
+     * @param mass_properties The Creo mass properties, read in this session or by a worker.
+     * @param csysPart_H_link_frame The 3D transform matrix to express the center of mass in the link frame.
      * @param link_name The name of the link.
-     * @return The computed spatial inertia.
      */
-    iDynTree::SpatialInertia computeSpatialInertiafromCreo(pfcMassProperty_ptr mass_prop, iDynTree::Transform H, const std::string& link_name);
+    void addLinkToTable(const ShardLink& mass_properties, const iDynTree::Transform& csysPart_H_link_frame, const std::string& link_name);
 
     /**
-     * @brief Populate the exported frame information map from the Creo model handle.
-     * @param modelhdl The Creo model handle.
+     * @brief Copies the Creo mass properties of a part, so that they can be stored in the link table or in a shard.
+     * @param part_name The full name of the part.
+     * @param mass_prop The Creo mass properties.
+     * @return The mass properties, with the volume scaled as the link.
      */
-    void populateExportedFrameInfoMap(pfcModel_ptr modelhdl);
+    ShardLink readMassProperties(const std::string& part_name, pfcMassProperty_ptr mass_prop) const;
+
+    /**
+     * @brief Launches a worker for each shard of the top-level components of the root assembly.
+     * The workers run on their own thread while the coordinator reads the frames of the assembly.
+     * @param asm_component_list The items of the root assembly.
+     * @param workers The thread waiting for the workers, to be joined before mergeShards and on every exit, since it writes exit_codes.
+     * @param exit_codes The exit codes of the workers, filled when they are done.
+     * @return True if the workers were launched, false otherwise.
+     */
+    bool launchShardWorkers(pfcModelItems_ptr asm_component_list, std::thread& workers, std::vector<int>& exit_codes);
+
+    /**
+     * @brief Merges the mass properties written by the workers into the link table.
+     * @param exit_codes The exit codes of the workers.
+     * @return True if successful, false if some shard cannot be read, its links conflict or are missing, and warnings are fatal.
+     */
+    bool mergeShards(const std::vector<int>& exit_codes);
+
+    /**
+     * @brief Computes the spatial inertias of all the links of the table in one batch, and sets them in the iDynTree model.
+     * @return False if some link is not physically consistent and warnings are fatal, true otherwise.
+     */
+    bool computeLinkInertias();
+
+    /**
+     * @brief Populate the exported frame information map with the coordinate systems of a part.
+     * The transforms are read from the frame graph.
+     * @param link_name The name of the part.
+     * @param csys_names The names of the coordinate systems of the part.
+     */
+    void populateExportedFrameInfoMap(const std::string& link_name, const std::vector<std::string>& csys_names);
+
+    /**
+     * @brief Adds a component of an assembly and all its coordinate systems to the frame graph.
+     * The coordinate systems of a part are named after the part, see FrameGraph::getDatumFrameName,
+     * the ones of a subassembly are anonymous.
+     * @param comp_path The path of the component in its owner assembly.
+     * @param component The record of the component model.
+     * @param owner_frame The frame of the owner assembly.
+     * @param link_frame_name The name of the csys used as link frame.
+     * @param csys_names The names of the coordinate systems of the component.
+     * @return std::pair<FrameGraph::FrameIndex, FrameGraph::FrameIndex> The frame of the component and its link frame,
+     * the latter is INVALID_FRAME_INDEX if the component has no csys named link_frame_name.
+     */
+    std::pair<FrameGraph::FrameIndex, FrameGraph::FrameIndex> addComponentFrames(pfcComponentPath_ptr comp_path, const ModelRecord& component,
+                                                                                FrameGraph::FrameIndex owner_frame, const std::string& link_frame_name,
+                                                                                std::vector<std::string>& csys_names);
 
     /**
      * @brief Read assigned inertias from the loaded YAML configuration.
@@ -111,11 +190,51 @@ private:
 
     /**
      * @brief Creates a mesh file from the Creo model in the form defined in the configuration file.
-     * @param component_handle The part as a Creo model.
+     * @param component The record of the part model.
      * @param mesh_transform The 3D transform associated to the mesh.
      * @return True if successful, false otherwise.
      */
-    bool addMeshAndExport(pfcModel_ptr component_handle, const std::string& mesh_transform);
+    bool addMeshAndExport(const ModelRecord& component, const std::string& mesh_transform);
+
+    /**
+     * @brief Computes the properties of a part used to recognize its mirror image, expressed in the link frame.
+     * @param component_handle The part as a Creo model.
+     * @param mass_prop The Creo mass properties of the part.
+     * @param csysPart_H_link_frame The transform from the part csys to the link frame.
+     * @return The signature of the part.
+     */
+    MirrorSignature computeMirrorSignature(pfcModel_ptr component_handle, pfcMassProperty_ptr mass_prop, const iDynTree::Transform& csysPart_H_link_frame);
+
+    /**
+     * @brief Writes the mesh of a part by mirroring the mesh already exported for its mirror image, if any.
+     * @param part_name The name of the part.
+     * @param mesh_file_name The path of the mesh to be written.
+     * @param binary True to write a binary STL, false for an ascii one.
+     * @return True if the mesh was derived from a mirror image, false if it has to be exported from Creo.
+     */
+    bool exportMirroredMesh(const std::string& part_name, const std::string& mesh_file_name, bool binary);
+
+    /**
+     * @brief Integrates volume, center of mass and inertia of the exported STL meshes, and compares them
+     * with the inertial parameters of the links. The meshes are processed in parallel.
+     * @return True if no large discrepancy was found, false otherwise.
+     */
+    bool checkMeshInertias();
+
+    /**
+     * @brief Classifies the pairs of links as never, always or sometimes in contact, using the collision geometries
+     * and configurations sampled inside the joint limits. Writes model.srdf in the output folder.
+     * @param xml_blobs The gazebo collision-filter blobs to be added to the urdf.
+     * @return True if successful, false otherwise.
+     */
+    bool buildCollisionMatrix(std::vector<std::string>& xml_blobs);
+
+    /**
+     * @brief Builds a bounding volume hierarchy and a sparse signed distance field for each exported collision mesh,
+     * in parallel over the links. The files are listed in model_collision_data.yaml, next to the urdf.
+     * @return True if successful, false otherwise.
+     */
+    bool buildCollisionData();
 
     /**
      * @brief Load YAML configuration from a file.
@@ -124,10 +243,67 @@ private:
      */
     bool loadYamlConfig(const std::string& filename);
 
-    bool processAsmItems(pfcModelItems_ptr asmListItems, pfcModel_ptr model_owner, iDynTree::Transform parentAsm_H_csysAsm = iDynTree::Transform::Identity());
+    /**
+     * @brief Retrieves the root assembly from m_asm_path, in the simplified representation of the configuration if enabled.
+     * @return True if successful, false otherwise.
+     */
+    bool retrieveRootAssembly();
+
+    /**
+     * @brief An assembly whose components are being visited by the traversal.
+     */
+    struct TraversalLevel {
+        pfcModel_ptr owner{ nullptr };                                           ///< The assembly.
+        std::string owner_name{ "" };                                            ///< The full name of the assembly, used to report failures.
+        FrameGraph::FrameIndex owner_frame{ FrameGraph::INVALID_FRAME_INDEX };   ///< The frame of the assembly, which holds its accumulated transform.
+        std::vector<std::pair<pfcFeature_ptr, ModelRecord*>> components;         ///< The component features with their models.
+        std::size_t next{ 0 };                                                   ///< The index of the next component to visit.
+    };
+
+    /**
+     * @brief Traverses the assembly depth first with an explicit stack of levels, adding the links in pre-order.
+     * The call stack does not grow with the nesting of the subassemblies.
+     * @param asmListItems The items of the root assembly.
+     * @param root_asm The root assembly.
+     * @param root_frame The frame of the root assembly.
+     * @return True if successful, false otherwise.
+     */
+    bool processAssembly(pfcModelItems_ptr asmListItems, pfcModel_ptr root_asm, FrameGraph::FrameIndex root_frame);
+
+    /**
+     * @brief Lists the component features of an assembly and retrieves their models in one batch.
+     * @param asmListItems The items of the assembly.
+     * @param level The level of the assembly, whose components are filled.
+     * @param level_shard The shard of the components to be listed, all of them by default.
+     * @return True if successful, false if a model cannot be retrieved.
+     */
+    bool listComponents(pfcModelItems_ptr asmListItems, TraversalLevel& level, const ShardSpec& level_shard = ShardSpec());
+
+    /**
+     * @brief Processes a component of an assembly: adds its frames, and its link if it is a part.
+     * @param level The level of the assembly owning the component.
+     * @param feat The component feature.
+     * @param component The model of the component.
+     * @param sub_level Filled with the owner and frame of the component if it is a subassembly to be visited.
+     * @return True if successful, false otherwise.
+     */
+    bool processComponent(const TraversalLevel& level, pfcFeature_ptr feat, ModelRecord& component, TraversalLevel& sub_level);
+
+    /**
+     * @brief Sets the limits, damping and friction of a joint from its row of the csv.
+     * The limits of the csv, when present, override the ones set in Creo.
+     * @param joint_name The name of the joint in the urdf.
+     * @param joint The joint.
+     * @param conversion_factor The factor converting the limits of the csv to the units of the urdf.
+     * @return true if the joint is in the csv.
+     */
+    bool setJointParametersFromCsv(const std::string& joint_name, iDynTree::IJoint& joint, double conversion_factor);
 
-    bool setJointParametersFromCsv(const rapidcsv::Document& csv, const std::string& joint_name, 
-        iDynTree::IJoint& joint, double conversion_factor);
+    /**
+     * @brief Compares the joint limits set in Creo with the ones of the csv, which override them.
+     * All the moving joints are written to joint_limits_report.csv in the output folder, and the differences are printed.
+     */
+    void reportJointLimits();
 
     /**
      * @brief Get the renamed element from the configuration.
@@ -137,13 +313,36 @@ private:
     std::string getRenameElementFromConfig(const std::string& elem_name);
 
     iDynTree::Model idyn_model; /**< The iDynTree model representing the mechanism tree. */
-    std::map<std::string, JointInfo> joint_info_map; /**< Map storing information about joints. */
-    std::map<std::string, LinkInfo> link_info_map; /**< Map storing information about links. */
-    std::map<std::string, ExportedFrameInfo> exported_frame_info_map; /**< Map storing information about exported frames. */
-    std::map<std::string, std::array<double,3>> assigned_inertias_map; /**< Map storing assigned inertias. 0 -> xx, 1 -> yy, 2 -> zz. */
-    std::map<std::string, CollisionGeometryInfo> assigned_collision_geometry_map; /**< Map storing assigned collision geometries. */
+    std::shared_ptr<NameInterner> names{ std::make_shared<NameInterner>() }; /**< Table of the names of parts, links, joints and frames, shared by the maps below. */
+    NameMap<JointInfo> joint_info_map{ names }; /**< Map storing information about joints. */
+    NameMap<LinkInfo> link_info_map{ names }; /**< Map storing information about links. */
+    NameMap<ExportedFrameInfo> exported_frame_info_map{ names }; /**< Map storing information about exported frames. */
+    NameMap<std::array<double,3>> assigned_inertias_map{ names }; /**< Map storing assigned inertias. 0 -> xx, 1 -> yy, 2 -> zz. */
+    NameMap<CollisionGeometryInfo> assigned_collision_geometry_map{ names }; /**< Map storing assigned collision geometries. */
+    std::map<std::string, MirrorSignature> mirror_signatures_map; /**< Map storing the signatures of the parts, used to detect mirrored parts. */
+    LinkTable link_table; /**< Table storing the mass properties of the links, processed in one batch after the traversal. */
+    FrameGraph frame_graph; /**< Graph of the frames of the assembly, composing the relative transforms on demand. */
     YAML::Node config; /**< YAML configuration node, storing the content of the configuration file. */
+    JointTable joint_table; /**< The joint parameters read from the csv, validated when it is loaded. */
+    ElementTreeCache element_tree_cache; /**< The joint data read from the element trees, keyed by owner, feature id and revision. */
+    SolidReferenceCache solid_reference_cache; /**< The solids referenced by the component features, resolved once per owner revision and kept across the runs. */
+    ModelRegistry model_registry; /**< The models retrieved during the traversal, with the properties read from them. */
+    RenameTable rename_table; /**< The rename section of the configuration, indexed in both directions when the configuration is loaded. */
     bool exportAllUseradded{ false }; /**< Flag indicating whether to export all user-added frames. */
+    bool streaming{ false }; /**< Flag indicating whether the part models are released once their data is extracted. */
+    ShardSpec shard; /**< The shard of the top-level components handled by this process, when it is a worker of a sharded export. */
+    bool coordinating{ false }; /**< Flag indicating whether the meshes and the mass properties are extracted by the workers of a sharded export. */
+    std::size_t shard_count{ 0 }; /**< The number of workers launched by the coordinator. */
+    /**
+     * @brief A link whose mass properties are extracted by a worker.
+     */
+    struct ShardedLink {
+        std::string link_name{ "" };                                                    ///< The full name of the part.
+        std::string urdf_link_name{ "" };                                               ///< The name of the link in the urdf.
+        iDynTree::Transform csysPart_H_link_frame{ iDynTree::Transform::Identity() };   ///< The link frame in the part csys.
+    };
+    std::vector<ShardedLink> sharded_links; /**< The links waiting for the mass properties of the workers, in traversal order. */
+    Shard extracted_shard; /**< The mass properties extracted by this worker. */
     
     std::array<double, 3> scale{ 1.0, 1.0, 1.0 }; /**< Scale factor for the exported model. Useful for converting between m and mm and viceversa. */
     std::array<double, 3> originXYZ {0.0, 0.0, 0.0}; /**< Offset of the root link in XYZ (meters) wrt the world frame. */
@@ -152,6 +351,7 @@ private:
     std::string m_yaml_path{ "" }; /**< Path to the YAML configuration file. */
     std::string m_csv_path{ "" }; /**< Path to the CSV file containing joint information. */
     std::string m_output_path{ "" }; /**< Output path for the exported URDF file. */
+    std::string m_asm_path{ "" }; /**< Path to the root assembly, retrieved once the configuration is loaded. */
     pfcModel_ptr m_root_asm_model_ptr{ nullptr }; /**< Handle to the Creo model. */
     pfcSession_ptr m_session_ptr{ nullptr }; /**< Handle to the Creo session. */
     bool m_need_to_move_link_frames_to_be_compatible_with_URDF{ false }; /**< Flag indicating whether to move link frames to be compatible with URDF. */
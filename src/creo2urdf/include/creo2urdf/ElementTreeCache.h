@@ -0,0 +1,108 @@
+/** @file ElementTreeCache.h
+ *  @brief Contains declarations for the ElementTreeCache class.
+ *
+ * Extracting the element tree of a component feature is one of the slowest calls of the toolkit. The joint data
+ * read from each tree is cached by owner model, feature id and revision of the owner, and the cache can be
+ * saved in a YAML file so that it is reused by the following runs and sessions.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef ELEMENT_TREE_CACHE_H
+#define ELEMENT_TREE_CACHE_H
+
+#include <creo2urdf/Utils.h>
+
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Joint data read from the element tree of a component feature, in the units of the model.
+ */
+struct ExtractedJoint {
+    bool valid{ false };                ///< False if the feature does not define a supported joint.
+    std::string parent_link_name{ "" }; ///< Full name of the parent part.
+    std::string child_link_name{ "" };  ///< Full name of the child part.
+    std::string datum_name{ "" };       ///< Name of the datum defining the joint (axis for revolute, csys for fixed).
+    JointType type{ JointType::None };  ///< Type of the joint.
+    JointInfo::Limits limits;           ///< Limits set in Creo, not scaled.
+    bool has_initial_transform{ false }; ///< Flag indicating whether the initial placement is available.
+    iDynTree::Transform initial_transform{ iDynTree::Transform::Identity() }; ///< Initial placement of the child wrt the parent, not scaled.
+};
+
+/**
+ * @brief Cache of the joint data extracted from the element trees, keyed by (owner model, feature id, revision).
+ */
+class ElementTreeCache {
+public:
+    /**
+     * @brief Identifies a component feature in a given revision of its owner assembly.
+     */
+    struct Key {
+        std::string owner_name{ "" }; ///< Full name of the assembly owning the feature.
+        int feature_id{ -1 };         ///< Id of the component feature.
+        int revision{ -1 };           ///< Revision number of the owner assembly.
+    };
+
+    /**
+     * @brief Counters of the element trees extracted and avoided during a run.
+     */
+    struct Statistics {
+        std::size_t extracted_trees{ 0 };  ///< Element trees extracted from Creo.
+        std::size_t cache_hits{ 0 };       ///< Features whose joint data was found in the cache.
+        std::size_t skipped_features{ 0 }; ///< Features without constraints, whose element tree was not extracted.
+    };
+
+    /**
+     * @brief Loads the entries saved by a previous run, replacing the current ones.
+     * @param filename The path of the YAML file.
+     * @return True if the file was read, false if it is missing or it is not a valid cache.
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief Saves the entries in a YAML file.
+     * @param filename The path of the YAML file.
+     * @return True if the file was written.
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief Finds the joint data of a feature.
+     * @param key The feature.
+     * @return A pointer to the joint data, nullptr if the feature is not cached.
+     */
+    const ExtractedJoint* find(const Key& key) const;
+
+    /**
+     * @brief Adds or replaces the joint data of a feature.
+     * @param key The feature.
+     * @param joint The joint data.
+     */
+    void insert(const Key& key, const ExtractedJoint& joint);
+
+    /**
+     * @brief Removes all the entries and resets the statistics.
+     */
+    void clear();
+
+    std::size_t size() const { return m_entries.size(); }
+    Statistics& getStatistics() { return m_statistics; }
+    const Statistics& getStatistics() const { return m_statistics; }
+
+private:
+    /**
+     * @brief Serialises a key as a single string.
+     */
+    static std::string toString(const Key& key);
+
+    std::unordered_map<std::string, std::pair<Key, ExtractedJoint>> m_entries; ///< The cached features, indexed by serialised key.
+    Statistics m_statistics; ///< Counters of the current run.
+};
+
+#endif // !ELEMENT_TREE_CACHE_H
@@ -13,7 +13,13 @@
  * BSD-3-Clause license. See the accompanying LICENSE file for details.
  */
 
+#ifndef ELEMENT_TREE_MANAGER_H
+#define ELEMENT_TREE_MANAGER_H
+
 #include <creo2urdf/Utils.h>
+#include <creo2urdf/NameInterner.h>
+#include <creo2urdf/ElementTreeCache.h>
+#include <creo2urdf/SolidReferenceCache.h>
 
 #include <wfcFeature.h>
 #include <wfcElemIds.h>
@@ -46,12 +52,18 @@ public:
      */
     ElementTreeManager();
 
+    /**
+     * @brief Constructor for ElementTreeManager that resolves the solids referenced by the features through a cache.
+     * @param[in,out] solid_references The cache of the solid references, shared by the managers of a run.
+     */
+    explicit ElementTreeManager(SolidReferenceCache* solid_references);
+
     /**
      * @brief Constructor for ElementTreeManager that extracts the element tree from the part and builds the joint info map.
      * @param[in] feat A pointer to a part casted as feature.
      * @param[out] joint_info_map A map containing joint information.
      */
-    ElementTreeManager(pfcFeature_ptr feat, std::map<std::string, JointInfo>& joint_info_map);
+    ElementTreeManager(pfcFeature_ptr feat, NameMap<JointInfo>& joint_info_map);
 
     /**
      * @brief Destructor for ElementTreeManager.
@@ -60,11 +72,17 @@ public:
 
     /**
      * @brief Populates joint information from the given ElementTree.
+     * The limits and the initial placement of the joint are read from the same tree.
+     * The element tree is not extracted for the features without constraints, and for the ones found in the cache.
      * @param[in] feat A pointer to a part casted as feature.
      * @param[out] joint_info_map A map containing joint information.
+     * @param[in] scale The scale applied to the lengths of the model.
+     * @param[in,out] cache The cache of the joint data, nullptr to always extract the element tree.
      * @return True if successful, false otherwise.
      */
-    bool populateJointInfoFromElementTree(pfcFeature_ptr feat, std::map<std::string, JointInfo>& joint_info_map);
+    bool populateJointInfoFromElementTree(pfcFeature_ptr feat, NameMap<JointInfo>& joint_info_map,
+                                          const std::array<double, 3>& scale = { 1.0, 1.0, 1.0 },
+                                          ElementTreeCache* cache = nullptr);
 
     /**
      * @brief Gets the constraint type between two assembled parts.
@@ -84,11 +102,29 @@ public:
      */
     std::string getChildName();
 
+    /**
+     * @brief Retrieves the regeneration value of the joint created while assembling the parts.
+     * The element tree has to be populated with populateJointInfoFromElementTree, without cache, before calling this method.
+     * @return A pair containing a success flag and the regeneration value,
+     * expressed in degrees for pin joints and in model units for slider joints.
+     */
+    std::pair<bool, double> retrieveRegenerationValue();
+
+    /**
+     * @brief Drives the joint created while assembling the parts to the given regeneration value, redefining the feature.
+     * The owner assembly has to be regenerated afterwards to update the placement of the components.
+     * @param feat A pointer to a part casted as feature.
+     * @param value The regeneration value, expressed in degrees for pin joints and in model units for slider joints.
+     * @return True if successful, false otherwise.
+     */
+    bool setRegenerationValue(pfcFeature_ptr feat, double value);
+
 private:
     wfcElementTree_ptr tree{ nullptr }; ///< Pointer to the ElementTree of the part as feature.
     wfcWFeature_ptr wfeat{ nullptr };   ///< Pointer to the part as feature.
-    pfcSolid_ptr parent_solid{ nullptr };         ///< Pointer to the parent solid.
-    pfcSolid_ptr child_solid{ nullptr };          ///< Pointer to the child solid.
+    std::string parent_solid_name{ "" };          ///< Full name of the parent solid, empty if it was not found.
+    std::string child_solid_name{ "" };           ///< Full name of the child solid, empty if it was not found.
+    SolidReferenceCache* solid_references{ nullptr }; ///< Cache of the solid references, nullptr to query them for each feature.
 
     /*
      * @brief Retrieves the name of a common datum for the given model item type.
@@ -101,18 +137,44 @@ private:
      * @brief Gets the characterizing constraint datum used for assembling the two parts, depending on the joint.
      * For a revolute joint, the datum is Axis, for a fixed joint the datum is CSys.
      * 
-     * @param feat A pointer to a part casted as feature.
+     * @param constraints The constraints of the component feature.
      * @param constraint_type The constraint type.
      * @param datum_type The datum type.
      * @return The constraint datum.
      */
-    std::string getConstraintDatum(pfcFeature_ptr feat, pfcComponentConstraintType constraint_type, pfcModelItemType datum_type);
+    std::string getConstraintDatum(pfcComponentConstraints_ptr constraints, pfcComponentConstraintType constraint_type, pfcModelItemType datum_type);
+
+    /**
+     * @brief Extracts the element tree of a component feature and reads the joint data from it.
+     * @param[in] feat A pointer to a part casted as feature.
+     * @param[in] constraints The constraints of the component feature.
+     * @param[out] joint The joint data, in the units of the model.
+     * @return True if the feature defines a supported joint, false otherwise.
+     */
+    bool extractJoint(pfcFeature_ptr feat, pfcComponentConstraints_ptr constraints, ExtractedJoint& joint);
+
+    /**
+     * @brief Scales the joint data and inserts it in the joint info map.
+     * @param[in] joint The joint data, in the units of the model.
+     * @param[out] joint_info_map A map containing joint information.
+     * @param[in] scale The scale applied to the lengths of the model.
+     */
+    static void insertJointInfo(const ExtractedJoint& joint, NameMap<JointInfo>& joint_info_map, const std::array<double, 3>& scale);
+
+    /**
+     * @brief Gets the key identifying a component feature in the cache.
+     * @param[in] feat A pointer to a part casted as feature.
+     * @param[out] key The key.
+     * @return False if the owner of the feature has unsaved modifications, and its joint data cannot be cached.
+     */
+    static bool getCacheKey(pfcFeature_ptr feat, ElementTreeCache::Key& key);
 
     /**
      * @brief Retrieves references to the parent and child solids. We assume there are only two parts and they are named differently.
+     * @param feat A pointer to a part casted as feature.
      * @return True if successful, false otherwise.
      */
-    bool retrieveSolidReferences();
+    bool retrieveSolidReferences(pfcFeature_ptr feat);
 
     /**
      * @brief Retrieves the name of the part associated with the ElementTree.
@@ -122,12 +184,17 @@ private:
 
     /**
      * @brief Retrieves the min and max limits for the joint created during assembling the parts.
-     * @param feat A pointer to a part casted as feature.
-     * @return A pair representing the limits (min, max).
+     * @param[out] limits The limits, expressed in degrees for pin joints and in model units for slider joints.
+     * @return True if both limits are enabled, false otherwise.
      */
-    std::pair<double, double> retrieveLimits(pfcFeature_ptr feat);
-
-    // SEEMS to work but we need to investigate further, using this may allow to refactor the code deeply
+    bool retrieveLimits(JointInfo::Limits& limits);
 
-    pfcTransform3D_ptr retrieveTransform(pfcFeature_ptr feat);
+    /**
+     * @brief Retrieves the initial placement of the component wrt its parent.
+     * SEEMS to work but we need to investigate further, using this may allow to refactor the code deeply
+     * @return The transform parentCsys_H_childCsys, nullptr if it is not available.
+     */
+    pfcTransform3D_ptr retrieveTransform();
 };
+
+#endif // !ELEMENT_TREE_MANAGER_H
@@ -0,0 +1,130 @@
+/** @file FrameGraph.h
+ *  @brief Contains declarations for the FrameGraph class.
+ *
+ * The FrameGraph class stores every frame met during the traversal of the assembly (subassemblies, parts
+ * and their coordinate systems) as a node of a tree, each with its transform wrt its parent. The relative
+ * transforms between frames are composed lazily and memoised, so that no transform is computed twice.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef FRAME_GRAPH_H
+#define FRAME_GRAPH_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <iDynTree/Core/Transform.h>
+
+/**
+ * @brief Tree of frames with memoised composition of the relative transforms.
+ * The non-const queries update the cache, so only the const methods can be called from multiple threads.
+ */
+class FrameGraph {
+public:
+    using FrameIndex = std::size_t;
+    static constexpr FrameIndex INVALID_FRAME_INDEX = static_cast<FrameIndex>(-1);
+
+    /**
+     * @brief Gets the name of the frame of a datum belonging to a model.
+     * @param model_name The name of the model (e.g. the full name of the part).
+     * @param datum_name The name of the datum (e.g. the name of the csys).
+     * @return The name of the frame.
+     */
+    static std::string getDatumFrameName(const std::string& model_name, const std::string& datum_name);
+
+    /**
+     * @brief Adds a frame to the graph.
+     * @param name The name of the frame, an empty name adds an anonymous frame that can be reached only by index.
+     * @param parent The index of the parent frame, INVALID_FRAME_INDEX for a root frame.
+     * @param parent_H_frame The transform from the parent frame to the new frame.
+     * @return The index of the new frame, INVALID_FRAME_INDEX if the name or the parent are not valid.
+     */
+    FrameIndex addFrame(const std::string& name, FrameIndex parent, const iDynTree::Transform& parent_H_frame);
+
+    /**
+     * @brief Gets the index of a named frame.
+     * @param name The name of the frame.
+     * @return The index of the frame, INVALID_FRAME_INDEX if there is no frame with this name.
+     */
+    FrameIndex getFrameIndex(const std::string& name) const;
+
+    /**
+     * @brief Gets the transform between two frames of the same tree, composing it if it was never queried before.
+     * @param frame_a The index of the frame in which the transform is expressed.
+     * @param frame_b The index of the frame whose pose is returned.
+     * @return The transform a_H_b.
+     */
+    iDynTree::Transform getTransform(FrameIndex frame_a, FrameIndex frame_b);
+
+    /**
+     * @brief Gets the transform between two named frames.
+     * @param frame_a The name of the frame in which the transform is expressed.
+     * @param frame_b The name of the frame whose pose is returned.
+     * @return std::pair<bool, iDynTree::Transform> A flag, false if a frame is missing or the frames are not
+     * connected, and the transform a_H_b, identity on failure.
+     */
+    std::pair<bool, iDynTree::Transform> getTransform(const std::string& frame_a, const std::string& frame_b);
+
+    /**
+     * @brief Checks whether two frames exist and belong to the same tree.
+     * @param frame_a The index of the first frame.
+     * @param frame_b The index of the second frame.
+     * @return true if the transform between the frames can be computed.
+     */
+    bool areConnected(FrameIndex frame_a, FrameIndex frame_b) const;
+
+    /**
+     * @brief Composes the transform between two frames of the same tree, without using or updating the cache.
+     * @param frame_a The index of the frame in which the transform is expressed.
+     * @param frame_b The index of the frame whose pose is returned.
+     * @return The transform a_H_b, identity if the frames are not connected.
+     */
+    iDynTree::Transform composeTransform(FrameIndex frame_a, FrameIndex frame_b) const;
+
+    /**
+     * @brief Composes the transforms between many pairs of frames on multiple threads, see composeTransform.
+     * @param queries The pairs of frames (a, b).
+     * @return The transforms a_H_b, in the order of the queries.
+     */
+    std::vector<iDynTree::Transform> composeTransforms(const std::vector<std::pair<FrameIndex, FrameIndex>>& queries) const;
+
+    /**
+     * @brief Gets the transform from the root of the tree containing a frame to the frame.
+     * @param frame The index of the frame.
+     * @return The transform root_H_frame.
+     */
+    iDynTree::Transform getTransformFromRoot(FrameIndex frame);
+
+    /**
+     * @brief Removes all the frames and the cached transforms.
+     */
+    void clear();
+
+    std::size_t size() const { return m_parents.size(); }
+    std::size_t getNrOfCachedTransforms() const { return m_cache.size(); }
+
+private:
+    /**
+     * @brief Finds the closest common ancestor of two frames.
+     * @return The index of the ancestor, INVALID_FRAME_INDEX if the frames belong to different trees.
+     */
+    FrameIndex findCommonAncestor(FrameIndex frame_a, FrameIndex frame_b) const;
+
+    std::vector<std::string> m_names;                          ///< Names of the frames, empty for anonymous frames.
+    std::vector<FrameIndex> m_parents;                         ///< Parents of the frames.
+    std::vector<std::size_t> m_depths;                         ///< Number of ancestors of the frames.
+    std::vector<iDynTree::Transform> m_parent_H_frames;        ///< Transforms from the parents to the frames.
+    std::unordered_map<std::string, FrameIndex> m_indices;     ///< Indices of the named frames.
+    std::unordered_map<std::uint64_t, iDynTree::Transform> m_cache; ///< Composed transforms, keyed by the pair of frames.
+};
+
+#endif // !FRAME_GRAPH_H
@@ -0,0 +1,103 @@
+/** @file JointTable.h
+ *  @brief Contains declarations for the JointTable class.
+ *
+ * The JointTable class reads the CSV file of the joint parameters once, converting every cell to a number
+ * and indexing the rows by joint name, so that the whole file is validated before the model is built.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef JOINT_TABLE_H
+#define JOINT_TABLE_H
+
+#include <istream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rapidcsv {
+class Document;
+}
+
+/**
+ * @brief Parameters of a joint, as written in the CSV file. The limits of the revolute joints are in degrees.
+ */
+struct JointParameters {
+    double lower_limit{ -std::numeric_limits<double>::infinity() }; ///< Lower position limit, -inf if not specified.
+    double upper_limit{ std::numeric_limits<double>::infinity() };  ///< Upper position limit, inf if not specified.
+    double velocity_limit{ std::numeric_limits<double>::infinity() }; ///< Velocity limit, inf if not specified.
+    double effort_limit{ std::numeric_limits<double>::infinity() };   ///< Effort limit, inf if not specified.
+    double damping{ 0.0 };  ///< Viscous damping.
+    double friction{ 0.0 }; ///< Static friction.
+};
+
+/**
+ * @brief Table of the joint parameters read from the CSV file, indexed by joint name.
+ */
+class JointTable {
+public:
+    /**
+     * @brief Reads the table from a CSV file, replacing its content.
+     * The rows with errors are skipped, the errors are appended to errors.
+     * @param filename The path of the CSV file.
+     * @param errors The errors found in the file.
+     * @return true if the file was read without errors.
+     */
+    bool load(const std::string& filename, std::vector<std::string>& errors);
+
+    /**
+     * @brief Reads the table from a stream in CSV format, see load(const std::string&, std::vector<std::string>&).
+     */
+    bool load(std::istream& stream, std::vector<std::string>& errors);
+
+    /**
+     * @brief Gets the parameters of a joint.
+     * @param joint_name The name of the joint in the urdf.
+     * @return The parameters, nullptr if the joint is not in the table.
+     */
+    const JointParameters* find(const std::string& joint_name) const;
+
+    /**
+     * @brief Compares the joints of the table with the joints of the model.
+     * @param joint_names The names of the joints of the model that can have parameters.
+     * @param missing The joints of the model that are not in the table.
+     * @param extra The joints of the table that are not in the model, in file order.
+     */
+    void checkJoints(const std::vector<std::string>& joint_names, std::vector<std::string>& missing, std::vector<std::string>& extra) const;
+
+    /**
+     * @brief Checks whether at least one joint has a velocity or an effort limit.
+     */
+    bool hasVelocityOrEffortLimits() const;
+
+    const std::vector<std::string>& getJointNames() const { return m_joint_names; }
+    std::size_t size() const { return m_joint_names.size(); }
+    void clear();
+
+private:
+    /**
+     * @brief Converts and validates the rows of a parsed CSV file.
+     */
+    bool loadDocument(const rapidcsv::Document& csv, std::vector<std::string>& errors);
+
+    std::vector<std::string> m_joint_names;                  ///< Names of the joints, in file order.
+    std::vector<JointParameters> m_parameters;               ///< Parameters of the joints, in file order.
+    std::unordered_map<std::string, std::size_t> m_indices;  ///< Row of each joint.
+};
+
+/**
+ * @brief Writes the velocity and effort limits of the table in the limit elements of the joints of an urdf file.
+ * Only the finite limits are written, the limit element is added to the moving joints that miss it.
+ * @param filename The path of the urdf file.
+ * @param joint_table The table of the joint parameters.
+ * @return true if the file was updated.
+ */
+bool writeJointLimitsToUrdf(const std::string& filename, const JointTable& joint_table);
+
+#endif // !JOINT_TABLE_H
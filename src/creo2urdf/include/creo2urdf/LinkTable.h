@@ -0,0 +1,109 @@
+/** @file LinkTable.h
+ *  @brief Contains declarations for the LinkTable class.
+ *
+ * The LinkTable class stores the mass properties extracted from Creo for every link as a structure
+ * of arrays, so that the inertias of all the links are computed in one vectorized batch once the
+ * traversal of the assembly is over.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef LINK_TABLE_H
+#define LINK_TABLE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+/**
+ * @brief Table of the mass properties of the links, stored as a structure of arrays: each component of each
+ * quantity is contiguous for all the links. The element (i, j) of a 3x3 matrix is the component i + 3 * j.
+ */
+class LinkTable {
+public:
+    /**
+     * @brief Adds a link with the mass properties returned by Creo.
+     * @param name The name of the link.
+     * @param creo_mass The mass.
+     * @param creo_com The center of mass, in the part csys and in the units of the part.
+     * @param creo_inertia The inertia wrt the center of mass, with the orientation of the part csys and in the units of the part.
+     * @param csysPart_R_link The orientation of the link frame in the part csys.
+     * @param csysPart_p_link The position of the link frame in the part csys, in meters.
+     * @return The index of the link in the table.
+     */
+    std::size_t add(const std::string& name, double creo_mass, const Eigen::Vector3d& creo_com, const Eigen::Matrix3d& creo_inertia,
+                    const Eigen::Matrix3d& csysPart_R_link, const Eigen::Vector3d& csysPart_p_link);
+
+    /**
+     * @brief Overrides the mass of a link.
+     * @param index The index of the link.
+     * @param mass The assigned mass.
+     */
+    void assignMass(std::size_t index, double mass);
+
+    /**
+     * @brief Overrides the inertia of a link with a diagonal one, already expressed in the link frame.
+     * @param index The index of the link.
+     * @param diagonal The assigned xx, yy and zz moments.
+     */
+    void assignInertia(std::size_t index, const std::array<double, 3>& diagonal);
+
+    /**
+     * @brief Computes mass, center of mass and inertia in the link frame of all the links, and checks their consistency.
+     * @param scale The scale converting the units of the parts to meters.
+     */
+    void computeInertias(const std::array<double, 3>& scale);
+
+    /**
+     * @brief Removes all the links.
+     */
+    void clear();
+
+    /**
+     * @brief Reserves the memory for a number of links.
+     * @param nr_of_links The number of links.
+     */
+    void reserve(std::size_t nr_of_links);
+
+    std::size_t size() const { return m_names.size(); }
+    const std::string& getName(std::size_t index) const { return m_names[index]; }
+    double getMass(std::size_t index) const { return m_masses[index]; }
+    Eigen::Vector3d getCenterOfMass(std::size_t index) const;
+    Eigen::Matrix3d getInertia(std::size_t index) const;
+
+    /**
+     * @brief Checks whether the inertia of a link is physically consistent, i.e. the mass is positive and the
+     * principal moments are non-negative and satisfy the triangle inequality. Valid after computeInertias.
+     * @param index The index of the link.
+     * @return True if consistent, false otherwise.
+     */
+    bool isPhysicallyConsistent(std::size_t index) const { return m_consistent[index] != 0; }
+
+private:
+    template <std::size_t N>
+    using Components = std::array<std::vector<double>, N>; ///< One contiguous array for each component.
+
+    std::vector<std::string> m_names;        ///< Names of the links.
+    std::vector<double> m_creo_masses;       ///< Masses returned by Creo.
+    Components<3> m_creo_coms;               ///< Centers of mass returned by Creo.
+    Components<9> m_creo_inertias;           ///< Inertias returned by Creo.
+    Components<9> m_rotations;               ///< Orientations of the link frames in the part csys.
+    Components<3> m_positions;               ///< Positions of the link frames in the part csys.
+    std::vector<double> m_assigned_masses;   ///< Assigned masses, NaN when not assigned.
+    Components<3> m_assigned_inertias;       ///< Assigned diagonal inertias, NaN when not assigned.
+
+    std::vector<double> m_masses;            ///< Masses of the links.
+    Components<3> m_coms;                    ///< Centers of mass in the link frames.
+    Components<9> m_inertias;                ///< Inertias wrt the center of mass, in the link frames.
+    std::vector<std::uint8_t> m_consistent;  ///< Flags of physical consistency.
+};
+
+#endif // !LINK_TABLE_H
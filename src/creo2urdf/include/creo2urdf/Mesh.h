@@ -0,0 +1,112 @@
+/** @file Mesh.h
+ *  @brief Contains declarations for reading the exported meshes and computing their properties.
+ *
+ * These functions do not use the Creo API, so they can be run in parallel on the meshes
+ * written by the export.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef MESH_H
+#define MESH_H
+
+#include <array>
+#include <string>
+
+#include <Eigen/Core>
+
+/**
+ * @brief A triangle mesh, stored as three 3xN matrices holding the vertices of the N triangles.
+ */
+struct TriangleMesh {
+    Eigen::Matrix3Xd v0; ///< First vertex of each triangle.
+    Eigen::Matrix3Xd v1; ///< Second vertex of each triangle.
+    Eigen::Matrix3Xd v2; ///< Third vertex of each triangle.
+
+    /**
+     * @brief Gets the number of triangles of the mesh.
+     * @return The number of triangles.
+     */
+    Eigen::Index size() const { return v0.cols(); }
+};
+
+/**
+ * @brief Volume, center of mass and inertia of the solid enclosed by a mesh, with unit density.
+ */
+struct MeshMassProperties {
+    double volume{ 0.0 };                               ///< Volume of the solid.
+    Eigen::Vector3d com{ Eigen::Vector3d::Zero() };     ///< Centroid of the solid.
+    Eigen::Matrix3d inertia{ Eigen::Matrix3d::Zero() }; ///< Inertia wrt the centroid, divided by the density.
+    bool closed{ false };                               ///< Flag indicating whether the mesh looks closed.
+};
+
+/**
+ * @brief An oriented bounding box.
+ */
+struct OrientedBox {
+    Eigen::Vector3d center{ Eigen::Vector3d::Zero() };       ///< Center of the box.
+    Eigen::Matrix3d axes{ Eigen::Matrix3d::Identity() };     ///< Axes of the box, as columns.
+    Eigen::Vector3d half_extents{ Eigen::Vector3d::Zero() }; ///< Half of the size of the box along each axis.
+
+    /**
+     * @brief Gets the box expressed in another frame.
+     * @param R The rotation from the frame of the box to the new frame.
+     * @param p The position of the origin of the frame of the box in the new frame.
+     * @return The transformed box.
+     */
+    OrientedBox transformed(const Eigen::Matrix3d& R, const Eigen::Vector3d& p) const {
+        return { R * center + p, R * axes, half_extents };
+    }
+};
+
+/**
+ * @brief Reads a binary or ascii STL file. The header of the binary files is not checked, since
+ * the meshes exported by creo2urdf have it overwritten (see sanitizeSTL).
+ * @param filename The path of the STL file.
+ * @param mesh The mesh read from the file.
+ * @param scale The scale applied to the coordinates of the vertices.
+ * @return True if successful, false otherwise.
+ */
+bool readSTL(const std::string& filename, TriangleMesh& mesh, const std::array<double, 3>& scale = { 1.0, 1.0, 1.0 });
+
+/**
+ * @brief Writes a binary or ascii STL file. The header of the binary files does not start with "solid",
+ * as the ones of the meshes exported by creo2urdf.
+ * @param filename The path of the STL file.
+ * @param mesh The mesh.
+ * @param binary True to write a binary file, false for an ascii one.
+ * @param scale The scale that was applied when reading the mesh, the coordinates are divided by it.
+ * @return True if successful, false otherwise.
+ */
+bool writeSTL(const std::string& filename, const TriangleMesh& mesh, bool binary = true, const std::array<double, 3>& scale = { 1.0, 1.0, 1.0 });
+
+/**
+ * @brief Computes the mass properties of the solid enclosed by a mesh, by applying the divergence theorem
+ * to each triangle (see D. Eberly, "Polyhedral Mass Properties (Revisited)").
+ * The triangles have to be oriented with the normal pointing outward.
+ * @param mesh The mesh.
+ * @return The mass properties, computed with unit density.
+ */
+MeshMassProperties computeMeshMassProperties(const TriangleMesh& mesh);
+
+/**
+ * @brief Computes a bounding box of a mesh, aligned with the principal directions of its vertices.
+ * @param mesh The mesh.
+ * @return The oriented bounding box.
+ */
+OrientedBox computeOrientedBox(const TriangleMesh& mesh);
+
+/**
+ * @brief Checks whether two oriented boxes overlap, using the separating axis theorem.
+ * @param a The first box.
+ * @param b The second box, expressed in the same frame as the first one.
+ * @return True if the boxes overlap, false otherwise.
+ */
+bool overlaps(const OrientedBox& a, const OrientedBox& b);
+
+#endif // !MESH_H
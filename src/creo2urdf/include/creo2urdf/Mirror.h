@@ -0,0 +1,73 @@
+/** @file Mirror.h
+ *  @brief Contains declarations for detecting mirrored parts and deriving their meshes.
+ *
+ * The left and right parts of a robot are often mirror images stored in different files. A mirrored
+ * part is recognized by its mass properties and datum layout, and its mesh is obtained by reflecting
+ * the vertices of the mesh already exported for the other part, instead of tessellating it again.
+ * These functions do not use the Creo API.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef MIRROR_H
+#define MIRROR_H
+
+#include <creo2urdf/Mesh.h>
+
+#include <vector>
+
+/**
+ * @brief Geometric properties of a part expressed in its link frame, in meters, that are preserved by a reflection.
+ */
+struct MirrorSignature {
+    double volume{ 0.0 };                                 ///< Volume of the part.
+    Eigen::Vector3d com{ Eigen::Vector3d::Zero() };       ///< Centroid of the part.
+    Eigen::Matrix3d gyration{ Eigen::Matrix3d::Zero() };  ///< Inertia wrt the centroid divided by the mass.
+    OrientedBox outline;                                  ///< Bounding box of the part, aligned with the part csys.
+    std::vector<Eigen::Vector3d> datum_origins;           ///< Origins of the coordinate systems of the part.
+};
+
+/**
+ * @brief An improper rigid transform x -> reflection * x + translation, mapping the link frame
+ * of a part to the link frame of its mirror image.
+ */
+struct MirrorTransform {
+    Eigen::Matrix3d reflection{ Eigen::Matrix3d::Identity() }; ///< Orthogonal matrix with determinant -1.
+    Eigen::Vector3d translation{ Eigen::Vector3d::Zero() };    ///< Translation.
+};
+
+/**
+ * @brief Finds the reflections mapping a part to another one, matching volume, principal moments and datum layout.
+ * The principal axes have to be distinct and the part must have at least three non collinear datums, otherwise
+ * the reflection is not determined and no candidate is returned.
+ * @param source The signature of the part whose mesh is available.
+ * @param target The signature of the candidate mirror image.
+ * @param tolerance The relative tolerance of the comparisons.
+ * @return The candidate transforms, best first, empty if the parts are not mirror images.
+ */
+std::vector<MirrorTransform> findMirrorTransforms(const MirrorSignature& source, const MirrorSignature& target, double tolerance);
+
+/**
+ * @brief Applies a reflection to a mesh, reversing the order of the vertices to keep the normals pointing outward.
+ * @param mesh The mesh.
+ * @param transform The reflection.
+ * @return The mirrored mesh.
+ */
+TriangleMesh mirrorMesh(const TriangleMesh& mesh, const MirrorTransform& transform);
+
+/**
+ * @brief Confirms a mirrored mesh by checking that its vertices span the outline of the target part, and that
+ * the solid it encloses has the volume, the centroid and the moments of the target about the outline axes.
+ * @param mesh The mirrored mesh.
+ * @param target The signature of the target part.
+ * @param tolerance The tolerance, relative to the size of the outline, to the volume and to the moments.
+ * @return True if the mesh matches the target, false otherwise.
+ */
+bool confirmMirroredMesh(const TriangleMesh& mesh, const MirrorSignature& target, double tolerance);
+
+#endif // !MIRROR_H
@@ -0,0 +1,149 @@
+/** @file ModelComparator.h
+ *  @brief Contains declarations for the ModelComparator class.
+ *
+ * The ModelComparator class is used to check that a URDF reloaded from file reproduces
+ * the iDynTree model that was exported, both structurally and numerically.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef MODEL_COMPARATOR_H
+#define MODEL_COMPARATOR_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <iDynTree/Model/Model.h>
+#include <iDynTree/Sensors.h>
+
+#include <Eigen/Core>
+
+/**
+ * @brief Tolerances used when comparing two models. A value a is considered equal to b if
+ * |a - b| <= absolute_tolerance + relative_tolerance * max(|a|, |b|).
+ */
+struct ModelComparisonOptions {
+    double absolute_tolerance{ 1e-5 }; ///< Absolute tolerance, in SI units.
+    double relative_tolerance{ 1e-4 }; ///< Relative tolerance.
+    double angle_tolerance{ 1e-4 };    ///< Tolerance on directions and orientations, in rad.
+    double inertia_tolerance{ 1e-9 };  ///< Absolute tolerance on the elements of the rotational inertia, in kg m^2.
+};
+
+/**
+ * @brief A sensor that is expected to be found in the reloaded model.
+ */
+struct SensorReference {
+    std::string name{ "" };      ///< Name of the sensor.
+    std::string parent{ "" };    ///< Name of the parent link, or of the parent joint for force/torque sensors.
+    bool is_joint_sensor{ false }; ///< Flag indicating whether the sensor is attached to a joint.
+    iDynTree::Transform parentLink_H_sensor{ iDynTree::Transform::Identity() }; ///< Pose of a link sensor in the frame of its parent link.
+};
+
+/**
+ * @brief Representation of a model that does not depend on the choice of the link frames.
+ *
+ * Every quantity is expressed in the frame of the base link with all the joints in 0,
+ * so that two models that differ only by the placement of the link frames (e.g. after
+ * moveLinkFramesToBeCompatibleWithURDF) have the same canonical form.
+ */
+struct CanonicalModel {
+    /**
+     * @brief Inertial parameters of a link.
+     */
+    struct Link {
+        double mass{ 0.0 };                                ///< Mass of the link.
+        Eigen::Vector3d com{ Eigen::Vector3d::Zero() };    ///< Center of mass.
+        Eigen::Matrix3d inertia{ Eigen::Matrix3d::Zero() }; ///< Rotational inertia wrt the center of mass.
+        iDynTree::Transform base_H_link{ iDynTree::Transform::Identity() }; ///< Pose of the link frame.
+    };
+
+    /**
+     * @brief Kinematic and dynamic parameters of a joint.
+     */
+    struct Joint {
+        std::string parent{ "" };  ///< Name of the parent link.
+        std::string child{ "" };   ///< Name of the child link.
+        std::string type{ "" };    ///< Type of the joint: revolute, prismatic, fixed or other.
+        Eigen::Vector3d axis_direction{ Eigen::Vector3d::Zero() }; ///< Direction of the axis.
+        Eigen::Vector3d axis_point{ Eigen::Vector3d::Zero() };     ///< A point on the axis.
+        bool has_limits{ false };  ///< Flag indicating whether the position limits are enabled.
+        double min{ 0.0 };         ///< Lower position limit.
+        double max{ 0.0 };         ///< Upper position limit.
+        double damping{ 0.0 };     ///< Damping coefficient.
+        double friction{ 0.0 };    ///< Static friction coefficient.
+    };
+
+    std::unordered_map<std::string, Link> links;   ///< Links, keyed by name.
+    std::unordered_map<std::string, Joint> joints; ///< Joints, keyed by name.
+    std::unordered_map<std::string, std::pair<std::string, iDynTree::Transform>> frames; ///< Additional frames, keyed by name: link and pose.
+};
+
+/**
+ * @brief Compares two iDynTree models through their canonical form, collecting the differences found.
+ */
+class ModelComparator {
+public:
+    /**
+     * @brief Constructor for ModelComparator.
+     * @param options The tolerances used in the comparison.
+     */
+    explicit ModelComparator(const ModelComparisonOptions& options = ModelComparisonOptions()) : m_options(options) {}
+
+    /**
+     * @brief Computes the canonical form of a model.
+     * @param model The model.
+     * @param base_link The link used as base, it must be the same for the models that are compared.
+     * @param canonical The canonical form of the model.
+     * @return True if successful, false if the base link is not in the model.
+     */
+    static bool canonicalise(const iDynTree::Model& model, const std::string& base_link, CanonicalModel& canonical);
+
+    /**
+     * @brief Compares the reference model with the model reloaded from file.
+     * @param reference The model that was exported.
+     * @param loaded The model loaded from the exported file.
+     * @param base_link The link used as base for the comparison.
+     * @return True if the models are equivalent within the tolerances, false otherwise.
+     */
+    bool compare(const iDynTree::Model& reference, const iDynTree::Model& loaded, const std::string& base_link);
+
+    /**
+     * @brief Checks that the sensors of the reloaded model match the expected ones.
+     * Only the sensor types supported by the iDynTree URDF parser are checked.
+     * @param expected The sensors that are expected in the model.
+     * @param loaded The model loaded from the exported file, with its sensors.
+     * @param reference The model that was exported, whose link frames are used by the expected sensors.
+     * @param base_link The link used as base for the comparison.
+     * @return True if the sensors match within the tolerances, false otherwise.
+     */
+    bool compareSensors(const std::vector<SensorReference>& expected, const iDynTree::Model& loaded,
+                        const iDynTree::Model& reference, const std::string& base_link);
+
+    /**
+     * @brief Gets the differences found by the previous comparisons.
+     * @return A vector of human readable descriptions of the differences.
+     */
+    const std::vector<std::string>& getDifferences() const { return m_differences; }
+
+private:
+    /**
+     * @brief Checks that two scalars are equal within the tolerances, storing a difference otherwise.
+     */
+    bool checkScalar(double reference, double loaded, const std::string& description);
+
+    /**
+     * @brief Checks that two poses are equal within the tolerances, storing a difference otherwise.
+     */
+    bool checkPose(const iDynTree::Transform& reference, const iDynTree::Transform& loaded, double length_scale, const std::string& description);
+
+    ModelComparisonOptions m_options; ///< Tolerances used in the comparison.
+    std::vector<std::string> m_differences; ///< Differences found so far.
+};
+
+#endif // !MODEL_COMPARATOR_H
@@ -0,0 +1,127 @@
+/** @file ModelRegistry.h
+ *  @brief Contains declarations for the ModelRegistry class.
+ *
+ * The same part or subassembly is often placed many times in an assembly. The ModelRegistry retrieves each
+ * unique model once per run, and keeps its handle together with the properties read during the traversal,
+ * so that the following instances do not call Creo again. When the assembly is retrieved in a simplified
+ * representation, the geometry of the parts is loaded on demand, only for the parts that are exported as links.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include <string>
+#include <unordered_map>
+
+#include <pfcModel.h>
+#include <pfcSession.h>
+#include <pfcSimpRep.h>
+#include <pfcSolid.h>
+
+/**
+ * @brief The properties of a model read once during the traversal.
+ */
+struct ModelRecord {
+    pfcModel_ptr handle{ nullptr };                  ///< Handle of the model in the session.
+    std::string full_name{ "" };                     ///< Full name of the model.
+    pfcModelType type{ pfcMDL_PART };                ///< Type of the model.
+    bool is_skeleton{ false };                       ///< Flag indicating whether the model is a skeleton.
+    pfcMassProperty_ptr mass_property{ nullptr };    ///< Mass properties of the model, read the first time they are needed.
+    bool geometry_loaded{ false };                   ///< Flag indicating whether the master representation of the part was activated.
+    pfcSimpRep_ptr previous_rep{ nullptr };          ///< The representation active before the master one was activated, restored on release.
+    bool released{ false };                          ///< Flag indicating whether the model was released at least once during the run.
+};
+
+/**
+ * @brief Registry of the models retrieved during a run, keyed by model descriptor.
+ * The handles belong to the current session, so the registry has to be cleared at the beginning of each run.
+ */
+class ModelRegistry {
+public:
+    /**
+     * @brief Counters of the calls to Creo made and saved by the registry.
+     */
+    struct Statistics {
+        std::size_t lookups{ 0 };     ///< Models requested.
+        std::size_t models{ 0 };      ///< Unique models retrieved from the session.
+        std::size_t saved_calls{ 0 }; ///< Calls to Creo answered by the registry.
+        std::size_t geometry_loads{ 0 }; ///< Parts whose geometry was loaded on demand.
+        std::size_t released_models{ 0 }; ///< Models released once their data was extracted.
+        std::size_t unloaded_models{ 0 }; ///< Released models whose geometry was unloaded.
+    };
+
+    /**
+     * @brief Gets the record of a model, retrieving it from the session the first time it is requested,
+     * or again if it was released.
+     * @param session The Creo session.
+     * @param descriptor The descriptor of the model, e.g. of a component feature.
+     * @return A pointer to the record, nullptr if the model cannot be retrieved. It stays valid until the registry is cleared.
+     */
+    ModelRecord* retrieve(pfcSession_ptr session, pfcModelDescriptor_ptr descriptor);
+
+    /**
+     * @brief Gets the mass properties of a solid model, computing them the first time they are requested.
+     * @param record The record of the model.
+     * @return The mass properties.
+     */
+    pfcMassProperty_ptr getMassProperty(ModelRecord& record);
+
+    /**
+     * @brief Loads the geometry of a part retrieved in a simplified representation, activating its master representation.
+     * A part that was released is always returned to its master representation, since the release may have changed it.
+     * It does nothing if the geometry is not loaded on demand and the part was not released, or if the model is not a part.
+     * @param record The record of the model.
+     * @return True if the geometry of the part is available, false otherwise.
+     */
+    bool loadGeometry(ModelRecord& record);
+
+    /**
+     * @brief Releases a model whose data was extracted: its handle and mass properties are dropped, and a part whose geometry
+     * was loaded on demand is returned to its previous representation. Otherwise, if the geometry is unloaded on release,
+     * the part is returned to the graphics representation. The model stays in session, since it is used by the assembly.
+     * The record is kept, so that the model is retrieved again if another component refers to it.
+     * @param record The record of the model.
+     */
+    void release(ModelRecord& record);
+
+    /**
+     * @brief Sets whether the geometry of the parts is loaded on demand, i.e. if the assembly is in a simplified representation.
+     * @param on_demand True to load the geometry on demand.
+     */
+    void setGeometryOnDemand(bool on_demand) { m_geometry_on_demand = on_demand; }
+
+    /**
+     * @brief Sets whether the released parts are switched to the graphics representation. It is meant for the batch mode only,
+     * since in an interactive session the parts are shown in the assembly window of the user.
+     * @param unload True to unload the geometry of the released parts.
+     */
+    void setUnloadOnRelease(bool unload) { m_unload_on_release = unload; }
+
+    /**
+     * @brief Removes all the records and resets the statistics.
+     */
+    void clear();
+
+    std::size_t size() const { return m_records.size(); }
+    const Statistics& getStatistics() const { return m_statistics; }
+
+    /**
+     * @brief Describes the calls to Creo saved during the run.
+     */
+    std::string getStatisticsSummary() const;
+
+private:
+    std::unordered_map<std::string, ModelRecord> m_records; ///< The records, keyed by full name and type of the descriptor.
+    Statistics m_statistics; ///< Counters of the current run.
+    bool m_geometry_on_demand{ false }; ///< Flag indicating whether the geometry of the parts is loaded on demand.
+    bool m_unload_on_release{ false }; ///< Flag indicating whether the released parts are switched to the graphics representation.
+};
+
+#endif // !MODEL_REGISTRY_H
@@ -0,0 +1,205 @@
+/** @file NameInterner.h
+ *  @brief Contains declarations for the NameInterner class and the NameMap container.
+ *
+ * The names of parts, links, joints and frames are stored once in a NameInterner, which maps them to
+ * dense integer ids through a flat hash table. A NameMap stores its values in a contiguous vector, in
+ * insertion order, and finds them through a vector indexed by the ids of the names.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef NAME_INTERNER_H
+#define NAME_INTERNER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Table of unique names, each identified by a dense integer id.
+ * The references to the stored names stay valid until the table is cleared.
+ */
+class NameInterner {
+public:
+    using Id = std::uint32_t;
+    static constexpr Id INVALID_ID = static_cast<Id>(-1);
+
+    /**
+     * @brief Gets the id of a name, adding the name to the table if it is not there yet.
+     * @param name The name.
+     * @return The id of the name.
+     */
+    Id intern(const std::string& name);
+
+    /**
+     * @brief Gets the id of a name, without adding it.
+     * @param name The name.
+     * @return The id of the name, INVALID_ID if the name is not in the table.
+     */
+    Id find(const std::string& name) const;
+
+    /**
+     * @brief Gets the name corresponding to an id.
+     * @param id The id.
+     * @return The name.
+     */
+    const std::string& getName(Id id) const { return m_names[id]; }
+
+    /**
+     * @brief Removes all the names, invalidating their ids and references.
+     */
+    void clear();
+
+    std::size_t size() const { return m_names.size(); }
+
+    /**
+     * @brief Gets the number of bytes allocated for the names and the hash table, not counting the
+     * bookkeeping of the deque and the short names stored inside their std::string.
+     */
+    std::size_t getMemoryUsage() const;
+
+private:
+    /**
+     * @brief Gets the slot of the hash table holding a name, or the empty slot where it would be inserted.
+     */
+    std::size_t findSlot(const std::string& name, std::size_t hash) const;
+
+    /**
+     * @brief Doubles the capacity of the hash table, reinserting all the ids.
+     */
+    void grow();
+
+    std::deque<std::string> m_names;  ///< The names, indexed by id. A deque does not move them when growing.
+    std::vector<std::size_t> m_hashes; ///< The hashes of the names, indexed by id.
+    std::vector<Id> m_table;           ///< Open addressing hash table of the ids, with linear probing.
+};
+
+/**
+ * @brief Associative container from names to values, with the names stored in a NameInterner.
+ * The values are stored contiguously and iterated in insertion order, as std::pair<const std::string&, T>
+ * so that the loops written for std::map keep working. The loops whose order reaches the output use sortedByName,
+ * to keep the order of the std::map the NameMap replaces.
+ */
+template <class T, class Allocator = std::allocator<T>>
+class NameMap {
+    template <class U>
+    using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+public:
+    using value_type = std::pair<const std::string&, T>;
+    using allocator_type = Allocator;
+    using iterator = typename std::vector<value_type, Rebind<value_type>>::iterator;
+    using const_iterator = typename std::vector<value_type, Rebind<value_type>>::const_iterator;
+
+    /**
+     * @brief Creates a map with its own table of names.
+     */
+    NameMap() : m_names(std::make_shared<NameInterner>()) {}
+
+    /**
+     * @brief Creates a map sharing a table of names with other maps.
+     * @param names The table of names.
+     * @param allocator The allocator of the values and of the index.
+     */
+    explicit NameMap(std::shared_ptr<NameInterner> names, const Allocator& allocator = Allocator())
+        : m_names(std::move(names)), m_slots(allocator), m_entries(allocator) {}
+
+    /**
+     * @brief Inserts a value, if its name is not already in the map.
+     * @param entry The name and the value.
+     * @return std::pair<iterator, bool> The element with the name, and a flag indicating whether the value was inserted.
+     */
+    std::pair<iterator, bool> insert(const std::pair<std::string, T>& entry)
+    {
+        const NameInterner::Id id = m_names->intern(entry.first);
+        if (id < m_slots.size() && m_slots[id] != NameInterner::INVALID_ID) {
+            return { m_entries.begin() + m_slots[id], false };
+        }
+        if (id >= m_slots.size()) {
+            m_slots.resize(id + 1, NameInterner::INVALID_ID);
+        }
+        m_slots[id] = static_cast<NameInterner::Id>(m_entries.size());
+        m_entries.emplace_back(m_names->getName(id), entry.second);
+        return { m_entries.end() - 1, true };
+    }
+
+    iterator find(NameInterner::Id id) { return m_entries.begin() + getSlot(id); }
+    const_iterator find(NameInterner::Id id) const { return m_entries.begin() + getSlot(id); }
+    iterator find(const std::string& name) { return find(m_names->find(name)); }
+    const_iterator find(const std::string& name) const { return find(m_names->find(name)); }
+
+    T& at(const std::string& name)
+    {
+        const std::size_t slot = getSlot(m_names->find(name));
+        if (slot == m_entries.size()) {
+            throw std::out_of_range("NameMap: " + name + " not found");
+        }
+        return m_entries[slot].second;
+    }
+
+    const T& at(const std::string& name) const { return const_cast<NameMap*>(this)->at(name); }
+
+    bool contains(const std::string& name) const { return find(name) != end(); }
+
+    /**
+     * @brief Removes all the values. The names stay in the table, which may be shared.
+     */
+    void clear()
+    {
+        m_entries.clear();
+        m_slots.clear();
+    }
+
+    std::size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+    iterator begin() { return m_entries.begin(); }
+    iterator end() { return m_entries.end(); }
+    const_iterator begin() const { return m_entries.begin(); }
+    const_iterator end() const { return m_entries.end(); }
+
+    /**
+     * @brief Gets the elements sorted by name, in the order a std::map keyed by name would iterate them.
+     * @return The iterators to the elements, valid until the next insertion.
+     */
+    std::vector<iterator> sortedByName() { return sortByName<iterator>(m_entries.begin(), m_entries.end()); }
+    std::vector<const_iterator> sortedByName() const { return sortByName<const_iterator>(m_entries.begin(), m_entries.end()); }
+
+    /**
+     * @brief Gets the table of names used by the map.
+     */
+    const std::shared_ptr<NameInterner>& getNames() const { return m_names; }
+
+private:
+    template <class Iterator>
+    static std::vector<Iterator> sortByName(Iterator first, Iterator last)
+    {
+        std::vector<Iterator> sorted;
+        sorted.reserve(last - first);
+        for (; first != last; ++first) {
+            sorted.push_back(first);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Iterator& a, const Iterator& b) { return a->first < b->first; });
+        return sorted;
+    }
+
+    std::size_t getSlot(NameInterner::Id id) const
+    {
+        return id < m_slots.size() && m_slots[id] != NameInterner::INVALID_ID ? m_slots[id] : m_entries.size();
+    }
+
+    std::shared_ptr<NameInterner> m_names;                             ///< The table of names.
+    std::vector<NameInterner::Id, Rebind<NameInterner::Id>> m_slots;   ///< Position of the value of each name in m_entries, indexed by id.
+    std::vector<value_type, Rebind<value_type>> m_entries;             ///< The names and the values, in insertion order.
+};
+
+#endif // !NAME_INTERNER_H
@@ -0,0 +1,119 @@
+/** @file Parallel.h
+ *  @brief Minimal helpers to run independent work items on multiple threads.
+ *
+ * Creo is single threaded, so these helpers are meant only for the stages that work on data already
+ * extracted from the session (e.g. kinematics, mesh processing). The callables passed to them must never
+ * call the Creo API, printToMessageWindow included.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Returns the number of worker threads to be used for a given amount of work items.
+ *
+ * @param count The number of work items.
+ * @param max_threads Upper bound on the number of threads, 0 means the hardware concurrency.
+ * @return std::size_t The number of threads, always at least 1.
+ */
+inline std::size_t getNumberOfWorkers(std::size_t count, std::size_t max_threads = 0)
+{
+    std::size_t n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0) {
+        n_threads = 1;
+    }
+    if (max_threads > 0) {
+        n_threads = std::min(n_threads, max_threads);
+    }
+    return std::max<std::size_t>(1, std::min(n_threads, count));
+}
+
+/**
+ * @brief Splits the range [0, count) in contiguous chunks and processes each chunk on its own thread.
+ *
+ * The callable is invoked as fn(begin, end, worker_index), so that per-thread state (e.g. a KinDynComputations
+ * object) can be created once per chunk. The first exception thrown by a worker is rethrown in the calling thread.
+ *
+ * @param count The number of work items.
+ * @param fn The callable processing a chunk.
+ * @param max_threads Upper bound on the number of threads, 0 means the hardware concurrency.
+ */
+template <class Function>
+void parallelForChunks(std::size_t count, Function&& fn, std::size_t max_threads = 0)
+{
+    if (count == 0) {
+        return;
+    }
+
+    const std::size_t n_workers = getNumberOfWorkers(count, max_threads);
+    if (n_workers == 1) {
+        fn(std::size_t{ 0 }, count, std::size_t{ 0 });
+        return;
+    }
+
+    std::exception_ptr first_exception{ nullptr };
+    std::mutex exception_mutex;
+    std::vector<std::thread> workers;
+    workers.reserve(n_workers);
+
+    const std::size_t chunk = (count + n_workers - 1) / n_workers;
+    for (std::size_t w = 0; w < n_workers; w++) {
+        const std::size_t begin = w * chunk;
+        const std::size_t end = std::min(count, begin + chunk);
+        if (begin >= end) {
+            break;
+        }
+        workers.emplace_back([&fn, &first_exception, &exception_mutex, begin, end, w]() {
+            try {
+                fn(begin, end, w);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (!first_exception) {
+                    first_exception = std::current_exception();
+                }
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (first_exception) {
+        std::rethrow_exception(first_exception);
+    }
+}
+
+/**
+ * @brief Calls fn(i) for every i in [0, count), distributing the indices over multiple threads.
+ *
+ * @param count The number of work items.
+ * @param fn The callable processing a single item.
+ * @param max_threads Upper bound on the number of threads, 0 means the hardware concurrency.
+ */
+template <class Function>
+void parallelFor(std::size_t count, Function&& fn, std::size_t max_threads = 0)
+{
+    parallelForChunks(count, [&fn](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t i = begin; i < end; i++) {
+            fn(i);
+        }
+    }, max_threads);
+}
+
+#endif // !PARALLEL_H
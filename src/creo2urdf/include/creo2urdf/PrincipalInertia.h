@@ -0,0 +1,52 @@
+/** @file PrincipalInertia.h
+ *  @brief Contains declarations for expressing the link inertias in their principal axes.
+ *
+ * The URDF inertial element has its own origin, so each rotational inertia can be written as a diagonal
+ * tensor in the frame of its principal axes, without changing the dynamics of the model.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef PRINCIPAL_INERTIA_H
+#define PRINCIPAL_INERTIA_H
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <iDynTree/Model/Model.h>
+
+/**
+ * @brief Rotational inertia of a link expressed in its principal axes.
+ */
+struct PrincipalInertia {
+    bool rotated{ false }; ///< Flag indicating whether the principal axes differ from the link axes.
+    iDynTree::Rotation link_R_principal{ iDynTree::Rotation::Identity() }; ///< Orientation of the principal axes in the link frame.
+    std::array<double, 3> moments{ { 0.0, 0.0, 0.0 } }; ///< Principal moments of inertia wrt the center of mass.
+};
+
+/**
+ * @brief Computes the principal axes of the rotational inertia of every link, in parallel.
+ * The links whose inertia is already diagonal are not rotated.
+ * @param model The model.
+ * @param tolerance The off-diagonal terms below this fraction of the largest moment are considered null.
+ * @return The principal inertias, indexed by link index.
+ */
+std::vector<PrincipalInertia> computePrincipalInertias(const iDynTree::Model& model, double tolerance = 1e-12);
+
+/**
+ * @brief Rewrites the inertial elements of an exported urdf with the principal axes of the links.
+ * The origin of each inertial element is rotated and its inertia is made diagonal.
+ * @param filename The path of the urdf file.
+ * @param model The model that was exported in the file.
+ * @param inertias The principal inertias of the links, indexed by link index.
+ * @return True if successful, false otherwise.
+ */
+bool writePrincipalInertiasToUrdf(const std::string& filename, const iDynTree::Model& model, const std::vector<PrincipalInertia>& inertias);
+
+#endif // !PRINCIPAL_INERTIA_H
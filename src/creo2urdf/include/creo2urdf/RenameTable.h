@@ -0,0 +1,68 @@
+/** @file RenameTable.h
+ *  @brief Contains declarations for the RenameTable class.
+ *
+ * The RenameTable class indexes the `rename` section of the configuration in both directions, so that
+ * the urdf name of a Creo element and the Creo name of a urdf element are found with a single lookup.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef RENAME_TABLE_H
+#define RENAME_TABLE_H
+
+#include <string>
+#include <unordered_map>
+
+#include <yaml-cpp/yaml.h>
+
+/**
+ * @brief Bidirectional index of the names defined in the `rename` section of the configuration.
+ */
+class RenameTable {
+public:
+    /**
+     * @brief Builds the table from the `rename` section of the configuration, replacing its content.
+     * If several Creo names are renamed to the same urdf name, the first one is used in the reverse lookup.
+     * @param rename The `rename` node, which may be undefined.
+     */
+    void load(const YAML::Node& rename);
+
+    /**
+     * @brief Gets the urdf name of a Creo element.
+     * @param creo_name The name of the element in Creo.
+     * @return The renamed element, nullptr if the element is not renamed.
+     */
+    const std::string* findRenamed(const std::string& creo_name) const;
+
+    /**
+     * @brief Gets the Creo name of a renamed element.
+     * @param urdf_name The name of the element in the urdf.
+     * @return The name of the element in Creo, nullptr if no element is renamed to urdf_name.
+     */
+    const std::string* findCreoName(const std::string& urdf_name) const;
+
+    /**
+     * @brief Gets the urdf name of a Creo element, falling back to its Creo name.
+     * @param creo_name The name of the element in Creo.
+     * @return The renamed element if it is renamed, creo_name otherwise.
+     */
+    const std::string& getRenamed(const std::string& creo_name) const;
+
+    /**
+     * @brief Removes all the names.
+     */
+    void clear();
+
+    std::size_t size() const { return m_creo_to_urdf.size(); }
+
+private:
+    std::unordered_map<std::string, std::string> m_creo_to_urdf; ///< The urdf names, indexed by Creo name.
+    std::unordered_map<std::string, std::string> m_urdf_to_creo; ///< The Creo names, indexed by urdf name.
+};
+
+#endif // !RENAME_TABLE_H
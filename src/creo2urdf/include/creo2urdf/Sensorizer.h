@@ -16,6 +16,9 @@
 #define SENSORIZER_H
 
 #include <creo2urdf/Utils.h>
+#include <creo2urdf/FrameGraph.h>
+#include <creo2urdf/NameInterner.h>
+#include <creo2urdf/RenameTable.h>
 
 #include <libxml2/libxml/parser.h>
 #include <libxml2/libxml/tree.h>
@@ -23,6 +26,23 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <memory>
+#include <regex>
+
+/**
+ * @brief Rule generating a sensor for each coordinate system of a link whose name matches a pattern.
+ */
+struct SensorGenerator {
+    std::string linkName{ "" };                 ///< Name of the link whose coordinate systems are matched.
+    std::string frameNamePattern{ "" };         ///< ECMAScript regular expression matched against the whole csys names.
+    std::regex frameNameRegex;                  ///< The compiled frameNamePattern.
+    std::string sensorNameTemplate{ "{link}_{frame}" }; ///< Name of the generated sensors, see Sensorizer::fillSensorNameTemplate.
+    bool exportFrameInURDF{ false };            ///< Flag indicating whether to export the frames of the generated sensors in URDF.
+    SensorType type{ SensorType::None };        ///< Type of the generated sensors.
+    double updateRate{ 100 };                   ///< Update rate of the generated sensors.
+    std::shared_ptr<const std::vector<std::string>> xmlBlobs; ///< XML blobs shared by the generated sensors.
+};
+
 /**
  * @brief Represents a Sensorizer class, used read sensors information from a YAML node, 
  * and create the related XML blobs to feed to iDynTree Model Exporter.
@@ -41,27 +61,58 @@ struct Sensorizer {
      */
     void readSensorsFromConfig(const YAML::Node& config);
 
+    /**
+     * @brief Reads the sensor generators from a YAML node.
+     * @param config The YAML node containing sensor configuration.
+     */
+    void readSensorGeneratorsFromConfig(const YAML::Node& config);
+
+    /**
+     * @brief Fills a sensor name template, replacing {link} with the link name, {frame} with the csys name,
+     * {index} with the index of the match and {1}, {2}, ... with the groups captured by the pattern.
+     * @param name_template The template.
+     * @param link_name The name of the link.
+     * @param match The match of the csys name, whose first element is the csys name.
+     * @param index The index of the match among the ones of the same generator.
+     * @return The name of the sensor.
+     */
+    static std::string fillSensorNameTemplate(const std::string& name_template, const std::string& link_name,
+                                              const std::smatch& match, std::size_t index);
+
+    /**
+     * @brief Adds a sensor for each coordinate system matched by the sensor generators, with its transform.
+     * The generators are grouped by link, so that the coordinate systems of each link are resolved once.
+     * @param link_info_map A map of link information.
+     * @param rename_table The renamed elements, used to find the Creo name of the links of the generators.
+     * @param frame_graph The graph of the frames of the assembly.
+     */
+    void expandSensorGenerators(const NameMap<LinkInfo>& link_info_map,
+                                const RenameTable& rename_table,
+                                const FrameGraph& frame_graph);
+
     /**
      * @brief Assigns a 3D transform to a force/torque sensor based on provided information.
      * @param exported_frame_info_map A map of exported frame information.
      * @param link_info_map A map of link information.
      * @param joint_info_map A map of joint information.
-     * @param scale The scale for the position part of the 3D transform.
+     * @param frame_graph The graph of the frames of the assembly.
      */
-    void assignTransformToFTSensor(const std::map<std::string, ExportedFrameInfo>& exported_frame_info_map,
-                                   const std::map<std::string, LinkInfo>& link_info_map,
-                                   const std::map<std::string, JointInfo>& joint_info_map,
-                                   const std::array<double, 3> scale);
+    void assignTransformToFTSensor(const NameMap<ExportedFrameInfo>& exported_frame_info_map,
+                                   const NameMap<LinkInfo>& link_info_map,
+                                   const NameMap<JointInfo>& joint_info_map,
+                                   const FrameGraph& frame_graph);
 
     /**
      * @brief Assigns a 3D transform to all sensors based on provided information.
      * @param exported_frame_info_map A map of exported frame information.
      * @param link_info_map A map of link information.
-     * @param scale The scale for the position part of the 3D transform.
+     * @param rename_table The renamed elements, used to find the Creo name of the links of the sensors.
+     * @param frame_graph The graph of the frames of the assembly.
      */
-    void assignTransformToSensors(const std::map<std::string, ExportedFrameInfo>& exported_frame_info_map,
-                                  const std::map<std::string, LinkInfo>& link_info_map,
-                                  const std::array<double, 3> scale);
+    void assignTransformToSensors(const NameMap<ExportedFrameInfo>& exported_frame_info_map,
+                                  const NameMap<LinkInfo>& link_info_map,
+                                  const RenameTable& rename_table,
+                                  const FrameGraph& frame_graph);
 
     /**
      * @brief Builds a vector of XML trees as strings for force/torque sensors, 
@@ -84,7 +135,7 @@ struct Sensorizer {
     /**
      * @brief Map containing information about force/torque sensors.
      */
-    std::map<std::string, FTSensorInfo> ft_sensors;
+    NameMap<FTSensorInfo> ft_sensors;
 
     /**
      * @brief Vector containing information about general sensors.
@@ -92,9 +143,9 @@ struct Sensorizer {
     std::vector<SensorInfo> sensors;
 
     /**
-     * @brief YAML node containing sensor configuration.
+     * @brief Vector containing the rules generating sensors from the coordinate systems of the links.
      */
-    YAML::Node m_config;
+    std::vector<SensorGenerator> sensor_generators;
 
 };
 
@@ -0,0 +1,136 @@
+/** @file Shard.h
+ *  @brief Contains declarations for the shards of a sharded export.
+ *
+ * Creo is single threaded, so a large assembly can be exported by several batch Creo processes, each handling
+ * a disjoint shard of the top-level components. The workers export the meshes and write the mass properties
+ * of their links in a shard file, which the coordinator merges with the frames it reads into one urdf.
+ * The worker command is a template, so that Creo can be replaced by a stand-in executable writing shard files.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The default worker command, running Creo in batch mode as scripts/run_creo2urdf.ps1 does,
+ * with the shard as fifth argument of the plugin.
+ */
+constexpr const char* default_worker_command = "\"%CREO_INSTALL_PATH%\\..\\Parametric\\bin\\parametric.exe\" -g:no_graphics -batch_mode creo2urdf "
+                                               "\"+{asm}\" \"+{yaml}\" \"+{csv}\" \"+{output}\" \"+{shard}\"";
+
+/**
+ * @brief Identifies the shard of a worker, e.g. "1/4" is the second of four shards.
+ * The top-level components are assigned to the shards round robin, in the order of the features of the root assembly.
+ */
+struct ShardSpec {
+    std::size_t index{ 0 }; ///< Index of the shard.
+    std::size_t count{ 1 }; ///< Number of shards, 1 if the export is not sharded.
+
+    /**
+     * @brief Parses a shard written as "index/count".
+     * @param text The shard.
+     * @return True if the shard is valid, false otherwise.
+     */
+    bool parse(const std::string& text);
+
+    /**
+     * @brief Writes the shard as "index/count".
+     */
+    std::string toString() const;
+
+    /**
+     * @brief Checks whether a top-level component belongs to the shard.
+     * @param position The position of the component among the components of the root assembly.
+     */
+    bool owns(std::size_t position) const { return position % count == index; }
+
+    /**
+     * @brief Checks whether the shard is a part of a sharded export, i.e. if it is handled by a worker.
+     */
+    bool isWorker() const { return count > 1; }
+};
+
+/**
+ * @brief The mass properties of a link, as returned by Creo.
+ */
+struct ShardLink {
+    std::string name{ "" };                  ///< The full name of the part.
+    double mass{ 0.0 };                      ///< The mass.
+    std::array<double, 3> com{};             ///< The center of mass, in the part csys and in the units of the part.
+    std::array<double, 9> inertia{};         ///< The inertia wrt the center of mass, row by row, with the orientation of the part csys.
+    double volume{ 0.0 };                    ///< The volume, scaled as the link.
+};
+
+/**
+ * @brief The data extracted by a worker, saved in the output folder as shard_<index>.yaml.
+ */
+struct Shard {
+    ShardSpec spec;                ///< The shard of the worker.
+    std::vector<ShardLink> links;  ///< The links of the components of the shard.
+
+    /**
+     * @brief Gets the name of the file of a shard.
+     * @param index The index of the shard.
+     */
+    static std::string getFileName(std::size_t index) { return "shard_" + std::to_string(index) + ".yaml"; }
+
+    /**
+     * @brief Loads a shard file.
+     * @param filename The path of the file.
+     * @return True if the file was read, false if it is missing or malformed.
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief Saves the shard.
+     * @param filename The path of the file.
+     * @return True if the file was written, false otherwise.
+     */
+    bool save(const std::string& filename) const;
+};
+
+/**
+ * @brief Merges the shard files written by the workers by link name. A part placed in the components of several shards
+ * is listed by each of them, so a link found twice is merged if its mass properties are the same, and is an error otherwise.
+ * @param filenames The paths of the shard files, the i-th one holding the shard i of filenames.size().
+ * @param exit_codes The exit codes of the workers, one per shard. A worker that failed is reported, its shard is read anyway.
+ * @param links The merged links, keyed by name.
+ * @param warnings The description of each problem found.
+ * @return True if all the shards were read and merged without conflicts, false otherwise.
+ */
+bool mergeShardFiles(const std::vector<std::string>& filenames, const std::vector<int>& exit_codes,
+                     std::map<std::string, ShardLink>& links, std::vector<std::string>& warnings);
+
+/**
+ * @brief Fills the worker command template, replacing {asm}, {yaml}, {csv}, {output} and {shard}.
+ * @param command The command template.
+ * @param asm_path The path of the root assembly.
+ * @param yaml_path The path of the yaml configuration.
+ * @param csv_path The path of the joint csv.
+ * @param output_path The output folder.
+ * @param spec The shard of the worker.
+ * @return The command.
+ */
+std::string expandWorkerCommand(std::string command, const std::string& asm_path, const std::string& yaml_path,
+                                const std::string& csv_path, const std::string& output_path, const ShardSpec& spec);
+
+/**
+ * @brief Runs the worker commands concurrently, one thread each, and waits for all of them.
+ * The commands are run by the shell and must never call back into the Creo session of the coordinator.
+ * @param commands The commands.
+ * @return The exit codes of the commands.
+ */
+std::vector<int> runWorkerCommands(const std::vector<std::string>& commands);
+
+#endif // !SHARD_H
@@ -0,0 +1,117 @@
+/** @file SolidReferenceCache.h
+ *  @brief Contains declarations for the SolidReferenceCache class.
+ *
+ * The parent and child solids of a joint are found through the external references of its component feature,
+ * whose query dominates the element tree phase on densely constrained assemblies. The SolidReferenceCache
+ * resolves all the component features of an assembly in one pass, the first time one of them is needed,
+ * and memoises the names of the solids by owner revision and feature id, across the runs of the session.
+ * The revision changes only when the owner is saved, so the references of a modified owner last one run.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef SOLID_REFERENCE_CACHE_H
+#define SOLID_REFERENCE_CACHE_H
+
+#include <string>
+#include <unordered_map>
+
+#include <pfcFeature.h>
+#include <pfcSolid.h>
+#include <wfcFeature.h>
+
+/**
+ * @brief Memoised resolution of the parent and child solids referenced by the component features.
+ * Only the names of the solids are kept, so the references stay valid when the models are released or erased,
+ * and the references of an owner are resolved again when its revision changes.
+ */
+class SolidReferenceCache {
+public:
+    /**
+     * @brief The solids constrained by a component feature.
+     */
+    struct SolidReferences {
+        bool valid{ false };           ///< False if the references of the feature could not be resolved.
+        std::string parent_name{ "" };  ///< The full name of the solid referenced first, i.e. the parent link, empty if not found.
+        std::string child_name{ "" };   ///< The full name of the solid referenced second, i.e. the child link, empty if not found.
+    };
+
+    /**
+     * @brief Counters of the external reference queries of the current run.
+     */
+    struct Statistics {
+        std::size_t lookups{ 0 };      ///< Features whose references were requested.
+        std::size_t queries{ 0 };      ///< Calls to GetExternalParents.
+        std::size_t owner_passes{ 0 }; ///< Assemblies whose component features were resolved.
+    };
+
+    /**
+     * @brief The references of the component features of an assembly.
+     */
+    struct OwnerReferences {
+        int revision{ -1 };                                  ///< The revision of the assembly when it was resolved.
+        bool modified{ false };                              ///< True if the assembly had unsaved changes when it was resolved.
+        std::size_t run{ 0 };                                ///< The run in which the assembly was resolved.
+        std::unordered_map<int, SolidReferences> features;   ///< The references, keyed by feature id.
+    };
+
+    /**
+     * @brief Gets the solids referenced by a component feature, resolving all the features of its owner if needed.
+     * @param feat A pointer to a part casted as feature.
+     * @return A pointer to the references, nullptr if the owner of the feature cannot be read.
+     */
+    const SolidReferences* find(pfcFeature_ptr feat);
+
+    /**
+     * @brief Resolves the solids referenced by a component feature, querying its external parents.
+     * We assume there are only two parts and they are named differently.
+     * @param wfeat The component feature.
+     * @return The references.
+     */
+    static SolidReferences resolve(wfcWFeature_ptr wfeat);
+
+    /**
+     * @brief Starts a new run: the statistics are reset, and the references of the modified owners are dropped.
+     */
+    void startRun()
+    {
+        m_statistics = Statistics();
+        m_run++;
+    }
+
+    /**
+     * @brief Removes all the references and resets the statistics.
+     */
+    void clear();
+
+    const Statistics& getStatistics() const { return m_statistics; }
+
+    /**
+     * @brief Gets the number of external reference queries avoided by the cache.
+     */
+    std::size_t getNrOfAvoidedQueries() const { return m_statistics.lookups > m_statistics.queries ? m_statistics.lookups - m_statistics.queries : 0; }
+
+    /**
+     * @brief Describes the external reference queries made and avoided during the run.
+     */
+    std::string getStatisticsSummary() const;
+
+private:
+    /**
+     * @brief Resolves all the component features of an assembly.
+     * @param owner The assembly.
+     * @param references The references, keyed by feature id.
+     */
+    void resolveOwner(pfcSolid_ptr owner, std::unordered_map<int, SolidReferences>& references);
+
+    std::unordered_map<std::string, OwnerReferences> m_owners; ///< The references of each owner, keyed by owner name.
+    Statistics m_statistics; ///< Counters of the current run.
+    std::size_t m_run{ 0 };  ///< Counter of the runs.
+};
+
+#endif // !SOLID_REFERENCE_CACHE_H
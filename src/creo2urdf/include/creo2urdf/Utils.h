@@ -20,6 +20,7 @@
 #include <string>
 #include <array>
 #include <map>
+#include <memory>
 #include <unordered_map>
 
 #include <pfcGlobal.h>
@@ -29,6 +30,8 @@
 
 #include <wfcGeometry.h>
 
+#include <creo2urdf/NameInterner.h>
+
 #include <iDynTree/Model/Model.h>
 #include <iDynTree/Model/RevoluteJoint.h>
 #include <iDynTree/Model/FixedJoint.h>
@@ -178,7 +181,7 @@ struct SensorInfo {
     bool exportFrameInURDF{ false };            ///< Flag indicating whether to export the frame in URDF.
     SensorType type{ SensorType::None };        ///< Type of the sensor.
     double updateRate{ 100 };                   ///< Update rate of the sensor.
-    std::vector<std::string> xmlBlobs;          ///< Additional XML blobs that can be appended to the XML tree.
+    std::shared_ptr<const std::vector<std::string>> xmlBlobs; ///< Additional XML blobs that can be appended to the XML tree, shared by the generated sensors.
 };
 
 /**
@@ -234,18 +237,22 @@ enum class JointType {
  */
 struct JointInfo {
     std::string datum_name{""}; ///< Name of the joint's associated datum (axis for revolute, csys for fixed).
-    std::string parent_link_name{""}; ///< Name of the parent link connected to the joint.
-    std::string child_link_name{""}; ///< Name of the child link connected to the joint.
+    NameInterner::Id parent_link_id{NameInterner::INVALID_ID}; ///< Id of the name of the parent link connected to the joint, in the names of the joint map.
+    NameInterner::Id child_link_id{NameInterner::INVALID_ID}; ///< Id of the name of the child link connected to the joint, in the names of the joint map.
     JointType type{JointType::None}; ///< Type of the joint (default is none).
 
     /**
      * @brief Limits for joint movement.
      */
     struct Limits {
-        double min = 0.0; ///< Minimum allowed value for joint movement.
-        double max = 360.0; ///< Maximum allowed value for joint movement.
+        bool available = false; ///< Flag indicating whether both limits are enabled in the joint axis settings of Creo.
+        double min = 0.0; ///< Minimum allowed value for joint movement, in degrees for revolute joints and scaled model units for linear joints.
+        double max = 360.0; ///< Maximum allowed value for joint movement, in degrees for revolute joints and scaled model units for linear joints.
     } limits;
 
+    bool has_initial_transform{false}; ///< Flag indicating whether the initial placement was read from the element tree.
+    iDynTree::Transform initial_transform{iDynTree::Transform::Identity()}; ///< Initial placement of the child component wrt the parent one (PRO_E_COMPONENT_INIT_POS).
+
     /**
      * @brief Dynamic parameters for the joint.
      */
@@ -255,6 +262,15 @@ struct JointInfo {
     } dynamics;
 };
 
+/**
+ * @brief An axis of a part, read from the model before it is released.
+ */
+struct AxisInfo {
+    std::string name{""}; ///< Name of the axis.
+    iDynTree::Direction direction; ///< Direction of the axis in the link frame.
+    iDynTree::Position mid_point{iDynTree::Position::Zero()}; ///< Middle point of the axis, scaled as the link.
+};
+
 /**
  * @brief Information about a link, including its name, model handle, transformation, and frame name.
  */
@@ -264,6 +280,11 @@ struct LinkInfo {
     iDynTree::Transform rootAsm_H_linkFrame{iDynTree::Transform::Identity()}; ///< 3D Transform from the root to the link's reference frame.
     iDynTree::Transform csysAsm_H_linkFrame{iDynTree::Transform::Identity()}; ///< 3D Transform from the assembly to the link's reference frame.
     std::string link_frame_name{""}; ///< Name of the link frame.
+    double creo_mass{0.0}; ///< Mass of the part as computed by Creo, in kg.
+    double creo_volume{0.0}; ///< Volume of the part as computed by Creo, scaled as the link.
+    std::string mesh_file_name{""}; ///< Path of the exported STL mesh, empty if it was not exported as STL.
+    std::vector<std::string> csys_names; ///< Names of the coordinate systems of the part, in model order.
+    std::vector<AxisInfo> axes; ///< Axes of the part, read during the traversal when the model is released in streaming mode.
 };
 
 /**
@@ -434,6 +455,17 @@ std::pair<bool, iDynTree::Transform> getTransformFromOwnerToLinkFrame(pfcCompone
  */
 std::pair<bool, iDynTree::Transform> getTransformFromPart(pfcModel_ptr modelhdl, const std::string& link_frame_name, const array<double, 3>& scale);
 
+/**
+ * @brief Retrieves all the coordinate systems of a model with a single listing of its items.
+ *
+ * @param modelhdl The model.
+ * @param scale scaling factor for expressing the position of the transforms.
+ *
+ * @return std::vector<std::pair<std::string, iDynTree::Transform>> The names of the coordinate systems and their
+ *         transforms wrt the default frame of the model.
+ */
+std::vector<std::pair<std::string, iDynTree::Transform>> getCoordinateSystems(pfcModel_ptr modelhdl, const array<double, 3>& scale);
+
 /**
  * @brief Gets the desired axis the from the model.
  * The direction is expressed in the coordinate system defined by link_frame_name.
@@ -446,6 +478,22 @@ std::pair<bool, iDynTree::Transform> getTransformFromPart(pfcModel_ptr modelhdl,
  */
 std::tuple<bool, iDynTree::Direction, iDynTree::Position> getAxisFromPart(pfcModel_ptr modelhdl, const std::string& axis_name, const std::string& link_frame_name, const array<double, 3>& scale);
 
+/**
+ * @brief Gets all the axes of the model, as getAxisFromPart does for a single axis.
+ *
+ * @param modelhdl The model handle that contains link_frame_name
+ * @param link_frame_name The name of the frame belonging to modelhdl
+ * @param scale The scaling factor for the middle points of the axes
+ * @return std::vector<AxisInfo> The axes of the model, in model order.
+ */
+std::vector<AxisInfo> getAxesFromPart(pfcModel_ptr modelhdl, const std::string& link_frame_name, const array<double, 3>& scale);
+
+/**
+ * @brief Gets the peak memory used by the process.
+ * @return The peak working set in bytes, 0 if it cannot be read.
+ */
+std::size_t getPeakMemoryUsage();
+
 /**
  * @brief Extracts the folder path from a file path.
  * 
@@ -464,4 +512,31 @@ std::string extractFolderPath(const std::string& filePath);
  */
 void mergeYAMLNodes(YAML::Node& dest, const YAML::Node& src);
 
+/**
+ * @brief Loads a YAML configuration file, merging the files listed in its `includes` section.
+ * 
+ * @param filename The name of the YAML configuration file.
+ * @param config The YAML node where the configuration is stored.
+ * @return True if successful, false otherwise.
+ */
+bool loadYamlConfigWithIncludes(const std::string& filename, YAML::Node& config);
+
+/**
+ * @brief Gets the name of the csys used as link frame, as defined in the `linkFrames` section of the configuration.
+ * 
+ * @param config The YAML configuration node.
+ * @param urdf_link_name The name of the link in the URDF.
+ * @return std::string The name of the link frame, empty if the link is not listed in `linkFrames`.
+ */
+std::string getLinkFrameNameFromConfig(const YAML::Node& config, const std::string& urdf_link_name);
+
+/**
+ * @brief Computes the distance between two poses on SE(3).
+ * 
+ * @param a_H_frame The first pose.
+ * @param b_H_frame The second pose.
+ * @return std::pair<double, double> The norm of the position difference and the angle of the relative rotation in radians.
+ */
+std::pair<double, double> computePoseDistance(const iDynTree::Transform& a_H_frame, const iDynTree::Transform& b_H_frame);
+
 #endif // !UTILS_H
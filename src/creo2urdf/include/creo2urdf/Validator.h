@@ -10,26 +10,233 @@
 #define VALIDATOR_H
 
 #include <pfcGlobal.h>
+#include <pfcAssembly.h>
 #include <creo2urdf/Utils.h>
+#include <creo2urdf/ElementTreeManager.h>
+#include <creo2urdf/ModelRegistry.h>
+#include <creo2urdf/RenameTable.h>
+#include <creo2urdf/JointTable.h>
 
 #include <iDynTree/ModelIO/ModelLoader.h>
 #include <iDynTree/KinDynComputations.h>
 
+
+#include <limits>
+
+/**
+ * @brief Poses of the links of the assembly, recorded at a given joint configuration.
+ */
+struct ValidationSnapshot {
+    iDynTree::VectorDynSize joint_positions; ///< Joint positions in URDF units, ordered as the DOFs of the URDF model.
+    std::vector<iDynTree::Transform> root_H_links; ///< Pose of each link wrt the root assembly, indexed by URDF link index.
+    std::vector<bool> has_link; ///< Flags indicating whether the pose of the link with the same index was recorded.
+};
+
+/**
+ * @brief Errors between the Creo and the URDF poses of a link, accumulated over all the validated configurations.
+ */
+struct LinkValidationError {
+    std::string link_name{ "" }; ///< Name of the link in the URDF.
+    double home_position_offset{ 0.0 }; ///< Distance between the Creo and the URDF link frames in the reference configuration, in m.
+    double home_rotation_offset{ 0.0 }; ///< Angle between the Creo and the URDF link frames in the reference configuration, in rad.
+    double max_position_error{ 0.0 }; ///< Maximum position error, in m.
+    double mean_position_error{ 0.0 }; ///< Mean position error, in m.
+    double max_rotation_error{ 0.0 }; ///< Maximum rotation error, in rad.
+    double mean_rotation_error{ 0.0 }; ///< Mean rotation error, in rad.
+    std::size_t worst_snapshot{ 0 }; ///< Index of the configuration with the largest position error.
+    std::size_t nr_of_samples{ 0 }; ///< Number of configurations in which the link was compared.
+};
+
+/**
+ * @brief Dynamic quantities of a joint, accumulated over the configurations of the dynamics sweep.
+ */
+struct JointDynamicsInfo {
+    std::string joint_name{ "" }; ///< Name of the joint in the URDF.
+    double effort_limit{ std::numeric_limits<double>::infinity() }; ///< Effort limit read from the CSV file, infinite if not available.
+    double peak_gravity_torque{ 0.0 }; ///< Maximum absolute value of the gravity torque (or force).
+    std::size_t peak_sample{ 0 }; ///< Index of the configuration with the peak gravity torque.
+    double min_mass_matrix_diagonal{ std::numeric_limits<double>::infinity() }; ///< Minimum of the diagonal element of the joint-space mass matrix.
+};
+
+/**
+ * @brief Results of the dynamics sweep over the sampled joint configurations.
+ */
+struct DynamicsSweepReport {
+    double worst_condition_number{ 0.0 }; ///< Worst condition number of the joint-space mass matrix.
+    std::size_t worst_conditioned_sample{ 0 }; ///< Index of the configuration with the worst condition number.
+    std::size_t nr_of_samples{ 0 }; ///< Number of configurations in the sweep.
+    std::vector<JointDynamicsInfo> joints; ///< Per-joint quantities, ordered as the DOFs of the URDF model.
+};
+
+/**
+ * @class Validator
+ * @brief A class that validates an exported URDF against the Creo mechanism assembly.
+ *
+ * The joint configurations are sampled inside the limits of the CSV file, the assembly is driven to
+ * each of them (or recorded snapshots are loaded from file), and the pose of every link is compared
+ * with the one computed by iDynTree, using distances on SE(3).
+ */
 class Validator : public pfcUICommandActionListener {
 public:
+    /**
+     * @brief Callback function triggered when the button is clicked.
+     *
+     * @details The order of operations is the following:
+     *  - Prompt the user to select the .urdf, .yaml and .csv files
+     *  - Record the pose of all the links in the current configuration of the assembly, used as reference
+     *  - Sample the joint configurations inside the CSV limits and drive the assembly to each of them,
+     *    or load the recorded snapshots listed in the `validation` section of the configuration
+     *  - Compute the forward kinematics of all the configurations in parallel
+     *  - Write the per-link error report next to the urdf
+     *  - Optionally run the dynamics sweep and write the per-joint dynamics report next to the urdf
+     */
     void OnCommand() override;
 
+    Validator() = default;
+    ~Validator() = default;
+    Validator(const std::string& urdf_path, const std::string& yaml_path, const std::string& csv_path, pfcModel_ptr asm_model_ptr) : m_urdf_path(urdf_path),
+                                                                                                                                     m_yaml_path(yaml_path),
+                                                                                                                                     m_csv_path(csv_path),
+                                                                                                                                     creo_model_ptr(asm_model_ptr) { }
+
 private:
+    /**
+     * @brief A link of the assembly, as needed to record its pose.
+     */
+    struct CreoLinkRecord {
+        std::string urdf_link_name{ "" }; ///< Name of the link in the URDF.
+        pfcComponentPath_ptr comp_path{ nullptr }; ///< Component path from the root assembly to the part.
+        iDynTree::Transform csysPart_H_linkFrame{ iDynTree::Transform::Identity() }; ///< Transform from the part csys to the link frame.
+    };
 
-    iDynTree::Model idyn_model;
-    pfcSession_ptr creo_session_ptr;
-    pfcModel_ptr creo_model_ptr;
-    std::map<std::string, iDynTree::Transform> link_name_to_creo_computed_trf_map;
-    iDynTree::KinDynComputations computer;
+    /**
+     * @brief A joint of the assembly, as needed to drive it.
+     */
+    struct CreoJointRecord {
+        pfcFeature_ptr feat{ nullptr }; ///< Component feature defining the joint.
+        JointType type{ JointType::None }; ///< Type of the joint.
+        double home_value{ 0.0 }; ///< Regeneration value of the joint when the validation started.
+        double direction{ 1.0 }; ///< Sign relating the regeneration value to the URDF joint position.
+        bool drivable{ false }; ///< Flag indicating whether the regeneration value could be read and calibrated.
+    };
 
+    /**
+     * @brief Load the URDF model that has to be validated.
+     * @param filename The path of the URDF file.
+     * @return True if successful, false otherwise.
+     */
     bool loadUrdfFromFile(const std::string& filename);
-    bool assignCreoTransformToLink();
-    bool validatePositions(iDynTree::VectorDynSize positions);
+
+    /**
+     * @brief Traverses the assembly, storing the component paths of the links and the features defining the joints.
+     * @param model_owner The assembly that owns the components.
+     * @param owner_path The ids of the component features from the root assembly to model_owner.
+     * @return True if successful, false otherwise.
+     */
+    bool collectLinksAndJoints(pfcModel_ptr model_owner, const std::vector<int>& owner_path);
+
+    /**
+     * @brief Records the pose of all the links in the current configuration of the assembly.
+     * @param joint_positions The joint positions of the current configuration, in URDF units.
+     * @param snapshot The recorded snapshot.
+     * @return True if successful, false otherwise.
+     */
+    bool recordCreoSnapshot(const iDynTree::VectorDynSize& joint_positions, ValidationSnapshot& snapshot);
+
+    /**
+     * @brief Drives the joints of the assembly to the given configuration and regenerates it.
+     * @param joint_positions The joint positions, in URDF units.
+     * @return True if successful, false otherwise.
+     */
+    bool driveCreoToConfiguration(const iDynTree::VectorDynSize& joint_positions);
+
+    /**
+     * @brief Finds for every joint the sign relating the Creo regeneration value to the URDF joint position,
+     * by moving each joint by a small amount.
+     * @param home_snapshot The snapshot recorded in the reference configuration.
+     */
+    void calibrateJointDirections(const ValidationSnapshot& home_snapshot);
+
+    /**
+     * @brief Samples uniformly the joint configurations inside the limits of the CSV file.
+     * @param csv The joint parameters read from the CSV file.
+     * @param nr_of_samples The number of configurations to sample.
+     * @param seed The seed of the random generator, to make the sweep reproducible.
+     * @param drivable_only If true only the joints that can be driven in Creo are sampled, the others are kept in 0.
+     * @return The sampled joint configurations, ordered as the DOFs of the URDF model.
+     */
+    std::vector<iDynTree::VectorDynSize> sampleJointConfigurations(const JointTable& csv, std::size_t nr_of_samples, unsigned int seed, bool drivable_only = true);
+
+    /**
+     * @brief Loads recorded snapshots from a YAML file.
+     * @param filename The path of the snapshot file.
+     * @param snapshots The loaded snapshots.
+     * @return True if successful, false otherwise.
+     */
+    bool loadSnapshotsFromFile(const std::string& filename, std::vector<ValidationSnapshot>& snapshots);
+
+    /**
+     * @brief Compares the recorded poses with the ones computed by iDynTree.
+     * The first snapshot is used as reference to compute the constant offset between the Creo and the URDF link frames.
+     * The configurations are processed in parallel.
+     * @param snapshots The recorded snapshots.
+     * @return The errors of every link of the URDF model.
+     */
+    std::vector<LinkValidationError> validatePositions(const std::vector<ValidationSnapshot>& snapshots);
+
+    /**
+     * @brief Computes the mass matrix and the generalized gravity forces of the URDF model in the given configurations,
+     * with the base fixed and upright. The configurations are processed in parallel.
+     * @param samples The joint configurations.
+     * @param csv The joint parameters read from the CSV file, containing the effort limits.
+     * @return The worst conditioning of the mass matrix and the peak gravity torque of every joint.
+     */
+    DynamicsSweepReport runDynamicsSweep(const std::vector<iDynTree::VectorDynSize>& samples, const JointTable& csv);
+
+    /**
+     * @brief Finds the links whose mass or principal moments of inertia are below the given thresholds.
+     * @param min_mass The minimum mass, in kg.
+     * @param min_inertia The minimum principal moment of inertia, in kg m^2.
+     * @return The names of the links, with a description of the issue.
+     */
+    std::vector<std::string> findTinyInertiaLinks(double min_mass, double min_inertia);
+
+    /**
+     * @brief Writes the per-joint dynamics report as a CSV file.
+     * @param filename The path of the report.
+     * @param report The results of the dynamics sweep.
+     * @return True if successful, false otherwise.
+     */
+    bool writeDynamicsReport(const std::string& filename, const DynamicsSweepReport& report);
+
+    /**
+     * @brief Writes the per-link error report as a CSV file.
+     * @param filename The path of the report.
+     * @param errors The errors of every link.
+     * @return True if successful, false otherwise.
+     */
+    bool writeReport(const std::string& filename, const std::vector<LinkValidationError>& errors);
+
+    /**
+     * @brief Get the renamed element from the configuration.
+     * @param elem_name The original element name.
+     * @return The renamed element name, or elem_name if it is not renamed.
+     */
+    std::string getRenameElementFromConfig(const std::string& elem_name);
+
+    iDynTree::Model idyn_model; /**< The URDF model that is validated. */
+    pfcSession_ptr creo_session_ptr{ nullptr }; /**< Handle to the Creo session. */
+    pfcModel_ptr creo_model_ptr{ nullptr }; /**< Handle to the root assembly. */
+    YAML::Node config; /**< YAML configuration node, storing the content of the configuration file. */
+    RenameTable rename_table; /**< The rename section of the configuration, indexed in both directions. */
+    SolidReferenceCache solid_reference_cache; /**< The solids referenced by the component features, resolved once per owner revision and kept across the runs. */
+    ModelRegistry model_registry; /**< The models retrieved while collecting the links and joints. */
+    std::array<double, 3> scale{ 1.0, 1.0, 1.0 }; /**< Scale factor used when the model was exported. */
+    std::vector<CreoLinkRecord> creo_links; /**< Links found in the assembly. */
+    std::map<std::string, CreoJointRecord> creo_joints; /**< Joints found in the assembly, keyed by URDF joint name. */
+    std::string m_urdf_path{ "" }; /**< Path to the URDF file to be validated. */
+    std::string m_yaml_path{ "" }; /**< Path to the YAML configuration file. */
+    std::string m_csv_path{ "" }; /**< Path to the CSV file containing joint information. */
 };
 
 class ValidatorAccess : public pfcUICommandAccessListener {
@@ -0,0 +1,90 @@
+/** @file XMLTemplate.h
+ *  @brief Contains declarations for the XMLTemplate class and the helpers used to fill it.
+ *
+ * An XMLTemplate is an XML tree serialised once by libxml2, with marker strings in place of the values
+ * that change from one element to the other. Filling it only concatenates the literal parts and the
+ * values, so it does not touch libxml2 and can be done from multiple threads.
+ *
+ *  @bug No known bugs.
+ *
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef XML_TEMPLATE_H
+#define XML_TEMPLATE_H
+
+#include <string>
+#include <vector>
+
+#include <libxml2/libxml/tree.h>
+
+/**
+ * @brief Pre-serialised XML tree with slots for the values.
+ */
+class XMLTemplate {
+public:
+    /**
+     * @brief Gets the marker to be written in the XML tree in place of the value of a slot.
+     * @param slot The index of the slot.
+     * @return The marker, containing only characters that libxml2 does not escape.
+     */
+    static std::string getSlotMarker(std::size_t slot);
+
+    /**
+     * @brief Serialises an XML tree containing slot markers, with the same formatting as the exported blobs.
+     * @param doc The document of the tree.
+     * @param root_node The root of the tree.
+     * @param nr_of_slots The number of slots, all the markers must have an index lower than this.
+     * @return true if the tree was serialised, false if a marker has an invalid index.
+     */
+    bool compile(xmlDocPtr doc, xmlNodePtr root_node, std::size_t nr_of_slots);
+
+    /**
+     * @brief Splits a serialised XML tree at the slot markers.
+     * @param serialised The serialised tree.
+     * @param nr_of_slots The number of slots, all the markers must have an index lower than this.
+     * @return true if the tree was split, false if a marker has an invalid index.
+     */
+    bool compile(const std::string& serialised, std::size_t nr_of_slots);
+
+    /**
+     * @brief Fills the slots of the template.
+     * @param values Pointer to getNrOfSlots() values, already escaped (see escapeXML). A value can fill more than one slot.
+     * @return The XML tree as string.
+     */
+    std::string fill(const std::string* values) const;
+
+    std::size_t getNrOfSlots() const { return m_nr_of_slots; }
+
+private:
+    std::vector<std::string> m_literals; ///< The text between the slots, one element more than m_slots.
+    std::vector<std::size_t> m_slots;    ///< Indices of the values filling the slots, in order of appearance.
+    std::size_t m_nr_of_slots{ 0 };      ///< Number of values expected by fill.
+};
+
+/**
+ * @brief Escapes the characters that cannot appear as they are in XML text or attribute values.
+ * @param value The value.
+ * @return The escaped value.
+ */
+std::string escapeXML(const std::string& value);
+
+/**
+ * @brief Appends a number to a string, formatted as a stream with the default precision would do.
+ * @param out The string.
+ * @param value The number.
+ */
+void appendFormattedDouble(std::string& out, double value);
+
+/**
+ * @brief Formats numbers separated by spaces.
+ * @param values The numbers.
+ * @param count The number of values.
+ * @return The formatted numbers.
+ */
+std::string formatDoubles(const double* values, std::size_t count);
+
+#endif // !XML_TEMPLATE_H
@@ -0,0 +1,442 @@
+/**
+ * @file CollisionData.cpp
+ * @brief Contains definitions for precomputing the collision data of the exported meshes.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/CollisionData.h>
+
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+constexpr std::uint32_t SparseSdf::brick_size;
+
+namespace {
+
+const char bvh_magic[8] = { 'C', '2', 'U', 'B', 'V', 'H', '0', '1' };
+const char sdf_magic[8] = { 'C', '2', 'U', 'S', 'D', 'F', '0', '1' };
+
+template <class T>
+void writeValue(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Closest point of a triangle to p, see C. Ericson, "Real-Time Collision Detection", 5.1.5.
+ */
+Eigen::Vector3d closestPointOnTriangle(const Eigen::Vector3d& p, const Eigen::Vector3d& a, const Eigen::Vector3d& b, const Eigen::Vector3d& c)
+{
+    const Eigen::Vector3d ab = b - a;
+    const Eigen::Vector3d ac = c - a;
+    const Eigen::Vector3d ap = p - a;
+    const double d1 = ab.dot(ap);
+    const double d2 = ac.dot(ap);
+    if (d1 <= 0.0 && d2 <= 0.0) return a;
+
+    const Eigen::Vector3d bp = p - b;
+    const double d3 = ab.dot(bp);
+    const double d4 = ac.dot(bp);
+    if (d3 >= 0.0 && d4 <= d3) return b;
+
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) return a + ab * (d1 / (d1 - d3));
+
+    const Eigen::Vector3d cp = p - c;
+    const double d5 = ab.dot(cp);
+    const double d6 = ac.dot(cp);
+    if (d6 >= 0.0 && d5 <= d6) return c;
+
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) return a + ac * (d2 / (d2 - d6));
+
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const double denom = 1.0 / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+double squaredDistanceToBox(const Eigen::Vector3d& p, const BvhNode& node)
+{
+    const Eigen::Vector3d lower = node.min_corner.cast<double>() - p;
+    const Eigen::Vector3d upper = p - node.max_corner.cast<double>();
+    return lower.cwiseMax(upper).cwiseMax(0.0).squaredNorm();
+}
+
+/**
+ * @brief Unsigned distance from p to the mesh.
+ */
+double unsignedDistance(const Bvh& bvh, const Eigen::Vector3d& p)
+{
+    double best = std::numeric_limits<double>::infinity();
+    std::vector<std::uint32_t> stack{ 0 };
+    while (!stack.empty()) {
+        const std::uint32_t index = stack.back();
+        stack.pop_back();
+        const auto& node = bvh.nodes[index];
+        if (squaredDistanceToBox(p, node) >= best) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (std::uint32_t t = node.offset; t < node.offset + node.count; t++) {
+                const Eigen::Vector3d q = closestPointOnTriangle(p, bvh.mesh.v0.col(t), bvh.mesh.v1.col(t), bvh.mesh.v2.col(t));
+                best = std::min(best, (p - q).squaredNorm());
+            }
+            continue;
+        }
+        // Visit the closest child first
+        std::uint32_t left = index + 1;
+        std::uint32_t right = node.offset;
+        if (squaredDistanceToBox(p, bvh.nodes[left]) < squaredDistanceToBox(p, bvh.nodes[right])) {
+            std::swap(left, right);
+        }
+        stack.push_back(left);
+        stack.push_back(right);
+    }
+    return std::sqrt(best);
+}
+
+/**
+ * @brief Checks whether p is inside a closed mesh, by counting the intersections of a ray with the surface.
+ */
+bool isInside(const Bvh& bvh, const Eigen::Vector3d& p)
+{
+    // A direction not aligned with the axes, to avoid hitting the edges of axis-aligned tessellations
+    const Eigen::Vector3d direction = Eigen::Vector3d(1.0, 0.0137, 0.0071).normalized();
+    const Eigen::Vector3d inverse_direction = direction.cwiseInverse();
+
+    std::size_t hits = 0;
+    std::vector<std::uint32_t> stack{ 0 };
+    while (!stack.empty()) {
+        const std::uint32_t index = stack.back();
+        stack.pop_back();
+        const auto& node = bvh.nodes[index];
+
+        const Eigen::Vector3d t0 = (node.min_corner.cast<double>() - p).cwiseProduct(inverse_direction);
+        const Eigen::Vector3d t1 = (node.max_corner.cast<double>() - p).cwiseProduct(inverse_direction);
+        const double t_enter = t0.cwiseMin(t1).maxCoeff();
+        const double t_exit = t0.cwiseMax(t1).minCoeff();
+        if (t_exit < 0.0 || t_enter > t_exit) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack.push_back(index + 1);
+            stack.push_back(node.offset);
+            continue;
+        }
+        // Moller-Trumbore intersection
+        for (std::uint32_t t = node.offset; t < node.offset + node.count; t++) {
+            const Eigen::Vector3d e1 = bvh.mesh.v1.col(t) - bvh.mesh.v0.col(t);
+            const Eigen::Vector3d e2 = bvh.mesh.v2.col(t) - bvh.mesh.v0.col(t);
+            const Eigen::Vector3d h = direction.cross(e2);
+            const double det = e1.dot(h);
+            if (std::abs(det) < 1e-18) {
+                continue;
+            }
+            const Eigen::Vector3d s = p - bvh.mesh.v0.col(t);
+            const double u = s.dot(h) / det;
+            if (u < 0.0 || u > 1.0) {
+                continue;
+            }
+            const Eigen::Vector3d q = s.cross(e1);
+            const double v = direction.dot(q) / det;
+            if (v < 0.0 || u + v > 1.0) {
+                continue;
+            }
+            if (e2.dot(q) / det > 0.0) {
+                hits++;
+            }
+        }
+    }
+    return hits % 2 == 1;
+}
+
+/**
+ * @brief Checks whether two triangles intersect or touch, by looking for a separating axis among the normals,
+ * the cross products of the edges and, for coplanar triangles, the normals of the edges in the plane.
+ */
+bool trianglesIntersect(const std::array<Eigen::Vector3d, 3>& a, const std::array<Eigen::Vector3d, 3>& b)
+{
+    auto separates = [&](const Eigen::Vector3d& axis) {
+        if (axis.squaredNorm() < 1e-24) {
+            return false;
+        }
+        double min_a = std::numeric_limits<double>::infinity(), max_a = -min_a;
+        double min_b = min_a, max_b = max_a;
+        for (std::size_t i = 0; i < 3; i++) {
+            min_a = std::min(min_a, axis.dot(a[i]));
+            max_a = std::max(max_a, axis.dot(a[i]));
+            min_b = std::min(min_b, axis.dot(b[i]));
+            max_b = std::max(max_b, axis.dot(b[i]));
+        }
+        return max_a < min_b || max_b < min_a;
+    };
+
+    const std::array<Eigen::Vector3d, 3> edges_a{ { a[1] - a[0], a[2] - a[1], a[0] - a[2] } };
+    const std::array<Eigen::Vector3d, 3> edges_b{ { b[1] - b[0], b[2] - b[1], b[0] - b[2] } };
+    const Eigen::Vector3d normal_a = edges_a[0].cross(edges_a[1]);
+    const Eigen::Vector3d normal_b = edges_b[0].cross(edges_b[1]);
+    if (separates(normal_a) || separates(normal_b)) {
+        return false;
+    }
+    for (const auto& edge_a : edges_a) {
+        for (const auto& edge_b : edges_b) {
+            if (separates(edge_a.cross(edge_b))) {
+                return false;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < 3; i++) {
+        if (separates(normal_a.cross(edges_a[i])) || separates(normal_b.cross(edges_b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks whether the box of a node overlaps the box of a node of another hierarchy, expressed by R and p.
+ */
+bool nodesOverlap(const BvhNode& a, const BvhNode& b, const Eigen::Matrix3d& R, const Eigen::Vector3d& p)
+{
+    const Eigen::Vector3d center_b = R * (0.5f * (b.min_corner + b.max_corner)).cast<double>() + p;
+    const Eigen::Vector3d half_b = R.cwiseAbs() * (0.5f * (b.max_corner - b.min_corner)).cast<double>();
+    return ((center_b - half_b).array() <= a.max_corner.cast<double>().array()).all() &&
+           ((center_b + half_b).array() >= a.min_corner.cast<double>().array()).all();
+}
+
+/**
+ * @brief Data shared by the recursive construction of a hierarchy.
+ */
+struct BvhBuilder {
+    Eigen::Matrix3Xd centroids;
+    Eigen::Matrix3Xd min_corners;
+    Eigen::Matrix3Xd max_corners;
+    std::vector<std::uint32_t> order;
+    std::vector<BvhNode> nodes;
+    std::uint32_t max_leaf_size;
+
+    /**
+     * @brief Builds the subtree of the triangles in [begin, end), returning the index of its root.
+     * The depth is logarithmic, since the triangles are always split in two halves.
+     */
+    std::uint32_t build(std::uint32_t begin, std::uint32_t end)
+    {
+        const std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+        nodes.emplace_back();
+
+        Eigen::Vector3d min_corner = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+        Eigen::Vector3d max_corner = -min_corner;
+        Eigen::Vector3d min_centroid = min_corner;
+        Eigen::Vector3d max_centroid = max_corner;
+        for (std::uint32_t i = begin; i < end; i++) {
+            min_corner = min_corner.cwiseMin(min_corners.col(order[i]));
+            max_corner = max_corner.cwiseMax(max_corners.col(order[i]));
+            min_centroid = min_centroid.cwiseMin(centroids.col(order[i]));
+            max_centroid = max_centroid.cwiseMax(centroids.col(order[i]));
+        }
+        nodes[index].min_corner = min_corner.cast<float>();
+        nodes[index].max_corner = max_corner.cast<float>();
+
+        const std::uint32_t count = end - begin;
+        Eigen::Index axis{ 0 };
+        const double spread = (max_centroid - min_centroid).maxCoeff(&axis);
+        if (count <= max_leaf_size || spread <= 0.0) {
+            nodes[index].offset = begin;
+            nodes[index].count = count;
+            return index;
+        }
+
+        const std::uint32_t middle = begin + count / 2;
+        std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                         [this, axis](std::uint32_t a, std::uint32_t b) { return centroids(axis, a) < centroids(axis, b); });
+
+        build(begin, middle);
+        const std::uint32_t right = build(middle, end);
+        nodes[index].offset = right;
+        return index;
+    }
+};
+
+} // namespace
+
+Bvh buildBvh(const TriangleMesh& mesh, std::uint32_t max_leaf_size)
+{
+    Bvh bvh;
+    const std::uint32_t nr_of_triangles = static_cast<std::uint32_t>(mesh.size());
+    if (nr_of_triangles == 0) {
+        return bvh;
+    }
+
+    BvhBuilder builder;
+    builder.centroids = (mesh.v0 + mesh.v1 + mesh.v2) / 3.0;
+    builder.min_corners = mesh.v0.cwiseMin(mesh.v1).cwiseMin(mesh.v2);
+    builder.max_corners = mesh.v0.cwiseMax(mesh.v1).cwiseMax(mesh.v2);
+    builder.order.resize(nr_of_triangles);
+    std::iota(builder.order.begin(), builder.order.end(), 0);
+    builder.max_leaf_size = std::max<std::uint32_t>(1, max_leaf_size);
+    builder.nodes.reserve(2 * nr_of_triangles / builder.max_leaf_size + 1);
+    builder.build(0, nr_of_triangles);
+
+    bvh.nodes = std::move(builder.nodes);
+    bvh.mesh.v0.resize(3, nr_of_triangles);
+    bvh.mesh.v1.resize(3, nr_of_triangles);
+    bvh.mesh.v2.resize(3, nr_of_triangles);
+    for (std::uint32_t i = 0; i < nr_of_triangles; i++) {
+        bvh.mesh.v0.col(i) = mesh.v0.col(builder.order[i]);
+        bvh.mesh.v1.col(i) = mesh.v1.col(builder.order[i]);
+        bvh.mesh.v2.col(i) = mesh.v2.col(builder.order[i]);
+    }
+    return bvh;
+}
+
+SparseSdf computeSparseSdf(const Bvh& bvh, double voxel_size, double band_width, std::uint32_t max_resolution)
+{
+    SparseSdf sdf;
+    if (bvh.nodes.empty() || voxel_size <= 0.0 || max_resolution < 2) {
+        return sdf;
+    }
+
+    const double band = band_width * voxel_size;
+    const Eigen::Vector3d min_corner = bvh.nodes[0].min_corner.cast<double>() - Eigen::Vector3d::Constant(band);
+    const Eigen::Vector3d max_corner = bvh.nodes[0].max_corner.cast<double>() + Eigen::Vector3d::Constant(band);
+    const double max_extent = (max_corner - min_corner).maxCoeff();
+    sdf.voxel_size = std::max(voxel_size, max_extent / (max_resolution - 1));
+    sdf.origin = min_corner;
+
+    const std::uint32_t n = SparseSdf::brick_size;
+    for (int axis = 0; axis < 3; axis++) {
+        const auto nr_of_voxels = static_cast<std::uint32_t>(std::ceil((max_corner(axis) - min_corner(axis)) / sdf.voxel_size)) + 1;
+        sdf.nr_of_bricks[axis] = (nr_of_voxels + n - 1) / n;
+    }
+
+    // A brick is stored only if the surface may cross the band inside it
+    const double brick_radius = std::sqrt(3.0) * 0.5 * (n - 1) * sdf.voxel_size;
+    const double band_distance = std::max(band, sdf.voxel_size);
+    for (std::uint32_t k = 0; k < sdf.nr_of_bricks[2]; k++) {
+        for (std::uint32_t j = 0; j < sdf.nr_of_bricks[1]; j++) {
+            for (std::uint32_t i = 0; i < sdf.nr_of_bricks[0]; i++) {
+                const Eigen::Vector3d brick_center = sdf.origin + (Eigen::Vector3d(i, j, k) * n + Eigen::Vector3d::Constant(0.5 * (n - 1))) * sdf.voxel_size;
+                if (unsignedDistance(bvh, brick_center) > band_distance + brick_radius) {
+                    continue;
+                }
+                sdf.brick_indices.push_back({ { i, j, k } });
+                for (std::uint32_t z = 0; z < n; z++) {
+                    for (std::uint32_t y = 0; y < n; y++) {
+                        for (std::uint32_t x = 0; x < n; x++) {
+                            const Eigen::Vector3d p = sdf.origin + Eigen::Vector3d(i * n + x, j * n + y, k * n + z) * sdf.voxel_size;
+                            const double distance = unsignedDistance(bvh, p);
+                            sdf.values.push_back(static_cast<float>(isInside(bvh, p) ? -distance : distance));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return sdf;
+}
+
+bool writeBvhFile(const std::string& filename, const Bvh& bvh)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    file.write(bvh_magic, sizeof(bvh_magic));
+    writeValue(file, static_cast<std::uint32_t>(bvh.mesh.size()));
+    writeValue(file, static_cast<std::uint32_t>(bvh.nodes.size()));
+    for (Eigen::Index t = 0; t < bvh.mesh.size(); t++) {
+        for (const auto* vertices : { &bvh.mesh.v0, &bvh.mesh.v1, &bvh.mesh.v2 }) {
+            for (int axis = 0; axis < 3; axis++) {
+                writeValue(file, static_cast<float>((*vertices)(axis, t)));
+            }
+        }
+    }
+    for (const auto& node : bvh.nodes) {
+        for (int axis = 0; axis < 3; axis++) {
+            writeValue(file, node.min_corner(axis));
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            writeValue(file, node.max_corner(axis));
+        }
+        writeValue(file, node.offset);
+        writeValue(file, node.count);
+    }
+    return static_cast<bool>(file);
+}
+
+bool writeSdfFile(const std::string& filename, const SparseSdf& sdf)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    file.write(sdf_magic, sizeof(sdf_magic));
+    for (int axis = 0; axis < 3; axis++) {
+        writeValue(file, static_cast<float>(sdf.origin(axis)));
+    }
+    writeValue(file, static_cast<float>(sdf.voxel_size));
+    for (auto nr_of_bricks : sdf.nr_of_bricks) {
+        writeValue(file, nr_of_bricks);
+    }
+    writeValue(file, SparseSdf::brick_size);
+    writeValue(file, static_cast<std::uint32_t>(sdf.brick_indices.size()));
+    for (const auto& brick_index : sdf.brick_indices) {
+        for (auto index : brick_index) {
+            writeValue(file, index);
+        }
+    }
+    file.write(reinterpret_cast<const char*>(sdf.values.data()), sdf.values.size() * sizeof(float));
+    return static_cast<bool>(file);
+}
+
+bool meshesIntersect(const Bvh& a, const Bvh& b, const Eigen::Matrix3d& R, const Eigen::Vector3d& p)
+{
+    if (a.nodes.empty() || b.nodes.empty()) {
+        return false;
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> stack{ { 0, 0 } };
+    while (!stack.empty()) {
+        const auto indices = stack.back();
+        stack.pop_back();
+        const auto& node_a = a.nodes[indices.first];
+        const auto& node_b = b.nodes[indices.second];
+        if (!nodesOverlap(node_a, node_b, R, p)) {
+            continue;
+        }
+        // Descend the internal node, or the larger one if both are internal
+        const bool descend_a = node_a.count == 0 &&
+            (node_b.count > 0 || (node_a.max_corner - node_a.min_corner).squaredNorm() >= (node_b.max_corner - node_b.min_corner).squaredNorm());
+        if (descend_a) {
+            stack.emplace_back(indices.first + 1, indices.second);
+            stack.emplace_back(node_a.offset, indices.second);
+            continue;
+        }
+        if (node_b.count == 0) {
+            stack.emplace_back(indices.first, indices.second + 1);
+            stack.emplace_back(indices.first, node_b.offset);
+            continue;
+        }
+        for (std::uint32_t tb = node_b.offset; tb < node_b.offset + node_b.count; tb++) {
+            const std::array<Eigen::Vector3d, 3> triangle_b{ { R * b.mesh.v0.col(tb) + p, R * b.mesh.v1.col(tb) + p, R * b.mesh.v2.col(tb) + p } };
+            for (std::uint32_t ta = node_a.offset; ta < node_a.offset + node_a.count; ta++) {
+                if (trianglesIntersect({ { a.mesh.v0.col(ta), a.mesh.v1.col(ta), a.mesh.v2.col(ta) } }, triangle_b)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,354 @@
+/**
+ * @file CollisionMatrix.cpp
+ * @brief Contains definitions for the CollisionMatrix class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/CollisionMatrix.h>
+#include <creo2urdf/Parallel.h>
+
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/Model/RevoluteJoint.h>
+
+#include <libxml2/libxml/parser.h>
+#include <libxml2/libxml/tree.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+
+std::vector<iDynTree::VectorDynSize> CollisionMatrix::sampleJointConfigurations(const iDynTree::Model& model, std::size_t nr_of_samples, unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    // An unlimited prismatic joint has no meaningful range, so it is kept at 0
+    std::vector<std::uniform_real_distribution<double>> distributions(model.getNrOfDOFs(), std::uniform_real_distribution<double>(0.0, 0.0));
+    for (iDynTree::JointIndex joint_index = 0; joint_index < static_cast<iDynTree::JointIndex>(model.getNrOfJoints()); joint_index++) {
+        auto joint = model.getJoint(joint_index);
+        if (joint->getNrOfDOFs() != 1) {
+            continue;
+        }
+        if (joint->hasPosLimits() && joint->getMinPosLimit(0) <= joint->getMaxPosLimit(0)) {
+            distributions[joint->getDOFsOffset()] = std::uniform_real_distribution<double>(joint->getMinPosLimit(0), joint->getMaxPosLimit(0));
+        }
+        else if (dynamic_cast<const iDynTree::RevoluteJoint*>(joint) != nullptr) {
+            distributions[joint->getDOFsOffset()] = std::uniform_real_distribution<double>(-M_PI, M_PI);
+        }
+    }
+
+    std::vector<iDynTree::VectorDynSize> samples(nr_of_samples, iDynTree::VectorDynSize(model.getNrOfDOFs()));
+    for (auto& sample : samples) {
+        for (std::size_t dof = 0; dof < distributions.size(); dof++) {
+            sample(dof) = distributions[dof](generator);
+        }
+    }
+    return samples;
+}
+
+bool CollisionMatrix::compute(const iDynTree::Model& model, const std::vector<std::vector<OrientedBox>>& link_boxes,
+                              const std::vector<std::vector<Bvh>>& link_meshes, const std::vector<iDynTree::VectorDynSize>& samples)
+{
+    const std::size_t nr_of_links = model.getNrOfLinks();
+    if (link_boxes.size() != nr_of_links || link_meshes.size() != nr_of_links || samples.empty()) {
+        return false;
+    }
+
+    m_link_names.resize(nr_of_links);
+    m_has_geometry.resize(nr_of_links);
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        m_link_names[l] = model.getLinkName(l);
+        m_has_geometry[l] = !link_boxes[l].empty();
+    }
+
+    m_contact_classes.assign(nr_of_links * nr_of_links, ContactClass::Never);
+    for (iDynTree::JointIndex joint_index = 0; joint_index < static_cast<iDynTree::JointIndex>(model.getNrOfJoints()); joint_index++) {
+        auto joint = model.getJoint(joint_index);
+        auto first = joint->getFirstAttachedLink();
+        auto second = joint->getSecondAttachedLink();
+        m_contact_classes[first * nr_of_links + second] = ContactClass::Adjacent;
+        m_contact_classes[second * nr_of_links + first] = ContactClass::Adjacent;
+    }
+
+    // Pairs that have to be checked in every configuration
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (std::size_t i = 0; i < nr_of_links; i++) {
+        for (std::size_t j = i + 1; j < nr_of_links; j++) {
+            if (m_has_geometry[i] && m_has_geometry[j] && m_contact_classes[i * nr_of_links + j] != ContactClass::Adjacent) {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+
+    // Each worker counts the contacts of its own configurations
+    const std::size_t nr_of_workers = getNumberOfWorkers(samples.size());
+    std::vector<std::vector<std::uint32_t>> contact_counts(nr_of_workers, std::vector<std::uint32_t>(pairs.size(), 0));
+
+    parallelForChunks(samples.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        iDynTree::KinDynComputations kin_dyn;
+        kin_dyn.loadRobotModel(model);
+
+        iDynTree::Vector3 gravity; gravity.zero();
+        iDynTree::VectorDynSize joint_velocities(model.getNrOfDOFs());
+        joint_velocities.zero();
+        std::vector<std::vector<OrientedBox>> world_boxes(nr_of_links);
+
+        for (std::size_t s = begin; s < end; s++) {
+            kin_dyn.setRobotState(iDynTree::Transform::Identity(), samples[s], iDynTree::Twist::Zero(), joint_velocities, gravity);
+            for (std::size_t l = 0; l < nr_of_links; l++) {
+                if (!m_has_geometry[l]) {
+                    continue;
+                }
+                const auto world_H_link = kin_dyn.getWorldTransform(l);
+                const Eigen::Matrix3d R = iDynTree::toEigen(world_H_link.getRotation());
+                const Eigen::Vector3d p = iDynTree::toEigen(world_H_link.getPosition());
+                world_boxes[l].clear();
+                for (const auto& box : link_boxes[l]) {
+                    world_boxes[l].push_back(box.transformed(R, p));
+                }
+            }
+
+            for (std::size_t p = 0; p < pairs.size(); p++) {
+                bool in_contact = false;
+                for (const auto& a : world_boxes[pairs[p].first]) {
+                    for (const auto& b : world_boxes[pairs[p].second]) {
+                        if (overlaps(a, b)) {
+                            in_contact = true;
+                            break;
+                        }
+                    }
+                    if (in_contact) {
+                        break;
+                    }
+                }
+                contact_counts[worker][p] += in_contact ? 1 : 0;
+            }
+        }
+    });
+
+    // The boxes are conservative, so an overlap in every configuration is only a candidate to be always in contact
+    auto hasMeshes = [&](std::size_t l) { return !link_meshes[l].empty() && link_meshes[l].size() == link_boxes[l].size(); };
+    std::vector<std::size_t> candidates;
+    for (std::size_t p = 0; p < pairs.size(); p++) {
+        std::size_t count = 0;
+        for (const auto& worker_counts : contact_counts) {
+            count += worker_counts[p];
+        }
+        ContactClass contact_class = ContactClass::Sometimes;
+        if (count == 0) {
+            contact_class = ContactClass::Never;
+        }
+        else if (count == samples.size() && hasMeshes(pairs[p].first) && hasMeshes(pairs[p].second)) {
+            candidates.push_back(p);
+        }
+        m_contact_classes[pairs[p].first * nr_of_links + pairs[p].second] = contact_class;
+        m_contact_classes[pairs[p].second * nr_of_links + pairs[p].first] = contact_class;
+    }
+
+    if (candidates.empty()) {
+        return true;
+    }
+
+    // A candidate is confirmed if its meshes intersect in every configuration
+    std::vector<std::vector<std::uint8_t>> separated(nr_of_workers, std::vector<std::uint8_t>(candidates.size(), 0));
+    parallelForChunks(samples.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        iDynTree::KinDynComputations kin_dyn;
+        kin_dyn.loadRobotModel(model);
+
+        iDynTree::Vector3 gravity; gravity.zero();
+        iDynTree::VectorDynSize joint_velocities(model.getNrOfDOFs());
+        joint_velocities.zero();
+
+        for (std::size_t s = begin; s < end; s++) {
+            kin_dyn.setRobotState(iDynTree::Transform::Identity(), samples[s], iDynTree::Twist::Zero(), joint_velocities, gravity);
+            for (std::size_t c = 0; c < candidates.size(); c++) {
+                if (separated[worker][c]) {
+                    continue;
+                }
+                const auto first = pairs[candidates[c]].first;
+                const auto second = pairs[candidates[c]].second;
+                const auto first_H_second = kin_dyn.getRelativeTransform(first, second);
+                const Eigen::Matrix3d R = iDynTree::toEigen(first_H_second.getRotation());
+                const Eigen::Vector3d p = iDynTree::toEigen(first_H_second.getPosition());
+                bool in_contact = false;
+                for (std::size_t a = 0; a < link_meshes[first].size() && !in_contact; a++) {
+                    for (std::size_t b = 0; b < link_meshes[second].size() && !in_contact; b++) {
+                        in_contact = meshesIntersect(link_meshes[first][a], link_meshes[second][b], R, p);
+                    }
+                }
+                separated[worker][c] = in_contact ? 0 : 1;
+            }
+        }
+    });
+
+    for (std::size_t c = 0; c < candidates.size(); c++) {
+        bool always = true;
+        for (const auto& worker_separated : separated) {
+            always = always && !worker_separated[c];
+        }
+        if (always) {
+            m_contact_classes[pairs[candidates[c]].first * nr_of_links + pairs[candidates[c]].second] = ContactClass::Always;
+            m_contact_classes[pairs[candidates[c]].second * nr_of_links + pairs[candidates[c]].first] = ContactClass::Always;
+        }
+    }
+
+    return true;
+}
+
+ContactClass CollisionMatrix::getContactClass(std::size_t first, std::size_t second) const
+{
+    return m_contact_classes[first * m_link_names.size() + second];
+}
+
+bool CollisionMatrix::writeSRDF(const std::string& filename, const std::string& robot_name) const
+{
+    const std::map<ContactClass, std::string> reasons{ { ContactClass::Never, "Never" },
+                                                       { ContactClass::Always, "Always" },
+                                                       { ContactClass::Adjacent, "Adjacent" } };
+
+    xmlKeepBlanksDefault(0);
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+    xmlNodePtr root_node = xmlNewNode(NULL, BAD_CAST "robot");
+    xmlDocSetRootElement(doc, root_node);
+    xmlNewProp(root_node, BAD_CAST "name", BAD_CAST robot_name.c_str());
+
+    const std::size_t nr_of_links = m_link_names.size();
+    for (std::size_t i = 0; i < nr_of_links; i++) {
+        for (std::size_t j = i + 1; j < nr_of_links; j++) {
+            auto reason = reasons.find(getContactClass(i, j));
+            if (reason == reasons.end() || !m_has_geometry[i] || !m_has_geometry[j]) {
+                continue;
+            }
+            xmlNodePtr node = xmlNewChild(root_node, NULL, BAD_CAST "disable_collisions", NULL);
+            xmlNewProp(node, BAD_CAST "link1", BAD_CAST m_link_names[i].c_str());
+            xmlNewProp(node, BAD_CAST "link2", BAD_CAST m_link_names[j].c_str());
+            xmlNewProp(node, BAD_CAST "reason", BAD_CAST reason->second.c_str());
+        }
+    }
+
+    bool ok = xmlSaveFormatFileEnc(filename.c_str(), doc, "UTF-8", 1) >= 0;
+    xmlFreeDoc(doc);
+    return ok;
+}
+
+bool CollisionMatrix::buildGazeboCollisionFilterBlobs(std::vector<std::string>& xml_blobs, std::size_t max_bits) const
+{
+    xml_blobs.clear();
+    const std::size_t nr_of_links = m_link_names.size();
+
+    // Two links may share a bit unless they are adjacent or always in contact, and they must share
+    // one if they are sometimes in contact. Each bit is a group of links that may share it, built greedily.
+    auto compatible = [this](std::size_t a, std::size_t b) {
+        auto contact_class = getContactClass(a, b);
+        return contact_class == ContactClass::Never || contact_class == ContactClass::Sometimes;
+    };
+
+    std::vector<std::vector<std::size_t>> groups;
+    std::vector<std::vector<bool>> membership; // membership[group][link]
+
+    auto canJoin = [&](std::size_t g, std::size_t link) {
+        for (auto member : groups[g]) {
+            if (member != link && !compatible(member, link)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto join = [&](std::size_t g, std::size_t link) {
+        if (!membership[g][link]) {
+            membership[g][link] = true;
+            groups[g].push_back(link);
+        }
+    };
+    auto newGroup = [&]() {
+        groups.emplace_back();
+        membership.emplace_back(nr_of_links, false);
+        return groups.size() - 1;
+    };
+
+    for (std::size_t i = 0; i < nr_of_links; i++) {
+        for (std::size_t j = i + 1; j < nr_of_links; j++) {
+            if (getContactClass(i, j) != ContactClass::Sometimes) {
+                continue;
+            }
+            bool covered = false;
+            for (std::size_t g = 0; g < groups.size() && !covered; g++) {
+                covered = membership[g][i] && membership[g][j];
+            }
+            for (std::size_t g = 0; g < groups.size() && !covered; g++) {
+                if (canJoin(g, i) && canJoin(g, j)) {
+                    join(g, i);
+                    join(g, j);
+                    covered = true;
+                }
+            }
+            if (!covered) {
+                auto g = newGroup();
+                join(g, i);
+                join(g, j);
+            }
+        }
+    }
+
+    // Links that never need to touch other links still need a bit to collide with the environment
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        if (!m_has_geometry[l]) {
+            continue;
+        }
+        bool assigned = false;
+        for (std::size_t g = 0; g < groups.size() && !assigned; g++) {
+            assigned = membership[g][l];
+        }
+        for (std::size_t g = 0; g < groups.size() && !assigned; g++) {
+            if (canJoin(g, l)) {
+                join(g, l);
+                assigned = true;
+            }
+        }
+        if (!assigned) {
+            join(newGroup(), l);
+        }
+    }
+
+    if (groups.size() > max_bits) {
+        return false;
+    }
+
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        if (!m_has_geometry[l]) {
+            continue;
+        }
+        unsigned int bitmask = 0;
+        for (std::size_t g = 0; g < groups.size(); g++) {
+            if (membership[g][l]) {
+                bitmask |= 1u << g;
+            }
+        }
+        char bitmask_str[16];
+        std::snprintf(bitmask_str, sizeof(bitmask_str), "0x%04x", bitmask);
+
+        xmlKeepBlanksDefault(0);
+        xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+        xmlNodePtr root_node = xmlNewNode(NULL, BAD_CAST "gazebo");
+        xmlDocSetRootElement(doc, root_node);
+        xmlNewProp(root_node, BAD_CAST "reference", BAD_CAST m_link_names[l].c_str());
+
+        xmlNodePtr node = xmlNewChild(root_node, NULL, BAD_CAST "collision", NULL);
+        node = xmlNewChild(node, NULL, BAD_CAST "surface", NULL);
+        node = xmlNewChild(node, NULL, BAD_CAST "contact", NULL);
+        xmlNewChild(node, NULL, BAD_CAST "collide_bitmask", BAD_CAST bitmask_str);
+
+        xmlOutputBufferPtr doc_buffer = xmlAllocOutputBuffer(NULL);
+        xmlNodeDumpOutput(doc_buffer, doc, root_node, 0, 1, NULL);
+        xml_blobs.push_back(std::string((char*)xmlBufContent(doc_buffer->buffer)));
+
+        xmlOutputBufferClose(doc_buffer);
+        xmlFreeDoc(doc);
+    }
+
+    return true;
+}
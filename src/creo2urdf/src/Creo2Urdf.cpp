@@ -9,7 +9,13 @@
 
 #include <creo2urdf/Creo2Urdf.h>
 #include <creo2urdf/Utils.h>
+#include <creo2urdf/Mesh.h>
+#include <creo2urdf/CollisionMatrix.h>
+#include <creo2urdf/CollisionData.h>
+#include <creo2urdf/PrincipalInertia.h>
+#include <creo2urdf/Parallel.h>
 #include <pfcExceptions.h>
+#include <pfcSimpRep.h>
 
 #include <iDynTree/PrismaticJoint.h>
 #include <iDynTree/EigenHelpers.h>
@@ -17,125 +23,207 @@
 
 #include <Eigen/Core>
 
-bool Creo2Urdf::processAsmItems(pfcModelItems_ptr asmListItems, pfcModel_ptr model_owner, iDynTree::Transform parentAsm_H_csysAsm) {
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+bool Creo2Urdf::processAssembly(pfcModelItems_ptr asmListItems, pfcModel_ptr root_asm, FrameGraph::FrameIndex root_frame) {
+
+    // The assembly is traversed depth first with an explicit stack of levels, so that the call stack does not
+    // grow with the nesting of the subassemblies and a failure can be reported with the whole path
+    std::vector<TraversalLevel> stack(1);
+    stack.back().owner = root_asm;
+    stack.back().owner_name = string(root_asm->GetFullName());
+    stack.back().owner_frame = root_frame;
+    // A worker of a sharded export visits only the top-level components of its shard
+    if (!listComponents(asmListItems, stack.back(), shard)) {
+        return false;
+    }
 
-    for (int i = 0; i < asmListItems->getarraysize(); i++)
+    while (!stack.empty())
     {
-        bool ret{ false };
-        auto asmItemAsFeat = pfcFeature::cast(asmListItems->get(i));
-        if (asmItemAsFeat->GetFeatType() != pfcFeatureType::pfcFEATTYPE_COMPONENT)
-        {
+        auto& level = stack.back();
+        if (level.next == level.components.size()) {
+            stack.pop_back();
             continue;
         }
-
-        auto component_handle = m_session_ptr->RetrieveModel(pfcComponentFeat::cast(asmItemAsFeat)->GetModelDescr());
-
-        if (component_handle == nullptr) {
+        const auto& feat = level.components[level.next].first;
+        auto& component = *level.components[level.next].second;
+        level.next++;
+
+        TraversalLevel sub_level;
+        if (!processComponent(level, feat, component, sub_level)) {
+            std::string path;
+            for (const auto& owner : stack) {
+                path += owner.owner_name + " > ";
+            }
+            printToMessageWindow("Failed to process the component " + path + component.full_name, c2uLogLevel::WARN);
             return false;
         }
 
-        if(pfcSolid::cast(component_handle)->GetIsSkeleton())
-        {   
-            printToMessageWindow(std::string(component_handle->GetFullName()) + " is a skeleton, skipping", c2uLogLevel::INFO);
-            continue;
+        if (sub_level.owner) {
+            if (!listComponents(sub_level.owner->ListItems(pfcModelItemType::pfcITEM_FEATURE), sub_level)) {
+                return false;
+            }
+            stack.push_back(std::move(sub_level));
         }
+    }
+    return true;
+}
 
-        //printToMessageWindow("Processing " + string(component_handle->GetFullName()) + " Owner " + string(model_owner->GetFullName()));
+bool Creo2Urdf::listComponents(pfcModelItems_ptr asmListItems, TraversalLevel& level, const ShardSpec& level_shard) {
 
-        xintsequence_ptr seq = xintsequence::create();
-        seq->append(asmItemAsFeat->GetId());
+    // The models of all the components of the level are retrieved in one batch, before the per-part work
+    std::size_t position = 0;
+    for (int i = 0; i < asmListItems->getarraysize(); i++)
+    {
+        auto asmItemAsFeat = pfcFeature::cast(asmListItems->get(i));
+        if (asmItemAsFeat->GetFeatType() != pfcFeatureType::pfcFEATTYPE_COMPONENT || !level_shard.owns(position++))
+        {
+            continue;
+        }
 
-        ElementTreeManager element_tree_manager;
-        element_tree_manager.populateJointInfoFromElementTree(asmItemAsFeat, joint_info_map);
+        // Each unique model is retrieved once, the following instances are read from the registry
+        ModelRecord* component = model_registry.retrieve(m_session_ptr, pfcComponentFeat::cast(asmItemAsFeat)->GetModelDescr());
+        if (component == nullptr) {
+            printToMessageWindow("Unable to retrieve the model of the component " + to_string(asmItemAsFeat->GetId()) + " of " + level.owner_name, c2uLogLevel::WARN);
+            return false;
+        }
+        level.components.emplace_back(asmItemAsFeat, component);
+    }
+    return true;
+}
 
-        pfcComponentPath_ptr comp_path = pfcCreateComponentPath(pfcAssembly::cast(model_owner), seq);
+bool Creo2Urdf::processComponent(const TraversalLevel& level, pfcFeature_ptr feat, ModelRecord& component, TraversalLevel& sub_level) {
 
-        iDynTree::Transform csysAsm_H_linkFrame = iDynTree::Transform::Identity();
-        iDynTree::Transform csysPart_H_link_frame = iDynTree::Transform::Identity();
-        iDynTree::Transform parentAsm_H_linkFrame = iDynTree::Transform::Identity();
-        
-        std::string link_frame_name{ "" };
-        auto link_name = string(component_handle->GetFullName());
-        std::string urdf_link_name { "" };
+    bool ret{ false };
+    if (!component.handle && !model_registry.retrieve(m_session_ptr, pfcComponentFeat::cast(feat)->GetModelDescr())) {
+        // The model was released after an earlier instance was processed
+        printToMessageWindow("Unable to retrieve " + component.full_name + " again", c2uLogLevel::WARN);
+        return false;
+    }
+    auto component_handle = component.handle;
 
-        auto type = component_handle->GetType();
+    if (component.is_skeleton)
+    {   
+        printToMessageWindow(component.full_name + " is a skeleton, skipping", c2uLogLevel::INFO);
+        return true;
+    }
 
-        if (type == pfcMDL_ASSEMBLY) {
-            link_frame_name = "ASM_CSYS";
+    // The parts are exported as links, their frames, mass properties and mesh need the full geometry
+    if (!model_registry.loadGeometry(component)) {
+        printToMessageWindow("Unable to load the geometry of " + component.full_name, c2uLogLevel::WARN);
+        if (warningsAreFatal) {
+            return false;
         }
-        else {
-            link_frame_name = "";
-            urdf_link_name = getRenameElementFromConfig(link_name);
-            for (const auto& lf : config["linkFrames"]) {
-                if (lf["linkName"].Scalar() != urdf_link_name)
-                {
-                    continue;
-                }
-                link_frame_name = lf["frameName"].Scalar();
-            }
+    }
 
-            if (link_frame_name.empty()) {
-                std::tie(ret, link_frame_name) = getFirstCoordinateSystemName(component_handle);
-                
-                if (!ret) return false;
+    xintsequence_ptr seq = xintsequence::create();
+    seq->append(feat->GetId());
 
-                printToMessageWindow(link_name + " misses the frame in the linkFrames section, " + link_frame_name + " will be used instead", c2uLogLevel::WARN);
-            }
-        }
-        std::tie(ret, csysAsm_H_linkFrame) = getTransformFromOwnerToLinkFrame(comp_path, component_handle, link_frame_name, scale);
-
-        parentAsm_H_linkFrame = parentAsm_H_csysAsm * csysAsm_H_linkFrame;
+    ElementTreeManager element_tree_manager(&solid_reference_cache);
+    element_tree_manager.populateJointInfoFromElementTree(feat, joint_info_map, scale, &element_tree_cache);
 
-        if (type == pfcMDL_ASSEMBLY) {
-            auto sub_asm_component_list = component_handle->ListItems(pfcModelItemType::pfcITEM_FEATURE);
+    pfcComponentPath_ptr comp_path = pfcCreateComponentPath(pfcAssembly::cast(level.owner), seq);
 
-            bool ok = processAsmItems(sub_asm_component_list, component_handle, parentAsm_H_linkFrame);
-            if (!ok) {
-                return false;
-            }
-            else {
-                continue;
-            }
-        }
+    iDynTree::Transform csysAsm_H_linkFrame = iDynTree::Transform::Identity();
+    iDynTree::Transform csysPart_H_link_frame = iDynTree::Transform::Identity();
+    iDynTree::Transform rootAsm_H_linkFrame = iDynTree::Transform::Identity();
+    
+    std::string link_frame_name{ "" };
+    const auto& link_name = component.full_name;
+    std::string urdf_link_name { "" };
 
-        //printToMessageWindow(csysAsm_H_linkFrame.toString());
+    auto type = component.type;
 
-        if (!ret && warningsAreFatal)
-        {
-            return false;
-        }
+    if (type == pfcMDL_ASSEMBLY) {
+        link_frame_name = "ASM_CSYS";
+    }
+    else {
+        urdf_link_name = getRenameElementFromConfig(link_name);
+        link_frame_name = getLinkFrameNameFromConfig(config, urdf_link_name);
 
-        auto mass_prop = pfcSolid::cast(component_handle)->GetMassProperty();
+        if (link_frame_name.empty()) {
+            std::tie(ret, link_frame_name) = getFirstCoordinateSystemName(component_handle);
+            
+            if (!ret) return false;
 
-        std::tie(ret, csysPart_H_link_frame) = getTransformFromPart(component_handle, link_frame_name, scale);
-        if (!ret && warningsAreFatal)
-        {
-            return false;
+            printToMessageWindow(link_name + " misses the frame in the linkFrames section, " + link_frame_name + " will be used instead", c2uLogLevel::WARN);
         }
+    }
+    std::vector<std::string> csys_names;
+    FrameGraph::FrameIndex component_frame, link_frame;
+    std::tie(component_frame, link_frame) = addComponentFrames(comp_path, component, level.owner_frame, link_frame_name, csys_names);
+
+    ret = link_frame != FrameGraph::INVALID_FRAME_INDEX;
+    if (ret) {
+        csysAsm_H_linkFrame = frame_graph.getTransform(level.owner_frame, link_frame);
+        rootAsm_H_linkFrame = frame_graph.getTransformFromRoot(link_frame);
+        csysPart_H_link_frame = frame_graph.getTransform(component_frame, link_frame);
+    }
+    else {
+        printToMessageWindow("Unable to get the transform " + link_frame_name + " in " + link_name, c2uLogLevel::WARN);
+    }
 
-        iDynTree::Link link;
-        link.setInertia(computeSpatialInertiafromCreo(mass_prop, csysPart_H_link_frame, urdf_link_name));
+    // The components of a subassembly are processed by the traversal before the following siblings
+    if (type == pfcMDL_ASSEMBLY) {
+        sub_level.owner = component_handle;
+        sub_level.owner_name = component.full_name;
+        sub_level.owner_frame = ret ? link_frame : component_frame;
+        return true;
+    }
 
-        if (!link.getInertia().isPhysicallyConsistent())
-        {
-            printToMessageWindow(link_name + " is NOT physically consistent!", c2uLogLevel::WARN);
-            if (warningsAreFatal) {
-                return false;
-            }
+    if (!ret && warningsAreFatal)
+    {
+        return false;
+    }
+
+    // The inertia is computed with the ones of the other links once the traversal is over, see computeLinkInertias.
+    // When coordinating a sharded export, the mass properties are read by the workers and merged once they are done
+    iDynTree::Link link;
+    pfcMassProperty_ptr mass_prop = nullptr;
+    LinkInfo l_info{ urdf_link_name, component_handle, rootAsm_H_linkFrame, csysAsm_H_linkFrame, link_frame_name };
+    if (coordinating) {
+        sharded_links.push_back({ link_name, urdf_link_name, csysPart_H_link_frame });
+    }
+    else {
+        mass_prop = model_registry.getMassProperty(component);
+        auto mass_properties = readMassProperties(link_name, mass_prop);
+        addLinkToTable(mass_properties, csysPart_H_link_frame, urdf_link_name);
+        l_info.creo_mass = mass_properties.mass;
+        l_info.creo_volume = mass_properties.volume;
+        if (shard.isWorker()) {
+            extracted_shard.links.push_back(mass_properties);
         }
+    }
+    l_info.csys_names = csys_names;
+    if (streaming) {
+        // The joints are built once the traversal is over, when the model is no longer available
+        l_info.axes = getAxesFromPart(component_handle, link_frame_name, scale);
+        l_info.modelhdl = nullptr;
+    }
+    link_info_map.insert(std::make_pair(link_name, l_info));
+    populateExportedFrameInfoMap(link_name, csys_names);
 
-        LinkInfo l_info{ urdf_link_name, component_handle, parentAsm_H_linkFrame, csysAsm_H_linkFrame, link_frame_name };
-        link_info_map.insert(std::make_pair(link_name, l_info));
-        populateExportedFrameInfoMap(component_handle);
+    if (mass_prop && config["mirrorDetection"]["enabled"].IsDefined() && config["mirrorDetection"]["enabled"].as<bool>()) {
+        mirror_signatures_map[link_name] = computeMirrorSignature(component_handle, mass_prop, csysPart_H_link_frame);
+    }
 
-        idyn_model.addLink(urdf_link_name, link);
-        if (!addMeshAndExport(component_handle, link_frame_name)) {
-            printToMessageWindow("Failed to export mesh for " + link_name, c2uLogLevel::WARN);
-            if (warningsAreFatal) {
-                return false;
-            }
+    idyn_model.addLink(urdf_link_name, link);
+    if (!addMeshAndExport(component, link_frame_name)) {
+        printToMessageWindow("Failed to export mesh for " + link_name, c2uLogLevel::WARN);
+        if (warningsAreFatal) {
+            return false;
         }
     }
+
+    // The datums, mass properties and mesh of the part are extracted, so the model is no longer needed
+    if (streaming) {
+        model_registry.release(component);
+    }
     return true;
 }
 
@@ -148,13 +236,21 @@ void Creo2Urdf::OnCommand() {
         exported_frame_info_map.clear();
         assigned_inertias_map.clear();
         assigned_collision_geometry_map.clear();
+        mirror_signatures_map.clear();
+        names->clear();
     }
+    link_table.clear();
+    frame_graph.clear();
+    sharded_links.clear();
+    extracted_shard = Shard();
+    extracted_shard.spec = shard;
+    shard_count = 0;
     m_session_ptr = pfcGetProESession();
     if (!m_session_ptr) {
         printToMessageWindow("Failed to get the session", c2uLogLevel::WARN);
         return;
     }
-    if (!m_root_asm_model_ptr) {
+    if (!m_root_asm_model_ptr && m_asm_path.empty()) {
         m_root_asm_model_ptr = m_session_ptr->GetCurrentModel();
         if (!m_root_asm_model_ptr) {
             printToMessageWindow("Failed to get the current model", c2uLogLevel::WARN);
@@ -181,13 +277,24 @@ void Creo2Urdf::OnCommand() {
         printToMessageWindow("Failed to run Creo2Urdf!", c2uLogLevel::WARN);
         return;
     }
+    // In batch mode the assembly is retrieved once the configuration is known, possibly in a simplified representation
+    if (!m_root_asm_model_ptr && !retrieveRootAssembly())
+    {
+        printToMessageWindow("Failed to run Creo2Urdf! Unable to retrieve " + m_asm_path, c2uLogLevel::WARN);
+        return;
+    }
+    bool simplified_rep_enabled = config["simplifiedRep"]["enabled"].IsDefined() && config["simplifiedRep"]["enabled"].as<bool>();
+    if (simplified_rep_enabled && m_asm_path.empty()) {
+        printToMessageWindow("The assembly is already in session, its current representation is used and the geometry of the parts is loaded on demand", c2uLogLevel::INFO);
+    }
     // CSV file path
     if (m_csv_path.empty()) {
         auto csv_file_open_option = pfcFileOpenOptions::Create("*.csv");
         csv_file_open_option->SetDialogLabel("Select the csv");
         m_csv_path = string(m_session_ptr->UIOpenFile(csv_file_open_option));
     }
-    rapidcsv::Document joints_csv_table(m_csv_path, rapidcsv::LabelParams(0, 0));
+    std::vector<std::string> csv_errors;
+    joint_table.load(m_csv_path, csv_errors);
     // Output folder path
     if (m_output_path.empty()) {
         auto output_folder_open_option = pfcDirectorySelectionOptions::Create();
@@ -212,6 +319,15 @@ void Creo2Urdf::OnCommand() {
         warningsAreFatal = config["warningsAreFatal"].as<bool>();
     }
 
+    // The csv is validated before the traversal, its rows with errors are ignored
+    for (const auto& error : csv_errors) {
+        printToMessageWindow(error, c2uLogLevel::WARN);
+    }
+    if (!csv_errors.empty() && warningsAreFatal) {
+        printToMessageWindow("Failed to run Creo2Urdf! The csv " + m_csv_path + " has errors", c2uLogLevel::WARN);
+        return;
+    }
+
     if(config["scale"].IsDefined()) {
         scale = config["scale"].as<std::array<double,3>>();
     }
@@ -228,6 +344,11 @@ void Creo2Urdf::OnCommand() {
         exportAllUseradded = config["exportAllUseradded"].as<bool>();
     }
 
+    streaming = config["streaming"]["enabled"].IsDefined() && config["streaming"]["enabled"].as<bool>();
+
+    // A worker shares the configuration of its coordinator, but never launches other workers
+    coordinating = !shard.isWorker() && config["sharding"]["enabled"].IsDefined() && config["sharding"]["enabled"].as<bool>();
+
     readExportedFramesFromConfig();
     readAssignedInertiasFromConfig();
     readAssignedCollisionGeometryFromConfig();
@@ -236,43 +357,158 @@ void Creo2Urdf::OnCommand() {
 
     sensorizer.readFTSensorsFromConfig(config);
     sensorizer.readSensorsFromConfig(config);
+    sensorizer.readSensorGeneratorsFromConfig(config);
+
+    // The joint data read from the element trees is cached during the run, and saved for the next runs if enabled
+    element_tree_cache.clear();
+    // The solid references are kept across the runs, since they are keyed by owner revision, unless the owner is modified
+    solid_reference_cache.startRun();
+    model_registry.clear();
+    model_registry.setGeometryOnDemand(simplified_rep_enabled);
+    // In batch mode no window shows the parts, so their geometry can be unloaded once released
+    model_registry.setUnloadOnRelease(!m_asm_path.empty());
+    bool element_tree_cache_enabled = false;
+    const std::string element_tree_cache_file = m_output_path + "\\" + "element_tree_cache.yaml";
+    if (config["elementTreeCache"]["enabled"].IsDefined()) {
+        element_tree_cache_enabled = config["elementTreeCache"]["enabled"].as<bool>();
+    }
+    if (element_tree_cache_enabled && element_tree_cache.load(element_tree_cache_file)) {
+        printToMessageWindow("Loaded " + to_string(element_tree_cache.size()) + " features from element_tree_cache.yaml");
+    }
 
     // Let's traverse the model tree and get all links and axis properties
-    bool ok = processAsmItems(asm_component_list, m_root_asm_model_ptr);
+    auto root_frame = frame_graph.addFrame("", FrameGraph::INVALID_FRAME_INDEX, iDynTree::Transform::Identity());
+    std::thread shard_workers;
+    std::vector<int> shard_exit_codes;
+    // The thread writes the exit codes, so it is joined before they go out of scope, also if a Creo call throws
+    struct ShardWorkersJoiner {
+        std::thread& workers;
+        ~ShardWorkersJoiner() {
+            if (workers.joinable()) {
+                workers.join();
+            }
+        }
+    } shard_workers_joiner{ shard_workers };
+    if (coordinating && !launchShardWorkers(asm_component_list, shard_workers, shard_exit_codes)) {
+        printToMessageWindow("Failed to run Creo2Urdf! Unable to launch the workers", c2uLogLevel::WARN);
+        return;
+    }
+    bool ok = processAssembly(asm_component_list, m_root_asm_model_ptr, root_frame);
+    if (shard_workers.joinable()) {
+        printToMessageWindow("Waiting for the workers to export their shards");
+        shard_workers.join();
+    }
     if (!ok) {
         printToMessageWindow("Failed to process the assembly", c2uLogLevel::WARN);
         return;
     }
 
+    const auto& element_tree_statistics = element_tree_cache.getStatistics();
+    printToMessageWindow("Element trees: " + to_string(element_tree_statistics.extracted_trees) + " extracted, " +
+                         to_string(element_tree_statistics.cache_hits) + " found in the cache, " +
+                         to_string(element_tree_statistics.skipped_features) + " features without constraints skipped");
+    printToMessageWindow(solid_reference_cache.getStatisticsSummary());
+    printToMessageWindow(model_registry.getStatisticsSummary());
+
+    // A worker only writes the mass properties of its shard, its meshes are already in the output folder
+    if (shard.isWorker()) {
+        const std::string shard_file = m_output_path + "\\" + Shard::getFileName(shard.index);
+        if (!extracted_shard.save(shard_file)) {
+            printToMessageWindow("Failed to write " + shard_file, c2uLogLevel::WARN);
+            return;
+        }
+        printToMessageWindow("Shard " + shard.toString() + ": " + to_string(extracted_shard.links.size()) + " links written to " + Shard::getFileName(shard.index));
+        return;
+    }
+    if (coordinating && !mergeShards(shard_exit_codes)) {
+        printToMessageWindow("Failed to run Creo2Urdf! The shards of the workers could not be merged", c2uLogLevel::WARN);
+        return;
+    }
+
+    if (element_tree_cache_enabled && !element_tree_cache.save(element_tree_cache_file)) {
+        printToMessageWindow("Failed to write " + element_tree_cache_file, c2uLogLevel::WARN);
+    }
+
+    if (!computeLinkInertias()) {
+        printToMessageWindow("Failed to run Creo2Urdf! Some links are not physically consistent", c2uLogLevel::WARN);
+        return;
+    }
+
+    if (config["meshInertiaCheck"]["enabled"].IsDefined() && config["meshInertiaCheck"]["enabled"].as<bool>()) {
+        if (!checkMeshInertias() && warningsAreFatal) {
+            printToMessageWindow("Failed to run Creo2Urdf! The inertias do not match the meshes", c2uLogLevel::WARN);
+            return;
+        }
+    }
+
+    // The rows of the csv are matched with the moving joints before the joints are added
+    std::vector<std::string> moving_joint_names;
+    for (auto joint_info_it : joint_info_map.sortedByName()) {
+        const auto& joint_info = *joint_info_it;
+        if (joint_info.second.type == JointType::Revolute || joint_info.second.type == JointType::Linear) {
+            moving_joint_names.push_back(rename_table.getRenamed(joint_info.first));
+        }
+    }
+    std::vector<std::string> missing_csv_joints, extra_csv_joints;
+    joint_table.checkJoints(moving_joint_names, missing_csv_joints, extra_csv_joints);
+    for (const auto& joint_name : missing_csv_joints) {
+        printToMessageWindow("Joint " + joint_name + " is not in the csv, only the limits set in Creo are used", c2uLogLevel::WARN);
+    }
+    for (const auto& joint_name : extra_csv_joints) {
+        printToMessageWindow("The csv row " + joint_name + " does not match any joint of the assembly", c2uLogLevel::WARN);
+    }
+    reportJointLimits();
+
     // Now we have to add joints to the iDynTree model
 
-    for (auto & joint_info : joint_info_map) {
-        auto parent_link_name = joint_info.second.parent_link_name;
-        auto child_link_name = joint_info.second.child_link_name;
+    // The joints are added in name order, which is the order of their DOFs in the urdf
+    for (auto joint_info_it : joint_info_map.sortedByName()) {
+        auto& joint_info = *joint_info_it;
+        const auto& parent_link_name = names->getName(joint_info.second.parent_link_id);
+        const auto& child_link_name = names->getName(joint_info.second.child_link_id);
         auto axis_name = joint_info.second.datum_name;
         auto joint_name = getRenameElementFromConfig(joint_info.first);
 
         // This handles the case of a "cut" assembly, where we have an axis but we miss the child link.
-        if (child_link_name.empty() || link_info_map.find(parent_link_name) == link_info_map.end() || link_info_map.find(child_link_name) == link_info_map.end()) {
+        auto parent_link_info = link_info_map.find(joint_info.second.parent_link_id);
+        auto child_link_info = link_info_map.find(joint_info.second.child_link_id);
+        if (child_link_name.empty() || parent_link_info == link_info_map.end() || child_link_info == link_info_map.end()) {
             printToMessageWindow("Skipping joint " + joint_name + " child link name " + child_link_name + " parent link name " + parent_link_name , c2uLogLevel::WARN);
             continue;
         }
 
-        auto asm_owner_H_parent_link = link_info_map.at(parent_link_name).rootAsm_H_linkFrame;
-        auto asm_owner_H_child_link = link_info_map.at(child_link_name).rootAsm_H_linkFrame;
-        auto parent_model = link_info_map.at(parent_link_name).modelhdl;
-        auto parent_link_frame = link_info_map.at(parent_link_name).link_frame_name;
+        auto parent_model = parent_link_info->second.modelhdl;
+        auto parent_link_frame = parent_link_info->second.link_frame_name;
+        auto child_link_frame = child_link_info->second.link_frame_name;
 
-        //printToMessageWindow("Parent link H " + asm_owner_H_parent_link.toString());
-        //printToMessageWindow("Child  link H " + asm_owner_H_child_link.toString());
+        // The transform is composed through the closest common subassembly of the two links
         iDynTree::Transform parentLink_H_childLink = iDynTree::Transform::Identity();
-        parentLink_H_childLink = asm_owner_H_parent_link.inverse() * asm_owner_H_child_link;
+        std::tie(ret, parentLink_H_childLink) = frame_graph.getTransform(FrameGraph::getDatumFrameName(parent_link_name, parent_link_frame),
+                                                                         FrameGraph::getDatumFrameName(child_link_name, child_link_frame));
+        if (!ret) {
+            printToMessageWindow("Unable to get the transform between " + parent_link_name + " and " + child_link_name, c2uLogLevel::WARN);
+            if (warningsAreFatal) {
+                return;
+            }
+        }
 
         if (joint_info.second.type == JointType::Revolute || joint_info.second.type == JointType::Linear) {
 
             iDynTree::Direction direction;
             iDynTree::Position axis_mid_point_pos_in_parent;
-            std::tie(ret, direction, axis_mid_point_pos_in_parent) = getAxisFromPart(parent_model, axis_name, parent_link_frame, scale);
+            if (parent_model) {
+                std::tie(ret, direction, axis_mid_point_pos_in_parent) = getAxisFromPart(parent_model, axis_name, parent_link_frame, scale);
+            }
+            else {
+                // In streaming mode the model was released, its axes were read during the traversal
+                const auto& axes = parent_link_info->second.axes;
+                auto axis = std::find_if(axes.begin(), axes.end(), [&axis_name](const AxisInfo& a) { return a.name == axis_name; });
+                ret = axis != axes.end();
+                if (ret) {
+                    direction = axis->direction;
+                    axis_mid_point_pos_in_parent = axis->mid_point;
+                }
+            }
 
             if (!ret)
             {
@@ -317,8 +553,13 @@ void Creo2Urdf::OnCommand() {
                 conversion_factor = deg2rad;
             }
 
-            // Read limits from CSV data, until it is possible to do so from Creo directly
-            setJointParametersFromCsv(joints_csv_table, joint_name, *joint_sh_ptr, conversion_factor);
+            // The limits set in Creo are used, unless the csv overrides them
+            const auto& cad_limits = joint_info.second.limits;
+            if (cad_limits.available) {
+                joint_sh_ptr->enablePosLimits(true);
+                joint_sh_ptr->setPosLimits(0, cad_limits.min * conversion_factor, cad_limits.max * conversion_factor);
+            }
+            setJointParametersFromCsv(joint_name, *joint_sh_ptr, conversion_factor);
 
             if (idyn_model.addJoint(getRenameElementFromConfig(parent_link_name),
                 getRenameElementFromConfig(child_link_name), joint_name, joint_sh_ptr.get()) == iDynTree::JOINT_INVALID_INDEX) {
@@ -341,9 +582,11 @@ void Creo2Urdf::OnCommand() {
     }
 
     // Assign the transforms for the sensors
-    sensorizer.assignTransformToSensors(exported_frame_info_map, link_info_map, scale);
+    sensorizer.assignTransformToSensors(exported_frame_info_map, link_info_map, rename_table, frame_graph);
+    // Expand the sensor generators against the coordinate systems of their links
+    sensorizer.expandSensorGenerators(link_info_map, rename_table, frame_graph);
     // Assign the transforms for the ft sensors
-    sensorizer.assignTransformToFTSensor(exported_frame_info_map, link_info_map, joint_info_map, scale);
+    sensorizer.assignTransformToFTSensor(exported_frame_info_map, link_info_map, joint_info_map, frame_graph);
 
     // Let's add sensors and ft sensors frames
 
@@ -357,7 +600,8 @@ void Creo2Urdf::OnCommand() {
         }
     }
 
-    for (auto& ftsensor : sensorizer.ft_sensors) {
+    for (auto ftsensor_it : sensorizer.ft_sensors.sortedByName()) {
+        auto& ftsensor = *ftsensor_it;
         if (ftsensor.second.exportFrameInURDF) {
             auto joint_idx = idyn_model.getJointIndex(ftsensor.first);
             if (joint_idx == iDynTree::LINK_INVALID_INDEX) {
@@ -378,7 +622,8 @@ void Creo2Urdf::OnCommand() {
     }
 
     // Let's add all the exported frames
-    for (auto & exported_frame_info : exported_frame_info_map) {
+    for (auto exported_frame_info_it : exported_frame_info_map.sortedByName()) {
+        auto& exported_frame_info = *exported_frame_info_it;
         std::string reference_link = exported_frame_info.second.frameReferenceLink;
         if (idyn_model.getLinkIndex(reference_link) == iDynTree::LINK_INVALID_INDEX) {
             // TODO FATAL?!
@@ -423,41 +668,226 @@ void Creo2Urdf::OnCommand() {
     export_options.xmlBlobs.insert(export_options.xmlBlobs.end(), ft_xml_blobs.begin(), ft_xml_blobs.end());
     export_options.xmlBlobs.insert(export_options.xmlBlobs.end(), sens_xml_blobs.begin(), sens_xml_blobs.end());
 
-    exportModelToUrdf(idyn_model, export_options);
+    if (config["collisionMatrix"]["enabled"].IsDefined() && config["collisionMatrix"]["enabled"].as<bool>()) {
+        std::vector<std::string> collision_filter_blobs;
+        if (buildCollisionMatrix(collision_filter_blobs)) {
+            export_options.xmlBlobs.insert(export_options.xmlBlobs.end(), collision_filter_blobs.begin(), collision_filter_blobs.end());
+        }
+        else if (warningsAreFatal) {
+            printToMessageWindow("Failed to run Creo2Urdf! The collision matrix could not be computed", c2uLogLevel::WARN);
+            return;
+        }
+    }
+
+    if (exportModelToUrdf(idyn_model, export_options)) {
+        bool check_round_trip = true;
+        if (config["roundTripCheck"]["enabled"].IsDefined()) {
+            check_round_trip = config["roundTripCheck"]["enabled"].as<bool>();
+        }
+        if (check_round_trip) {
+            checkExportedUrdf(idyn_model, export_options.baseLink, sensorizer);
+        }
+        if (config["collisionData"]["enabled"].IsDefined() && config["collisionData"]["enabled"].as<bool>()) {
+            buildCollisionData();
+        }
+    }
+
+    printToMessageWindow("Peak memory: " + to_string(getPeakMemoryUsage() / (1024 * 1024)) + " MB");
 
     // Let's clear the map in case of multiple click TODO UNIFY
     m_yaml_path.clear();
     m_csv_path.clear();
     m_output_path.clear();
     config = YAML::Node();
+    m_asm_path.clear();
     m_root_asm_model_ptr = nullptr;
 
     return;
 }
 
-bool Creo2Urdf::setJointParametersFromCsv(const rapidcsv::Document& csv, const std::string& joint_name, 
-    iDynTree::IJoint& joint, double conversion_factor = 1.0)
+bool Creo2Urdf::retrieveRootAssembly() {
+
+    const auto& simplified_rep = config["simplifiedRep"];
+    bool enabled = simplified_rep["enabled"].IsDefined() && simplified_rep["enabled"].as<bool>();
+
+    try {
+        auto descriptor = pfcModelDescriptor::CreateFromFileName(m_asm_path.c_str());
+        if (!enabled) {
+            m_root_asm_model_ptr = m_session_ptr->RetrieveModel(descriptor);
+            return m_root_asm_model_ptr != nullptr;
+        }
+
+        // The simplified representations are retrieved by name of the assembly, from the working directory or the search path
+        std::string type = simplified_rep["type"].IsDefined() ? simplified_rep["type"].as<std::string>() : "userDefined";
+        std::string name = simplified_rep["name"].IsDefined() ? simplified_rep["name"].as<std::string>() : "";
+        auto assembly_name = descriptor->GetInstanceName();
+        if (type == "graphics") {
+            m_root_asm_model_ptr = m_session_ptr->RetrieveGraphicsSimpRep(assembly_name);
+        }
+        else if (type == "geometry") {
+            m_root_asm_model_ptr = m_session_ptr->RetrieveGeomSimpRep(assembly_name);
+        }
+        else if (type == "userDefined" && !name.empty()) {
+            m_root_asm_model_ptr = m_session_ptr->RetrieveAssemSimpRep(assembly_name, pfcRetrieveExistingSimpRepInstructions::Create(name.c_str()));
+        }
+        else {
+            printToMessageWindow("simplifiedRep: the type " + type + " is not supported, or the name of the representation is missing", c2uLogLevel::WARN);
+            return false;
+        }
+        printToMessageWindow("Retrieved " + string(assembly_name) + " in the " + (name.empty() ? type : name) + " simplified representation");
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        printToMessageWindow("Exception caught: " + string(pfcXPFC::cast(defaultEx)->GetMessage()), c2uLogLevel::WARN);
+        return false;
+    }
+    xcatchend
+
+    return m_root_asm_model_ptr != nullptr;
+}
+
+bool Creo2Urdf::launchShardWorkers(pfcModelItems_ptr asm_component_list, std::thread& workers, std::vector<int>& exit_codes) {
+
+    const auto& sharding = config["sharding"];
+    std::size_t nr_components = 0;
+    for (int i = 0; i < asm_component_list->getarraysize(); i++) {
+        if (pfcFeature::cast(asm_component_list->get(i))->GetFeatType() == pfcFeatureType::pfcFEATTYPE_COMPONENT) {
+            nr_components++;
+        }
+    }
+    if (nr_components == 0) {
+        printToMessageWindow("There are no components to be sharded", c2uLogLevel::WARN);
+        return false;
+    }
+    shard_count = getNumberOfWorkers(nr_components, sharding["workers"].IsDefined() ? sharding["workers"].as<std::size_t>() : 0);
+    const std::string command = sharding["command"].IsDefined() ? sharding["command"].as<std::string>() : default_worker_command;
+
+    // The workers retrieve the assembly from its file, also when it was opened in the GUI
+    std::string asm_path = m_asm_path;
+    if (asm_path.empty()) {
+        try {
+            asm_path = string(m_root_asm_model_ptr->GetOrigin());
+        }
+        xcatchbegin
+        xcatchcip(defaultEx)
+        {
+            printToMessageWindow("Unable to get the file of the assembly: " + string(pfcXPFC::cast(defaultEx)->GetMessage()), c2uLogLevel::WARN);
+            return false;
+        }
+        xcatchend
+    }
+
+    std::vector<std::string> commands;
+    for (std::size_t i = 0; i < shard_count; i++) {
+        ShardSpec spec;
+        spec.index = i;
+        spec.count = shard_count;
+        // The shard of a previous run must not be merged if the worker fails
+        std::remove((m_output_path + "\\" + Shard::getFileName(i)).c_str());
+        commands.push_back(expandWorkerCommand(command, asm_path, m_yaml_path, m_csv_path, m_output_path, spec));
+    }
+
+    printToMessageWindow("Launching " + to_string(shard_count) + " workers for " + to_string(nr_components) + " top-level components");
+    workers = std::thread([commands, &exit_codes]() { exit_codes = runWorkerCommands(commands); });
+    return true;
+}
+
+bool Creo2Urdf::mergeShards(const std::vector<int>& exit_codes) {
+
+    std::vector<std::string> shard_files;
+    for (std::size_t i = 0; i < shard_count; i++) {
+        shard_files.push_back(m_output_path + "\\" + Shard::getFileName(i));
+    }
+    std::map<std::string, ShardLink> extracted_links;
+    std::vector<std::string> merge_warnings;
+    bool ok = mergeShardFiles(shard_files, exit_codes, extracted_links, merge_warnings);
+    for (const auto& warning : merge_warnings) {
+        printToMessageWindow(warning, c2uLogLevel::WARN);
+    }
+
+    std::size_t merged_links = 0;
+    for (const auto& sharded_link : sharded_links) {
+        auto mass_properties = extracted_links.find(sharded_link.link_name);
+        if (mass_properties == extracted_links.end()) {
+            printToMessageWindow(sharded_link.link_name + " is missing from the shards of the workers", c2uLogLevel::WARN);
+            ok = false;
+            continue;
+        }
+        addLinkToTable(mass_properties->second, sharded_link.csysPart_H_link_frame, sharded_link.urdf_link_name);
+        auto link_info = link_info_map.find(sharded_link.link_name);
+        if (link_info != link_info_map.end()) {
+            link_info->second.creo_mass = mass_properties->second.mass;
+            link_info->second.creo_volume = mass_properties->second.volume;
+        }
+        merged_links++;
+    }
+    printToMessageWindow("Merged " + to_string(merged_links) + " of " + to_string(sharded_links.size()) + " links from " + to_string(shard_count) + " shards");
+
+    return ok || !warningsAreFatal;
+}
+
+bool Creo2Urdf::setJointParametersFromCsv(const std::string& joint_name, iDynTree::IJoint& joint, double conversion_factor = 1.0)
 {
-    if (csv.GetRowIdx(joint_name) < 0) return false;
+    const JointParameters* parameters = joint_table.find(joint_name);
+    if (!parameters) return false;
 
-    double min = csv.GetCell<double>("lower_limit", joint_name) * conversion_factor;
-    double max = csv.GetCell<double>("upper_limit", joint_name) * conversion_factor;
+    double min = parameters->lower_limit * conversion_factor;
+    double max = parameters->upper_limit * conversion_factor;
 
     if (!std::isinf(min) && !std::isinf(max))
     {
         joint.enablePosLimits(true);
         joint.setPosLimits(0, min, max);
     }
-    // TODO we have to retrieve the rest transform from creo
-    //joint.setRestTransform();
-
     joint.setJointDynamicsType(iDynTree::URDFJointDynamics);
-    joint.setDamping(0, csv.GetCell<double>("damping", joint_name));
-    joint.setStaticFriction(0, csv.GetCell<double>("friction", joint_name));
+    joint.setDamping(0, parameters->damping);
+    joint.setStaticFriction(0, parameters->friction);
 
     return true;
 }
 
+void Creo2Urdf::reportJointLimits() {
+    // The limits are compared in the units of the csv, degrees for revolute joints and scaled model units for linear ones
+    const double tolerance = 1e-6;
+    const auto format = [](double value) { return std::isinf(value) ? std::string() : to_string(value); };
+
+    std::vector<std::string> discrepancies;
+    std::ofstream report(m_output_path + "\\" + "joint_limits_report.csv");
+    report << "joint_name,cad_lower_limit,cad_upper_limit,csv_lower_limit,csv_upper_limit" << std::endl;
+    for (auto joint_info_it : joint_info_map.sortedByName()) {
+        const auto& joint_info = *joint_info_it;
+        if (joint_info.second.type != JointType::Revolute && joint_info.second.type != JointType::Linear) {
+            continue;
+        }
+        const auto& joint_name = rename_table.getRenamed(joint_info.first);
+        const auto& cad_limits = joint_info.second.limits;
+        const JointParameters* parameters = joint_table.find(joint_name);
+        const double cad_lower = cad_limits.available ? cad_limits.min : -std::numeric_limits<double>::infinity();
+        const double cad_upper = cad_limits.available ? cad_limits.max : std::numeric_limits<double>::infinity();
+        const double csv_lower = parameters ? parameters->lower_limit : -std::numeric_limits<double>::infinity();
+        const double csv_upper = parameters ? parameters->upper_limit : std::numeric_limits<double>::infinity();
+        report << joint_name << "," << format(cad_lower) << "," << format(cad_upper) << ","
+               << format(csv_lower) << "," << format(csv_upper) << std::endl;
+
+        if (cad_limits.available && !std::isinf(csv_lower) && !std::isinf(csv_upper) &&
+            (std::abs(cad_lower - csv_lower) > tolerance || std::abs(cad_upper - csv_upper) > tolerance)) {
+            discrepancies.push_back(joint_name + ": [" + to_string(cad_lower) + ", " + to_string(cad_upper) + "] in Creo, [" +
+                                    to_string(csv_lower) + ", " + to_string(csv_upper) + "] in the csv");
+        }
+    }
+    report.close();
+
+    const std::size_t max_printed_discrepancies = 10;
+    for (std::size_t i = 0; i < std::min(discrepancies.size(), max_printed_discrepancies); i++) {
+        printToMessageWindow("Joint limits overridden by the csv: " + discrepancies[i], c2uLogLevel::WARN);
+    }
+    if (!discrepancies.empty()) {
+        printToMessageWindow(to_string(discrepancies.size()) + " joint limits of the csv differ from the ones set in Creo. "
+                             "See joint_limits_report.csv for details", c2uLogLevel::WARN);
+    }
+}
+
 bool Creo2Urdf::exportModelToUrdf(iDynTree::Model mdl, iDynTree::ModelExporterOptions options) {
     iDynTree::ModelExporter mdl_exporter;
 
@@ -490,80 +920,584 @@ bool Creo2Urdf::exportModelToUrdf(iDynTree::Model mdl, iDynTree::ModelExporterOp
         return false;
     }
 
+    // The inertias are diagonalized in the exported file, the round-trip check verifies that the dynamics is unchanged
+    if (config["principalAxesInertia"].IsDefined() && config["principalAxesInertia"].as<bool>()) {
+        auto principal_inertias = computePrincipalInertias(modelToExportURDFCompatible);
+        if (!writePrincipalInertiasToUrdf(m_output_path + "\\" + "model.urdf", modelToExportURDFCompatible, principal_inertias)) {
+            printToMessageWindow("Failed to write the principal axes of the inertias in the urdf", c2uLogLevel::WARN);
+            return false;
+        }
+    }
+
+    // The joints of iDynTree have no velocity and effort limits, so they are written in the exported file if the csv has any
+    if (joint_table.hasVelocityOrEffortLimits() && !writeJointLimitsToUrdf(m_output_path + "\\" + "model.urdf", joint_table)) {
+        printToMessageWindow("Failed to write the velocity and effort limits in the urdf", c2uLogLevel::WARN);
+        if (warningsAreFatal) {
+            return false;
+        }
+    }
+
     printToMessageWindow("Urdf created successfully!");
     return true;
 }
 
-iDynTree::SpatialInertia Creo2Urdf::computeSpatialInertiafromCreo(pfcMassProperty_ptr mass_prop, iDynTree::Transform H, const std::string& link_name) {
+bool Creo2Urdf::checkExportedUrdf(const iDynTree::Model& mdl, const std::string& base_link, const Sensorizer& sensorizer) {
+    auto start = std::chrono::steady_clock::now();
+
+    ModelComparisonOptions options;
+    const auto& check_config = config["roundTripCheck"];
+    if (check_config["absoluteTolerance"].IsDefined()) {
+        options.absolute_tolerance = check_config["absoluteTolerance"].as<double>();
+    }
+    if (check_config["relativeTolerance"].IsDefined()) {
+        options.relative_tolerance = check_config["relativeTolerance"].as<double>();
+    }
+    if (check_config["angleTolerance"].IsDefined()) {
+        options.angle_tolerance = check_config["angleTolerance"].as<double>();
+    }
+    if (check_config["inertiaTolerance"].IsDefined()) {
+        options.inertia_tolerance = check_config["inertiaTolerance"].as<double>();
+    }
+
+    iDynTree::ModelLoader mdl_loader;
+    if (!mdl_loader.loadModelFromFile(m_output_path + "\\" + "model.urdf")) {
+        printToMessageWindow("Failed to reload the exported urdf. See iDynTreeErrors.txt for details", c2uLogLevel::WARN);
+        return false;
+    }
+
+    // Only the sensors that the iDynTree urdf parser understands can be checked
+    std::vector<SensorReference> expected_sensors;
+    for (const auto& sensor : sensorizer.sensors) {
+        if (sensor.type == SensorType::Accelerometer || sensor.type == SensorType::Gyroscope) {
+            expected_sensors.push_back({ sensor.sensorName, sensor.linkName, false, sensor.transform });
+        }
+    }
+    for (auto ft_it : sensorizer.ft_sensors.sortedByName()) {
+        const auto& ft = *ft_it;
+        expected_sensors.push_back({ ft.second.sensorName, ft.first, true, iDynTree::Transform::Identity() });
+    }
+
+    ModelComparator comparator(options);
+    bool ok = comparator.compare(mdl, mdl_loader.model(), base_link);
+    ok = comparator.compareSensors(expected_sensors, mdl_loader.model(), mdl, base_link) && ok;
+
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (ok) {
+        printToMessageWindow("Round-trip check passed in " + to_string(elapsed_ms) + " ms");
+        return true;
+    }
+
+    const auto& differences = comparator.getDifferences();
+    std::ofstream report(m_output_path + "\\" + "roundtrip_report.txt");
+    for (const auto& difference : differences) {
+        report << difference << std::endl;
+    }
+    report.close();
+
+    const std::size_t max_printed_differences = 10;
+    for (std::size_t i = 0; i < std::min(differences.size(), max_printed_differences); i++) {
+        printToMessageWindow("Round-trip check: " + differences[i], c2uLogLevel::WARN);
+    }
+    printToMessageWindow("The exported urdf does not reproduce the model, " + to_string(differences.size()) +
+                         " differences found in " + to_string(elapsed_ms) + " ms. See roundtrip_report.txt for details", c2uLogLevel::WARN);
+    return false;
+}
+
+bool Creo2Urdf::buildCollisionMatrix(std::vector<std::string>& xml_blobs) {
+    std::size_t nr_of_samples = 1000;
+    unsigned int seed = 0;
+    const auto& matrix_config = config["collisionMatrix"];
+    if (matrix_config["samples"].IsDefined()) {
+        nr_of_samples = matrix_config["samples"].as<std::size_t>();
+    }
+    if (matrix_config["seed"].IsDefined()) {
+        seed = matrix_config["seed"].as<unsigned int>();
+    }
+
+    std::map<std::string, std::string> mesh_file_names;
+    for (const auto& link_info : link_info_map) {
+        mesh_file_names[link_info.second.name] = link_info.second.mesh_file_name;
+    }
+
+    // Bounding boxes and hierarchies of the collision geometries, in the link frame
+    const std::size_t nr_of_links = idyn_model.getNrOfLinks();
+    std::vector<std::vector<OrientedBox>> link_boxes(nr_of_links);
+    std::vector<std::vector<Bvh>> link_meshes(nr_of_links);
+    std::vector<std::string> unreadable_meshes(nr_of_links);
+    const auto& link_shapes = idyn_model.collisionSolidShapes().getLinkSolidShapes();
+
+    parallelFor(nr_of_links, [&](std::size_t l) {
+        for (const auto shape : link_shapes[l]) {
+            const auto& link_H_geometry = shape->getLink_H_geometry();
+            const Eigen::Matrix3d R = iDynTree::toEigen(link_H_geometry.getRotation());
+            const Eigen::Vector3d p = iDynTree::toEigen(link_H_geometry.getPosition());
+            OrientedBox box;
+            if (shape->isBox()) {
+                auto idyn_box = shape->asBox();
+                box.half_extents = 0.5 * Eigen::Vector3d(idyn_box->getX(), idyn_box->getY(), idyn_box->getZ());
+            }
+            else if (shape->isCylinder()) {
+                auto idyn_cylinder = shape->asCylinder();
+                box.half_extents = Eigen::Vector3d(idyn_cylinder->getRadius(), idyn_cylinder->getRadius(), 0.5 * idyn_cylinder->getLength());
+            }
+            else if (shape->isSphere()) {
+                box.half_extents = Eigen::Vector3d::Constant(shape->asSphere()->getRadius());
+            }
+            else if (shape->isExternalMesh()) {
+                auto mesh_file_name = mesh_file_names.find(idyn_model.getLinkName(l));
+                TriangleMesh mesh;
+                if (mesh_file_name == mesh_file_names.end() || !readSTL(mesh_file_name->second, mesh, scale)) {
+                    unreadable_meshes[l] = idyn_model.getLinkName(l);
+                    continue;
+                }
+                box = computeOrientedBox(mesh);
+                mesh.v0 = (R * mesh.v0).colwise() + p;
+                mesh.v1 = (R * mesh.v1).colwise() + p;
+                mesh.v2 = (R * mesh.v2).colwise() + p;
+                link_meshes[l].push_back(buildBvh(mesh));
+            }
+            else {
+                continue;
+            }
+            link_boxes[l].push_back(box.transformed(R, p));
+        }
+    });
+
+    for (const auto& link_name : unreadable_meshes) {
+        if (!link_name.empty()) {
+            printToMessageWindow("The collision mesh of " + link_name + " is not an exported STL, it is ignored in the collision matrix", c2uLogLevel::WARN);
+        }
+    }
+
+    CollisionMatrix collision_matrix;
+    if (!collision_matrix.compute(idyn_model, link_boxes, link_meshes, CollisionMatrix::sampleJointConfigurations(idyn_model, nr_of_samples, seed))) {
+        printToMessageWindow("Failed to compute the collision matrix", c2uLogLevel::WARN);
+        return false;
+    }
+
+    if (!collision_matrix.writeSRDF(m_output_path + "\\" + "model.srdf", config["robotName"].Scalar())) {
+        printToMessageWindow("Failed to write model.srdf", c2uLogLevel::WARN);
+        return false;
+    }
+
+    if (!collision_matrix.buildGazeboCollisionFilterBlobs(xml_blobs)) {
+        printToMessageWindow("The collision matrix needs more than 16 bits of collide bitmask, the gazebo blobs are not added", c2uLogLevel::WARN);
+        xml_blobs.clear();
+    }
+
+    printToMessageWindow("Collision matrix computed on " + to_string(nr_of_samples) + " configurations, written in model.srdf");
+    return true;
+}
+
+bool Creo2Urdf::buildCollisionData() {
+    double voxel_size = 0.002;
+    double band_width = 3.0;
+    std::uint32_t max_resolution = 256;
+    const auto& data_config = config["collisionData"];
+    if (data_config["voxelSize"].IsDefined()) {
+        voxel_size = data_config["voxelSize"].as<double>();
+    }
+    if (data_config["bandWidth"].IsDefined()) {
+        band_width = data_config["bandWidth"].as<double>();
+    }
+    if (data_config["maxResolution"].IsDefined()) {
+        max_resolution = data_config["maxResolution"].as<std::uint32_t>();
+    }
+
+    struct CollisionDataFiles {
+        std::string link_name;
+        std::string mesh_file_name;
+        std::string bvh_file_name;
+        std::string sdf_file_name;
+        std::size_t nr_of_triangles{ 0 };
+        std::size_t nr_of_nodes{ 0 };
+        std::size_t nr_of_bricks{ 0 };
+        double voxel_size{ 0.0 };
+        bool ok{ false };
+    };
+
+    // Only the links whose collision geometry is the exported mesh
+    std::vector<CollisionDataFiles> files;
+    const auto& link_shapes = idyn_model.collisionSolidShapes().getLinkSolidShapes();
+    for (auto link_info_it : link_info_map.sortedByName()) {
+        const auto& link_info = *link_info_it;
+        auto link_index = idyn_model.getLinkIndex(link_info.second.name);
+        if (link_info.second.mesh_file_name.empty() || link_index == iDynTree::LINK_INVALID_INDEX) {
+            continue;
+        }
+        const auto& shapes = link_shapes[link_index];
+        if (std::none_of(shapes.begin(), shapes.end(), [](const iDynTree::SolidShape* shape) { return shape->isExternalMesh(); })) {
+            continue;
+        }
+        CollisionDataFiles link_files;
+        link_files.link_name = link_info.second.name;
+        link_files.mesh_file_name = link_info.second.mesh_file_name;
+        auto stem = link_files.mesh_file_name.substr(link_files.mesh_file_name.find_last_of("\\/") + 1);
+        stem = stem.substr(0, stem.find_last_of('.'));
+        link_files.bvh_file_name = stem + ".bvh";
+        link_files.sdf_file_name = stem + ".sdfgrid";
+        files.push_back(link_files);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // The meshes are scaled to meters, so the data is in the link frame like the urdf
+    parallelFor(files.size(), [&](std::size_t i) {
+        TriangleMesh mesh;
+        if (!readSTL(files[i].mesh_file_name, mesh, scale)) {
+            return;
+        }
+        const Bvh bvh = buildBvh(mesh);
+        const SparseSdf sdf = computeSparseSdf(bvh, voxel_size, band_width, max_resolution);
+        files[i].nr_of_triangles = bvh.mesh.size();
+        files[i].nr_of_nodes = bvh.nodes.size();
+        files[i].nr_of_bricks = sdf.brick_indices.size();
+        files[i].voxel_size = sdf.voxel_size;
+        files[i].ok = writeBvhFile(m_output_path + "\\" + files[i].bvh_file_name, bvh) &&
+                      writeSdfFile(m_output_path + "\\" + files[i].sdf_file_name, sdf);
+    });
+
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    bool ok = true;
+    YAML::Emitter manifest;
+    manifest << YAML::BeginMap;
+    manifest << YAML::Key << "urdf" << YAML::Value << "model.urdf";
+    manifest << YAML::Key << "units" << YAML::Value << "m";
+    manifest << YAML::Key << "links" << YAML::Value << YAML::BeginSeq;
+    for (const auto& link_files : files) {
+        if (!link_files.ok) {
+            printToMessageWindow("Failed to build the collision data of " + link_files.link_name, c2uLogLevel::WARN);
+            ok = false;
+            continue;
+        }
+        manifest << YAML::BeginMap;
+        manifest << YAML::Key << "link" << YAML::Value << link_files.link_name;
+        manifest << YAML::Key << "mesh" << YAML::Value << link_files.mesh_file_name.substr(link_files.mesh_file_name.find_last_of("\\/") + 1);
+        manifest << YAML::Key << "bvh" << YAML::Value << link_files.bvh_file_name;
+        manifest << YAML::Key << "sdfgrid" << YAML::Value << link_files.sdf_file_name;
+        manifest << YAML::Key << "triangles" << YAML::Value << link_files.nr_of_triangles;
+        manifest << YAML::Key << "bvhNodes" << YAML::Value << link_files.nr_of_nodes;
+        manifest << YAML::Key << "voxelSize" << YAML::Value << link_files.voxel_size;
+        manifest << YAML::Key << "sdfgridBricks" << YAML::Value << link_files.nr_of_bricks;
+        manifest << YAML::EndMap;
+    }
+    manifest << YAML::EndSeq;
+    manifest << YAML::EndMap;
+
+    std::ofstream manifest_file(m_output_path + "\\" + "model_collision_data.yaml");
+    manifest_file << manifest.c_str() << std::endl;
+    if (!manifest_file) {
+        printToMessageWindow("Failed to write model_collision_data.yaml", c2uLogLevel::WARN);
+        return false;
+    }
+
+    printToMessageWindow("Collision data of " + to_string(files.size()) + " meshes built in " + to_string(elapsed_ms) +
+                         " ms, listed in model_collision_data.yaml");
+    return ok;
+}
+
+MirrorSignature Creo2Urdf::computeMirrorSignature(pfcModel_ptr component_handle, pfcMassProperty_ptr mass_prop, const iDynTree::Transform& csysPart_H_link_frame) {
+    MirrorSignature signature;
+    const Eigen::Vector3d s(scale[0], scale[1], scale[2]);
+    const Eigen::Matrix3d csysPart_R_link = iDynTree::toEigen(csysPart_H_link_frame.getRotation());
+    const Eigen::Vector3d csysPart_p_link = iDynTree::toEigen(csysPart_H_link_frame.getPosition());
+    auto toLinkFrame = [&](const Eigen::Vector3d& csysPart_p) -> Eigen::Vector3d {
+        return csysPart_R_link.transpose() * (csysPart_p - csysPart_p_link);
+    };
+
+    signature.volume = mass_prop->GetVolume() * s.prod();
     auto com = mass_prop->GetGravityCenter();
+    signature.com = toLinkFrame(Eigen::Vector3d(com->get(0), com->get(1), com->get(2)).cwiseProduct(s));
+
+    // The mass is divided out, so that parts with different materials are still recognized
     auto inertia_tensor = mass_prop->GetCenterGravityInertiaTensor();
+    Eigen::Matrix3d inertia;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            inertia(i, j) = inertia_tensor->get(i, j) * s(i) * s(j);
+        }
+    }
+    if (mass_prop->GetMass() > 0.0) {
+        signature.gyration = csysPart_R_link.transpose() * inertia * csysPart_R_link / mass_prop->GetMass();
+    }
 
-    iDynTree::RotationalInertiaRaw idyn_inertia_tensor_csysPart_orientation = iDynTree::RotationalInertiaRaw::Zero();
-    iDynTree::RotationalInertiaRaw idyn_inertia_tensor_link_orientation = iDynTree::RotationalInertiaRaw::Zero();
+    auto outline = pfcSolid::cast(component_handle)->GetGeomOutline();
+    const Eigen::Vector3d outline_min = Eigen::Vector3d(outline->get(0)->get(0), outline->get(0)->get(1), outline->get(0)->get(2)).cwiseProduct(s);
+    const Eigen::Vector3d outline_max = Eigen::Vector3d(outline->get(1)->get(0), outline->get(1)->get(1), outline->get(1)->get(2)).cwiseProduct(s);
+    signature.outline.center = toLinkFrame(0.5 * (outline_min + outline_max));
+    signature.outline.axes = csysPart_R_link.transpose();
+    signature.outline.half_extents = 0.5 * (outline_max - outline_min).cwiseAbs();
+
+    auto csys_list = component_handle->ListItems(pfcModelItemType::pfcITEM_COORD_SYS);
+    for (xint i = 0; i < csys_list->getarraysize(); i++) {
+        auto csysPart_H_csys = fromCreo(pfcCoordSystem::cast(csys_list->get(i))->GetCoordSys(), scale);
+        signature.datum_origins.push_back(toLinkFrame(iDynTree::toEigen(csysPart_H_csys.getPosition())));
+    }
+
+    return signature;
+}
+
+bool Creo2Urdf::exportMirroredMesh(const std::string& part_name, const std::string& mesh_file_name, bool binary) {
+    auto target = mirror_signatures_map.find(part_name);
+    if (target == mirror_signatures_map.end()) {
+        return false;
+    }
+
+    double tolerance = 1e-3;
+    double mesh_tolerance = 0.01;
+    if (config["mirrorDetection"]["tolerance"].IsDefined()) {
+        tolerance = config["mirrorDetection"]["tolerance"].as<double>();
+    }
+    if (config["mirrorDetection"]["meshTolerance"].IsDefined()) {
+        mesh_tolerance = config["mirrorDetection"]["meshTolerance"].as<double>();
+    }
+
+    for (const auto& source : mirror_signatures_map) {
+        auto source_info = link_info_map.find(source.first);
+        if (source.first == part_name || source_info == link_info_map.end() || source_info->second.mesh_file_name.empty()) {
+            continue;
+        }
+        auto transforms = findMirrorTransforms(source.second, target->second, tolerance);
+        if (transforms.empty()) {
+            continue;
+        }
 
-    bool assigned_inertia_flag = assigned_inertias_map.find(link_name) != assigned_inertias_map.end();
-    for (int i_row = 0; i_row < idyn_inertia_tensor_csysPart_orientation.rows(); i_row++) {
-        for (int j_col = 0; j_col < idyn_inertia_tensor_csysPart_orientation.cols(); j_col++) {
-            if ((assigned_inertia_flag) && (i_row == j_col)) {
-                // The assigned inertia is already expressed in the link frame
-                idyn_inertia_tensor_link_orientation.setVal(i_row, j_col, assigned_inertias_map.at(link_name)[i_row]);
+        TriangleMesh mesh;
+        if (!readSTL(source_info->second.mesh_file_name, mesh, scale)) {
+            continue;
+        }
+        // The vertices confirm which of the candidate reflections is the right one
+        for (const auto& transform : transforms) {
+            auto mirrored_mesh = mirrorMesh(mesh, transform);
+            if (!confirmMirroredMesh(mirrored_mesh, target->second, mesh_tolerance)) {
+                continue;
             }
-            else {
-                idyn_inertia_tensor_csysPart_orientation.setVal(i_row, j_col, inertia_tensor->get(i_row, j_col) * scale[i_row] * scale[j_col]);
+            if (!writeSTL(mesh_file_name, mirrored_mesh, binary, scale)) {
+                printToMessageWindow("Failed to write the mirrored mesh " + mesh_file_name, c2uLogLevel::WARN);
+                return false;
             }
+            printToMessageWindow(part_name + " is the mirror image of " + source.first + ", its mesh is mirrored instead of exported");
+            return true;
         }
     }
+    return false;
+}
 
-    iDynTree::Position com_child({ com->get(0) * scale[0] , com->get(1) * scale[1], com->get(2) * scale[2] });
+bool Creo2Urdf::checkMeshInertias() {
+    // Densities outside this range (kg/m^3) most likely come from a missing material
+    const double min_plausible_density = 100.0;
+    const double max_plausible_density = 25000.0;
+    double tolerance = 0.05;
+    if (config["meshInertiaCheck"]["tolerance"].IsDefined()) {
+        tolerance = config["meshInertiaCheck"]["tolerance"].as<double>();
+    }
 
-    // Account for csysPart_H_link_frame transformation
-    // See https://github.com/icub-tech-iit/ergocub-software/issues/224#issuecomment-1985692598 for full contents
+    struct MeshInertiaCheck {
+        std::string link_name;
+        std::string mesh_file_name;
+        double creo_volume{ 0.0 };
+        iDynTree::SpatialInertia inertia;
+        bool read{ false };
+        MeshMassProperties properties;
+    };
+
+    std::vector<MeshInertiaCheck> checks;
+    for (auto link_info_it : link_info_map.sortedByName()) {
+        const auto& link_info = *link_info_it;
+        auto link_index = idyn_model.getLinkIndex(link_info.second.name);
+        if (link_info.second.mesh_file_name.empty() || link_index == iDynTree::LINK_INVALID_INDEX) {
+            continue;
+        }
+        MeshInertiaCheck check;
+        check.link_name = link_info.second.name;
+        check.mesh_file_name = link_info.second.mesh_file_name;
+        check.creo_volume = link_info.second.creo_volume;
+        check.inertia = idyn_model.getLink(link_index)->getInertia();
+        checks.push_back(check);
+    }
+
+    // The meshes are in the link frame, in the units of the part
+    parallelFor(checks.size(), [&checks, this](std::size_t i) {
+        TriangleMesh mesh;
+        checks[i].read = readSTL(checks[i].mesh_file_name, mesh, scale);
+        if (checks[i].read) {
+            checks[i].properties = computeMeshMassProperties(mesh);
+        }
+    });
 
-    // The COM returned by Creo's GetGravityCenter seems to be expressed in the root frame, so we need 
-    // to transform it back to the link frame before passing it to iDynTree's fromRotationalInertiaWrtCenterOfMass
-    com_child = H.inverse() * com_child;
+    bool ok = true;
+    for (const auto& check : checks) {
+        const auto& mesh = check.properties;
+        if (!check.read) {
+            printToMessageWindow("Failed to read the mesh " + check.mesh_file_name, c2uLogLevel::WARN);
+            continue;
+        }
+        if (!mesh.closed) {
+            printToMessageWindow("The mesh of " + check.link_name + " is not closed, skipping the inertia check", c2uLogLevel::INFO);
+            continue;
+        }
 
-    // The inertia returned by Creo's GetCenterGravityInertiaTensor seems to be expressed with the COM as the
-    // point in which it is expressed, and with the orientation of the CSYS of the part, so we rotate it back with
-    // the orientation of the link frame, unless an assignedInertia is used
-    if (!assigned_inertia_flag) {
-        // Note, this auto-defined methods are Eigen::Map, so they are reference to data that remains
-        // stored in the original iDynTree object, see https://eigen.tuxfamily.org/dox/group__TutorialMapClass.html
-        auto inertia_tensor_root = iDynTree::toEigen(idyn_inertia_tensor_csysPart_orientation);
-        auto inertia_tensor_link = iDynTree::toEigen(idyn_inertia_tensor_link_orientation);
-        auto csysPart_R_link = iDynTree::toEigen(H.getRotation());
+        const double mass = check.inertia.getMass();
+        if (mass <= 0.0) {
+            printToMessageWindow(check.link_name + " has no mass, check the material of the part", c2uLogLevel::WARN);
+            ok = false;
+            continue;
+        }
+        const double density = mass / mesh.volume;
+        const double volume_error = std::abs(mesh.volume - check.creo_volume) / mesh.volume;
+        if (volume_error > tolerance) {
+            printToMessageWindow(check.link_name + ": the volume of the mesh differs by " + to_string(volume_error * 100.0) +
+                "% from the one of Creo", c2uLogLevel::WARN);
+            ok = false;
+        }
+        if (density < min_plausible_density || density > max_plausible_density) {
+            printToMessageWindow(check.link_name + ": the density is " + to_string(density) +
+                " kg/m^3, check the material of the part or the assigned mass", c2uLogLevel::WARN);
+            ok = false;
+        }
 
-        // See Equation 15 of https://ocw.mit.edu/courses/16-07-dynamics-fall-2009/dd277ec654440f4c2b5b07d6c286c3fd_MIT16_07F09_Lec26.pdf
-        inertia_tensor_link = csysPart_R_link.transpose()*inertia_tensor_root*csysPart_R_link;
+        // The radius of gyration of the mesh is used as length scale for the center of mass
+        const Eigen::Matrix3d mesh_gyration = mesh.inertia / mesh.volume;
+        const double gyration_radius = std::sqrt(0.5 * mesh_gyration.trace());
+        const double com_error = (iDynTree::toEigen(check.inertia.getCenterOfMass()) - mesh.com).norm();
+        if (com_error > tolerance * gyration_radius) {
+            printToMessageWindow(check.link_name + ": the center of mass is " + to_string(com_error) +
+                " m away from the one of the mesh", c2uLogLevel::WARN);
+            ok = false;
+        }
+
+        // The inertias are compared per unit of mass, since the mass may have been assigned
+        const Eigen::Matrix3d link_gyration = iDynTree::toEigen(check.inertia.getRotationalInertiaWrtCenterOfMass()) / mass;
+        const double inertia_error = (link_gyration - mesh_gyration).norm() / mesh_gyration.norm();
+        if (inertia_error > tolerance) {
+            printToMessageWindow(check.link_name + ": the inertia differs by " + to_string(inertia_error * 100.0) +
+                "% from the one of the mesh", c2uLogLevel::WARN);
+            ok = false;
+        }
     }
 
-    double mass{ 0.0 };
+    printToMessageWindow("Checked the inertia of " + to_string(checks.size()) + " links against their meshes");
+    return ok;
+}
+
+ShardLink Creo2Urdf::readMassProperties(const std::string& part_name, pfcMassProperty_ptr mass_prop) const {
+    ShardLink mass_properties;
+    mass_properties.name = part_name;
+    mass_properties.mass = mass_prop->GetMass();
+    mass_properties.volume = mass_prop->GetVolume() * scale[0] * scale[1] * scale[2];
+
+    auto com = mass_prop->GetGravityCenter();
+    auto inertia_tensor = mass_prop->GetCenterGravityInertiaTensor();
+    for (int i_row = 0; i_row < 3; i_row++) {
+        mass_properties.com[i_row] = com->get(i_row);
+        for (int j_col = 0; j_col < 3; j_col++) {
+            mass_properties.inertia[3 * i_row + j_col] = inertia_tensor->get(i_row, j_col);
+        }
+    }
+    return mass_properties;
+}
+
+void Creo2Urdf::addLinkToTable(const ShardLink& mass_properties, const iDynTree::Transform& csysPart_H_link_frame, const std::string& link_name) {
+
+    // The COM returned by Creo's GetGravityCenter seems to be expressed in the root frame, and the inertia returned by
+    // GetCenterGravityInertiaTensor with the orientation of the CSYS of the part, so both are moved to the link frame.
+    // See https://github.com/icub-tech-iit/ergocub-software/issues/224#issuecomment-1985692598 for full contents
+    Eigen::Matrix3d creo_inertia;
+    for (int i_row = 0; i_row < 3; i_row++) {
+        for (int j_col = 0; j_col < 3; j_col++) {
+            creo_inertia(i_row, j_col) = mass_properties.inertia[3 * i_row + j_col];
+        }
+    }
+
+    const auto& com = mass_properties.com;
+    auto index = link_table.add(link_name, mass_properties.mass, { com[0], com[1], com[2] }, creo_inertia,
+                                iDynTree::toEigen(csysPart_H_link_frame.getRotation()), iDynTree::toEigen(csysPart_H_link_frame.getPosition()));
+
     if (config["assignedMasses"][link_name].IsDefined()) {
-        mass = config["assignedMasses"][link_name].as<double>();
+        link_table.assignMass(index, config["assignedMasses"][link_name].as<double>());
     }
-    else {
-        mass = mass_prop->GetMass();
+    // The assigned inertia is already expressed in the link frame
+    if (assigned_inertias_map.find(link_name) != assigned_inertias_map.end()) {
+        link_table.assignInertia(index, assigned_inertias_map.at(link_name));
+    }
+}
+
+bool Creo2Urdf::computeLinkInertias() {
+    link_table.computeInertias(scale);
+
+    bool ok = true;
+    for (std::size_t index = 0; index < link_table.size(); index++) {
+        const auto& link_name = link_table.getName(index);
+        auto link_index = idyn_model.getLinkIndex(link_name);
+        if (link_index == iDynTree::LINK_INVALID_INDEX) {
+            continue;
+        }
+
+        iDynTree::RotationalInertiaRaw inertia;
+        iDynTree::Position com;
+        iDynTree::toEigen(inertia) = link_table.getInertia(index);
+        iDynTree::toEigen(com) = link_table.getCenterOfMass(index);
+        iDynTree::SpatialInertia sp_inertia;
+        sp_inertia.fromRotationalInertiaWrtCenterOfMass(link_table.getMass(index), com, inertia);
+        idyn_model.getLink(link_index)->setInertia(sp_inertia);
+
+        if (!link_table.isPhysicallyConsistent(index)) {
+            printToMessageWindow(link_name + " is NOT physically consistent!", c2uLogLevel::WARN);
+            ok = false;
+        }
+    }
+
+    return ok || !warningsAreFatal;
+}
+
+std::pair<FrameGraph::FrameIndex, FrameGraph::FrameIndex> Creo2Urdf::addComponentFrames(pfcComponentPath_ptr comp_path, const ModelRecord& component,
+                                                                                       FrameGraph::FrameIndex owner_frame, const std::string& link_frame_name,
+                                                                                       std::vector<std::string>& csys_names) {
+    const auto& component_name = component.full_name;
+
+    auto csysAsm_H_csysPart = iDynTree::Transform::Identity();
+    try {
+        csysAsm_H_csysPart = fromCreo(comp_path->GetTransform(xtrue), scale);
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        printToMessageWindow("Exception caught: Could not retrieve transform of " + component_name, c2uLogLevel::WARN);
+    }
+    xcatchend
+
+    // A subassembly can be instantiated more than once, so only the frames of the parts are named
+    bool named = component.type != pfcMDL_ASSEMBLY;
+    auto component_frame = frame_graph.addFrame(named ? component_name : "", owner_frame, csysAsm_H_csysPart);
+    if (component_frame == FrameGraph::INVALID_FRAME_INDEX) {
+        printToMessageWindow("The frame of " + component_name + " is already in the frame graph", c2uLogLevel::WARN);
+        component_frame = frame_graph.addFrame("", owner_frame, csysAsm_H_csysPart);
+        named = false;
     }
-    iDynTree::SpatialInertia sp_inertia(mass, com_child, idyn_inertia_tensor_link_orientation);
-    sp_inertia.fromRotationalInertiaWrtCenterOfMass(mass, com_child, idyn_inertia_tensor_link_orientation);
 
-    return sp_inertia;
+    auto link_frame = FrameGraph::INVALID_FRAME_INDEX;
+    for (const auto& csys : getCoordinateSystems(component.handle, scale)) {
+        auto csys_frame = frame_graph.addFrame(named ? FrameGraph::getDatumFrameName(component_name, csys.first) : "", component_frame, csys.second);
+        if (csys.first == link_frame_name && link_frame == FrameGraph::INVALID_FRAME_INDEX) {
+            link_frame = csys_frame;
+        }
+        csys_names.push_back(csys.first);
+    }
+    return { component_frame, link_frame };
 }
 
-void Creo2Urdf::populateExportedFrameInfoMap(pfcModel_ptr modelhdl) {
+void Creo2Urdf::populateExportedFrameInfoMap(const std::string& link_name, const std::vector<std::string>& csys_names) {
 
     // The revolute joints are defined by aligning along the
     // rotational axis
-    auto link_name = string(modelhdl->GetFullName());
-    auto csys_list = modelhdl->ListItems(pfcModelItemType::pfcITEM_COORD_SYS);
-
-    if (csys_list->getarraysize() == 0) {
+    if (csys_names.empty()) {
         printToMessageWindow("There is no CSYS in the part " + link_name, c2uLogLevel::WARN);
     }
     // Now let's handle csys, they can form fixed links (FT sensors), or define exported frames
-    for (xint i = 0; i < csys_list->getarraysize(); i++)
+    for (const auto& csys_name : csys_names)
     {
-        auto csys_name = string(csys_list->get(i)->GetName());
         // If true the exported_frame_info_map is not populated w/ the data from yaml
         if (exportAllUseradded) {
             if (csys_name.find("SCSYS") == std::string::npos ||
@@ -580,14 +1514,13 @@ void Creo2Urdf::populateExportedFrameInfoMap(pfcModel_ptr modelhdl) {
             auto& exported_frame_info = exported_frame_info_map.at(csys_name);
             auto& link_info = link_info_map.at(link_name);
             bool ret{ false };
-            iDynTree::Transform csys_H_additionalFrame {iDynTree::Transform::Identity()};
-            iDynTree::Transform csys_H_linkFrame {iDynTree::Transform::Identity()};
             iDynTree::Transform linkFrame_H_additionalFrame {iDynTree::Transform::Identity()};
 
-            std::tie(ret, csys_H_additionalFrame) = getTransformFromPart(modelhdl, csys_name, scale);
-            std::tie(ret, csys_H_linkFrame) = getTransformFromPart(modelhdl, link_info.link_frame_name, scale);
-
-            linkFrame_H_additionalFrame = csys_H_linkFrame.inverse() * csys_H_additionalFrame;
+            std::tie(ret, linkFrame_H_additionalFrame) = frame_graph.getTransform(FrameGraph::getDatumFrameName(link_name, link_info.link_frame_name),
+                                                                                 FrameGraph::getDatumFrameName(link_name, csys_name));
+            if (!ret) {
+                printToMessageWindow("Unable to get the transform for " + csys_name + " in " + link_name, c2uLogLevel::WARN);
+            }
             exported_frame_info.linkFrame_H_additionalFrame = linkFrame_H_additionalFrame;
 
         }
@@ -658,18 +1591,14 @@ void Creo2Urdf::readExportedFramesFromConfig() {
     }
 }
 
-bool Creo2Urdf::addMeshAndExport(pfcModel_ptr component_handle, const std::string& mesh_transform)
+bool Creo2Urdf::addMeshAndExport(const ModelRecord& component, const std::string& mesh_transform)
 {
+    auto component_handle = component.handle;
     bool export_mesh = true;
     std::string file_extension = ".stl";
     std::string meshFormat = "stl_binary";
-    std::string link_name = component_handle->GetFullName();
-    std::string renamed_link_name = link_name;
- 
-    if (config["rename"][link_name].IsDefined())
-    {
-        renamed_link_name = config["rename"][link_name].Scalar();
-    }
+    std::string link_name = component.full_name;
+    const std::string renamed_link_name = rename_table.getRenamed(link_name);
 
     if (config["exportMeshes"].IsDefined())
     {
@@ -736,8 +1665,17 @@ bool Creo2Urdf::addMeshAndExport(pfcModel_ptr component_handle, const std::strin
         }
         mesh_file_name = m_output_path + "\\" + mesh_file_name;
 
+        bool mirrored = !coordinating && (meshFormat == "stl_binary" || meshFormat == "stl_ascii") &&
+                        exportMirroredMesh(component.full_name, mesh_file_name, meshFormat == "stl_binary");
+
         try {
-            if (meshFormat == "stl_binary") {
+            if (coordinating) {
+                // The mesh is exported by the worker of the shard of the component
+            }
+            else if (mirrored) {
+                // The mesh was derived from the one of the mirror image of the part
+            }
+            else if (meshFormat == "stl_binary") {
                 auto stl_binary_export_instructions = pfcSTLBinaryExportInstructions().Create(mesh_transform.c_str());
                 stl_binary_export_instructions->SetQuality(mesh_quality);
                 component_handle->Export(mesh_file_name.c_str(), pfcExportInstructions::cast(stl_binary_export_instructions));
@@ -766,9 +1704,16 @@ bool Creo2Urdf::addMeshAndExport(pfcModel_ptr component_handle, const std::strin
         // Replace the first 5 bytes of the binary file with a string different than "solid"
         // to avoid issues with stl parsers.
         // For details see: https://github.com/icub-tech-iit/creo2urdf/issues/16
-        if (meshFormat == "stl_binary") {
+        if (meshFormat == "stl_binary" && !coordinating) {
             sanitizeSTL(mesh_file_name);
         }
+
+        if (meshFormat == "stl_binary" || meshFormat == "stl_ascii") {
+            auto link_info = link_info_map.find(component.full_name);
+            if (link_info != link_info_map.end()) {
+                link_info->second.mesh_file_name = mesh_file_name;
+            }
+        }
     }
 
     // Lets add the mesh to the link
@@ -843,29 +1788,13 @@ bool Creo2Urdf::addMeshAndExport(pfcModel_ptr component_handle, const std::strin
 
 bool Creo2Urdf::loadYamlConfig(const std::string& filename)
 {
-    try 
+    if (!loadYamlConfigWithIncludes(filename, config))
     {
-        config = YAML::LoadFile(filename);
-        if (config["includes"].IsDefined() && config["includes"].IsSequence()) {
-            auto folder_path = extractFolderPath(filename);
-            for (const auto& include : config["includes"]) {
-                auto include_filename = folder_path + include.as<std::string>();
-                auto include_config = YAML::LoadFile(include_filename);
-                mergeYAMLNodes(config, include_config);
-            }
-        }
-    }
-    catch (YAML::BadFile file_does_not_exist) 
-    {
-        printToMessageWindow("Configuration file " + filename + " does not exist!", c2uLogLevel::WARN);
-        return false;
-    }
-    catch (YAML::ParserException badly_formed) 
-    {
-        printToMessageWindow(badly_formed.msg, c2uLogLevel::WARN);
         return false;
     }
 
+    rename_table.load(config["rename"]);
+
     printToMessageWindow("Configuration file " + filename + " was loaded successfully");
 
     return true;
@@ -873,10 +1802,10 @@ bool Creo2Urdf::loadYamlConfig(const std::string& filename)
 
 std::string Creo2Urdf::getRenameElementFromConfig(const std::string& elem_name)
 {
-    if (config["rename"][elem_name].IsDefined())
+    const std::string* new_name = rename_table.findRenamed(elem_name);
+    if (new_name)
     {
-        std::string new_name = config["rename"][elem_name].Scalar();
-        return new_name;
+        return *new_name;
     }
     else
     {
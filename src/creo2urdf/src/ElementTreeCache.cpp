@@ -0,0 +1,145 @@
+/**
+ * @file ElementTreeCache.cpp
+ * @brief Contains definitions for the ElementTreeCache class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/ElementTreeCache.h>
+
+#include <fstream>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Version of the file format, the files written with another version are ignored.
+ */
+constexpr int element_tree_cache_version = 1;
+
+} // namespace
+
+bool ElementTreeCache::load(const std::string& filename)
+{
+    m_entries.clear();
+
+    YAML::Node node;
+    try {
+        node = YAML::LoadFile(filename);
+    }
+    catch (const YAML::Exception&) {
+        return false;
+    }
+    if (!node["version"].IsDefined() || node["version"].as<int>() != element_tree_cache_version || !node["entries"].IsSequence()) {
+        return false;
+    }
+
+    try {
+        for (const auto& entry : node["entries"]) {
+            Key key;
+            key.owner_name = entry["owner"].as<std::string>();
+            key.feature_id = entry["featureId"].as<int>();
+            key.revision = entry["revision"].as<int>();
+
+            ExtractedJoint joint;
+            joint.valid = entry["valid"].as<bool>();
+            if (joint.valid) {
+                joint.parent_link_name = entry["parent"].as<std::string>();
+                joint.child_link_name = entry["child"].as<std::string>();
+                joint.datum_name = entry["datum"].as<std::string>();
+                joint.type = static_cast<JointType>(entry["type"].as<int>());
+                if (entry["limits"].IsDefined()) {
+                    const auto limits = entry["limits"].as<std::array<double, 2>>();
+                    joint.limits.available = true;
+                    joint.limits.min = limits[0];
+                    joint.limits.max = limits[1];
+                }
+                if (entry["initialTransform"].IsDefined()) {
+                    // Position followed by the rotation matrix, row by row
+                    const auto h = entry["initialTransform"].as<std::array<double, 12>>();
+                    joint.initial_transform.setPosition({ h[0], h[1], h[2] });
+                    joint.initial_transform.setRotation({ h[3], h[4], h[5],
+                                                          h[6], h[7], h[8],
+                                                          h[9], h[10], h[11] });
+                    joint.has_initial_transform = true;
+                }
+            }
+            insert(key, joint);
+        }
+    }
+    catch (const YAML::Exception&) {
+        m_entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ElementTreeCache::save(const std::string& filename) const
+{
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "version" << YAML::Value << element_tree_cache_version;
+    out << YAML::Key << "entries" << YAML::Value << YAML::BeginSeq;
+    for (const auto& entry : m_entries) {
+        const Key& key = entry.second.first;
+        const ExtractedJoint& joint = entry.second.second;
+        out << YAML::BeginMap;
+        out << YAML::Key << "owner" << YAML::Value << key.owner_name;
+        out << YAML::Key << "featureId" << YAML::Value << key.feature_id;
+        out << YAML::Key << "revision" << YAML::Value << key.revision;
+        out << YAML::Key << "valid" << YAML::Value << joint.valid;
+        if (joint.valid) {
+            out << YAML::Key << "parent" << YAML::Value << joint.parent_link_name;
+            out << YAML::Key << "child" << YAML::Value << joint.child_link_name;
+            out << YAML::Key << "datum" << YAML::Value << joint.datum_name;
+            out << YAML::Key << "type" << YAML::Value << static_cast<int>(joint.type);
+            if (joint.limits.available) {
+                out << YAML::Key << "limits" << YAML::Value << YAML::Flow
+                    << std::vector<double>{ joint.limits.min, joint.limits.max };
+            }
+            if (joint.has_initial_transform) {
+                const auto p = joint.initial_transform.getPosition();
+                const auto r = joint.initial_transform.getRotation();
+                out << YAML::Key << "initialTransform" << YAML::Value << YAML::Flow
+                    << std::vector<double>{ p(0), p(1), p(2),
+                                            r(0, 0), r(0, 1), r(0, 2),
+                                            r(1, 0), r(1, 1), r(1, 2),
+                                            r(2, 0), r(2, 1), r(2, 2) };
+            }
+        }
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << out.c_str() << std::endl;
+    return file.good();
+}
+
+const ExtractedJoint* ElementTreeCache::find(const Key& key) const
+{
+    auto it = m_entries.find(toString(key));
+    return it == m_entries.end() ? nullptr : &it->second.second;
+}
+
+void ElementTreeCache::insert(const Key& key, const ExtractedJoint& joint)
+{
+    m_entries[toString(key)] = std::make_pair(key, joint);
+}
+
+void ElementTreeCache::clear()
+{
+    m_entries.clear();
+    m_statistics = Statistics();
+}
+
+std::string ElementTreeCache::toString(const Key& key)
+{
+    return key.owner_name + "#" + std::to_string(key.feature_id) + "#" + std::to_string(key.revision);
+}
@@ -11,10 +11,72 @@
 
 #include <creo2urdf/ElementTreeManager.h>
 
+#include <pfcExceptions.h>
+
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Builds the path of an element of the element tree.
+ * @param ids The ids of the elements along the path.
+ * @return The element path.
+ */
+wfcElementPath_ptr createElementPath(const std::vector<int>& ids)
+{
+    wfcElemPathItems_ptr elemItems = wfcElemPathItems::create();
+    for (auto id : ids) {
+        elemItems->append(wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, id));
+    }
+    return wfcElementPath::Create(elemItems);
+}
+
+/**
+ * @brief Builds the path of an element of the joint axis settings of the first component set.
+ * @param leaf_ids The ids of the elements that follow PRO_E_COMPONENT_JAS_SET in the path.
+ * @return The element path.
+ */
+wfcElementPath_ptr createJointAxisSettingsPath(std::initializer_list<int> leaf_ids)
+{
+    std::vector<int> ids{ wfcPRO_E_COMPONENT_SETS, wfcPRO_E_COMPONENT_SET, wfcPRO_E_COMPONENT_JAS_SETS, wfcPRO_E_COMPONENT_JAS_SET };
+    ids.insert(ids.end(), leaf_ids.begin(), leaf_ids.end());
+    return createElementPath(ids);
+}
+
+/**
+ * @brief The paths of the elements read from the component element trees.
+ */
+struct ElementPaths {
+    wfcElementPath_ptr set_type{ createElementPath({ wfcPRO_E_COMPONENT_SETS, wfcPRO_E_COMPONENT_SET, wfcPRO_E_COMPONENT_SET_TYPE }) };
+    wfcElementPath_ptr component_model{ createElementPath({ wfcPRO_E_COMPONENT_MODEL }) };
+    wfcElementPath_ptr init_pos{ createElementPath({ wfcPRO_E_COMPONENT_INIT_POS }) };
+    wfcElementPath_ptr min_limit_flag{ createJointAxisSettingsPath({ wfcPRO_E_COMPONENT_JAS_MIN_LIMIT, wfcPRO_E_COMPONENT_JAS_MIN_LIMIT_FLAG }) };
+    wfcElementPath_ptr min_limit_value{ createJointAxisSettingsPath({ wfcPRO_E_COMPONENT_JAS_MIN_LIMIT, wfcPRO_E_COMPONENT_JAS_MIN_LIMIT_VAL }) };
+    wfcElementPath_ptr max_limit_flag{ createJointAxisSettingsPath({ wfcPRO_E_COMPONENT_JAS_MAX_LIMIT, wfcPRO_E_COMPONENT_JAS_MAX_LIMIT_FLAG }) };
+    wfcElementPath_ptr max_limit_value{ createJointAxisSettingsPath({ wfcPRO_E_COMPONENT_JAS_MAX_LIMIT, wfcPRO_E_COMPONENT_JAS_MAX_LIMIT_VAL }) };
+    wfcElementPath_ptr regen_value_flag{ createJointAxisSettingsPath({ wfcPRO_E_COMPONENT_JAS_REGEN_VALUE_GROUP, wfcPRO_E_COMPONENT_JAS_REGEN_VALUE_FLAG }) };
+    wfcElementPath_ptr regen_value{ createJointAxisSettingsPath({ wfcPRO_E_COMPONENT_JAS_REGEN_VALUE_GROUP, wfcPRO_E_COMPONENT_JAS_REGEN_VALUE }) };
+};
+
+/**
+ * @brief Gets the element paths, built the first time they are needed and shared by all the element trees.
+ */
+const ElementPaths& getElementPaths()
+{
+    // Never destroyed, since the toolkit may be unloaded before the static objects
+    static const ElementPaths* paths = new ElementPaths();
+    return *paths;
+}
+
+} // namespace
+
 ElementTreeManager::ElementTreeManager()
 {}
 
-ElementTreeManager::ElementTreeManager(pfcFeature_ptr feat, std::map<std::string, JointInfo>& joint_info_map)
+ElementTreeManager::ElementTreeManager(SolidReferenceCache* solid_references) : solid_references(solid_references)
+{}
+
+ElementTreeManager::ElementTreeManager(pfcFeature_ptr feat, NameMap<JointInfo>& joint_info_map)
 {
     if (!populateJointInfoFromElementTree(feat, joint_info_map))
     {
@@ -24,7 +86,57 @@ ElementTreeManager::ElementTreeManager(pfcFeature_ptr feat, std::map<std::string
 
 ElementTreeManager::~ElementTreeManager() {}
 
-bool ElementTreeManager::populateJointInfoFromElementTree(pfcFeature_ptr feat, std::map<std::string, JointInfo>& joint_info_map)
+bool ElementTreeManager::populateJointInfoFromElementTree(pfcFeature_ptr feat, NameMap<JointInfo>& joint_info_map,
+                                                          const std::array<double, 3>& scale, ElementTreeCache* cache)
+{
+    ElementTreeCache::Key key;
+    const bool cacheable = cache != nullptr && getCacheKey(feat, key);
+    if (cacheable) {
+        const ExtractedJoint* cached = cache->find(key);
+        if (cached) {
+            cache->getStatistics().cache_hits++;
+            if (cached->valid) {
+                insertJointInfo(*cached, joint_info_map, scale);
+            }
+            return cached->valid;
+        }
+    }
+
+    ExtractedJoint joint;
+    pfcComponentConstraints_ptr constraints = nullptr;
+    try {
+        constraints = pfcComponentFeat::cast(feat)->GetConstraints();
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        constraints = nullptr;
+    }
+    xcatchend
+
+    // A component placed without constraints has no joint set, so its element tree is not extracted
+    if (constraints == nullptr || constraints->getarraysize() == 0) {
+        if (cache) {
+            cache->getStatistics().skipped_features++;
+        }
+    }
+    else {
+        if (cache) {
+            cache->getStatistics().extracted_trees++;
+        }
+        joint.valid = extractJoint(feat, constraints, joint);
+    }
+
+    if (cacheable) {
+        cache->insert(key, joint);
+    }
+    if (joint.valid) {
+        insertJointInfo(joint, joint_info_map, scale);
+    }
+    return joint.valid;
+}
+
+bool ElementTreeManager::extractJoint(pfcFeature_ptr feat, pfcComponentConstraints_ptr constraints, ExtractedJoint& joint)
 {
     wfeat = wfcWFeature::cast(feat);
 
@@ -38,28 +150,32 @@ bool ElementTreeManager::populateJointInfoFromElementTree(pfcFeature_ptr feat, s
         return false;
     }
     xcatchend
-    
-    JointInfo joint;
-
 
-    if (!retrieveSolidReferences()) {
+    if (!retrieveSolidReferences(feat)) {
         return false;
     }
     joint.child_link_name = getChildName();
     joint.parent_link_name = getParentName();
-    std::string joint_name = joint.parent_link_name + "--" + joint.child_link_name;
-    joint.type = proAsmCompSetType_to_JointType.at(static_cast<ProAsmcompSetType>(getConstraintType()));
+
+    auto joint_type = proAsmCompSetType_to_JointType.find(static_cast<ProAsmcompSetType>(getConstraintType()));
+    if (joint_type == proAsmCompSetType_to_JointType.end()) {
+        return false;
+    }
+    joint.type = joint_type->second;
 
     if (joint.type == JointType::Revolute || joint.type == JointType::Linear)
     {
         // We assume that one axis is used to defined the revolute or linear joint
-        joint.datum_name = getConstraintDatum(feat, 
+        joint.datum_name = getConstraintDatum(constraints,
             pfcComponentConstraintType::pfcASM_CONSTRAINT_ALIGN,
             pfcModelItemType::pfcITEM_AXIS);
+
+        // The limits are read from the tree already extracted, the csv can override them
+        retrieveLimits(joint.limits);
     }
     else if (joint.type == JointType::Fixed)
     {
-        joint.datum_name = getConstraintDatum(feat,
+        joint.datum_name = getConstraintDatum(constraints,
             pfcComponentConstraintType::pfcASM_CONSTRAINT_CSYS,
             pfcModelItemType::pfcITEM_COORD_SYS);
     }
@@ -68,11 +184,63 @@ bool ElementTreeManager::populateJointInfoFromElementTree(pfcFeature_ptr feat, s
         return false;
     }
 
-    joint_info_map.insert({ joint_name, joint });
+    auto parentCsys_H_childCsys = retrieveTransform();
+    if (parentCsys_H_childCsys) {
+        joint.initial_transform = fromCreo(parentCsys_H_childCsys);
+        joint.has_initial_transform = true;
+    }
 
     return true;
 }
 
+void ElementTreeManager::insertJointInfo(const ExtractedJoint& joint, NameMap<JointInfo>& joint_info_map, const std::array<double, 3>& scale)
+{
+    JointInfo joint_info;
+    joint_info.child_link_id = joint_info_map.getNames()->intern(joint.child_link_name);
+    joint_info.parent_link_id = joint_info_map.getNames()->intern(joint.parent_link_name);
+    joint_info.type = joint.type;
+    joint_info.datum_name = joint.datum_name;
+
+    joint_info.limits = joint.limits;
+    if (joint_info.limits.available && joint_info.type == JointType::Linear) {
+        joint_info.limits.min *= scale[0];
+        joint_info.limits.max *= scale[0];
+    }
+
+    joint_info.has_initial_transform = joint.has_initial_transform;
+    if (joint.has_initial_transform) {
+        joint_info.initial_transform = joint.initial_transform;
+        auto position = joint_info.initial_transform.getPosition();
+        for (int i = 0; i < 3; i++) {
+            position(i) *= scale[i];
+        }
+        joint_info.initial_transform.setPosition(position);
+    }
+
+    joint_info_map.insert({ joint.parent_link_name + "--" + joint.child_link_name, joint_info });
+}
+
+bool ElementTreeManager::getCacheKey(pfcFeature_ptr feat, ElementTreeCache::Key& key)
+{
+    try {
+        auto owner = feat->GetSolid();
+        // The revision number changes only when the owner is saved, the modified owners are not cached
+        if (owner == nullptr || owner->GetIsModified()) {
+            return false;
+        }
+        key.owner_name = std::string(owner->GetFullName());
+        key.feature_id = feat->GetId();
+        key.revision = owner->GetRevisionNumber();
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        return false;
+    }
+    xcatchend
+    return true;
+}
+
 int ElementTreeManager::getConstraintType()
 {
     if (tree == nullptr)
@@ -80,16 +248,8 @@ int ElementTreeManager::getConstraintType()
         return -1;
     }
 
-    wfcElemPathItems_ptr elemItems = wfcElemPathItems::create();
-    wfcElemPathItem_ptr Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_SETS);
-    elemItems->append(Item);
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_SET);
-    elemItems->append(Item);
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_SET_TYPE);
-    elemItems->append(Item);
-
     try {
-        return tree->GetElement(wfcElementPath::Create(elemItems))->GetValue()->GetIntValue();
+        return tree->GetElement(getElementPaths().set_type)->GetValue()->GetIntValue();
     }
     xcatchbegin
     xcatchcip(pfcXBadGetArgValue)
@@ -100,10 +260,8 @@ int ElementTreeManager::getConstraintType()
     xcatchend
 }
 
-string ElementTreeManager::getConstraintDatum(pfcFeature_ptr feat, pfcComponentConstraintType constraint_type, pfcModelItemType datum_type)
+string ElementTreeManager::getConstraintDatum(pfcComponentConstraints_ptr constr, pfcComponentConstraintType constraint_type, pfcModelItemType datum_type)
 {
-    auto compfeat = pfcComponentFeat::cast(feat);
-    auto constr = compfeat->GetConstraints();
 
     for (int i = 0; i < constr->getarraysize(); i++)
     {
@@ -122,32 +280,47 @@ string ElementTreeManager::getConstraintDatum(pfcFeature_ptr feat, pfcComponentC
 
 std::string ElementTreeManager::getParentName()
 {
-    if (!tree || !parent_solid)
+    if (!tree || parent_solid_name.empty())
     {
         printToMessageWindow("Tree or parent solid is null!", c2uLogLevel::WARN);
         return "";
     }
-    try{
-        return  std::string(parent_solid->GetFullName());
-    }
-    xcatchbegin
-    xcatchcip(defaultEx)
+    // The name is read when the references are resolved, the model may have been released since then
+    return parent_solid_name;
+}
+
+std::string ElementTreeManager::getChildName()
+{
+    if (!tree || child_solid_name.empty())
     {
+        printToMessageWindow("Tree or child solid is null!", c2uLogLevel::WARN);
         return "";
     }
-    xcatchend
+    return child_solid_name;
 }
 
-std::string ElementTreeManager::getChildName()
+bool ElementTreeManager::retrieveSolidReferences(pfcFeature_ptr feat)
 {
-    if (!tree || !child_solid)
+    const SolidReferenceCache::SolidReferences* cached = solid_references ? solid_references->find(feat) : nullptr;
+    const auto references = cached ? *cached : SolidReferenceCache::resolve(wfeat);
+    parent_solid_name = references.parent_name;
+    child_solid_name = references.child_name;
+    return references.valid;
+}
+
+std::string ElementTreeManager::retrievePartName()
+{
+    if (tree == nullptr)
     {
-        printToMessageWindow("Tree or child solid is null!", c2uLogLevel::WARN);
         return "";
     }
-    try {
 
-        return std::string(child_solid->GetFullName());
+    // The element tree shows the child name, aka the current part as 
+    // <PRO_E_COMPONENT_MODEL type = "pointer" application = "model"> <name_of_part>.prt < / PRO_E_COMPONENT_MODEL>
+    // and it cannot be retrieved with GetValue() because it throws an exception
+    try {
+        wfcElement_ptr element = tree->GetElement(getElementPaths().component_model);
+        return std::string(element->GetSpecialValueElem()->GetComponentModel()->GetFullName());
     }
     xcatchbegin
     xcatchcip(defaultEx)
@@ -157,142 +330,104 @@ std::string ElementTreeManager::getChildName()
     xcatchend
 }
 
-bool ElementTreeManager::retrieveSolidReferences()
-{
-    auto parents = wfeat->GetExternalParents(wfcExternalReferenceType::wfcALL_REF_TYPES);
 
-    if (parents == NULL) {
-
-        return false;
+pfcTransform3D_ptr ElementTreeManager::retrieveTransform() {
+    if (tree == nullptr)
+    {
+        return nullptr;
     }
 
-    for (int l = 0; l < parents->getarraysize(); l++)
+    try {
+        auto value_ptr = tree->GetElement(getElementPaths().init_pos)->GetValue();
+        if (!value_ptr) {
+            return nullptr;
+        }
+        pfcTransform3D_ptr parentCsys_H_childCsys = value_ptr->GetTransformValue();
+        // Because the transform is from child to parent, we need to invert it
+        if (parentCsys_H_childCsys) {
+            parentCsys_H_childCsys->Invert();
+        }
+        return parentCsys_H_childCsys;
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
     {
-        auto extrefs = parents->get(l)->GetExtRefs();
+        return nullptr;
+    }
+    xcatchend
+}
 
-        if (extrefs == NULL) {
-            return false;
-        }
 
-        // each element in this array is given by a constraint and
-        // the number of parts that compose it
-        // e.g. 2 parts x 3 constraints = size(extrefs) = 6
-        // We assume there are only two parts and they are named differently
-        if (extrefs->getarraysize() == 0)
-            return false;
+bool ElementTreeManager::retrieveLimits(JointInfo::Limits& limits)
+{
+    limits.available = false;
+    if (tree == nullptr)
+    {
+        return false;
+    }
 
-        for (int m = 0; m < extrefs->getarraysize(); m++) {
-            auto extref = extrefs->get(m)->GetAsmcomponents()->GetPathToRef()->GetLeaf();
-            // While defining a constraint the first part is the parent link and the second part is the child link
-            if (extref && !parent_solid) {
-                parent_solid = extref;
-            }
-            else if (extref && !child_solid && parent_solid) {
-                child_solid = extref;
-            }
-            else {
-                break;
-            }
+    try {
+        const auto& paths = getElementPaths();
+        const bool min_enabled = tree->GetElement(paths.min_limit_flag)->GetValue()->GetBoolValue();
+        const bool max_enabled = tree->GetElement(paths.max_limit_flag)->GetValue()->GetBoolValue();
+        if (!min_enabled || !max_enabled) {
+            return false;
         }
+        limits.min = tree->GetElement(paths.min_limit_value)->GetValue()->GetDoubleValue();
+        limits.max = tree->GetElement(paths.max_limit_value)->GetValue()->GetDoubleValue();
     }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        return false;
+    }
+    xcatchend
+
+    limits.available = true;
     return true;
 }
 
-std::string ElementTreeManager::retrievePartName()
+std::pair<bool, double> ElementTreeManager::retrieveRegenerationValue()
 {
     if (tree == nullptr)
     {
-        return "";
+        return { false, 0.0 };
     }
 
-    wfcElemPathItems_ptr elemItems = wfcElemPathItems::create();
-    elemItems->append(wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_MODEL));
-
-    // The element tree shows the child name, aka the current part as 
-    // <PRO_E_COMPONENT_MODEL type = "pointer" application = "model"> <name_of_part>.prt < / PRO_E_COMPONENT_MODEL>
-    // and it cannot be retrieved with GetValue() because it throws an exception
     try {
-        wfcElement_ptr element = tree->GetElement(wfcElementPath::Create(elemItems));
-        return std::string(element->GetSpecialValueElem()->GetComponentModel()->GetFullName());
+        auto element = tree->GetElement(getElementPaths().regen_value);
+        return { true, element->GetValue()->GetDoubleValue() };
     }
     xcatchbegin
     xcatchcip(defaultEx)
     {
-        return "";
+        return { false, 0.0 };
     }
     xcatchend
 }
 
+bool ElementTreeManager::setRegenerationValue(pfcFeature_ptr feat, double value)
+{
+    wfeat = wfcWFeature::cast(feat);
 
-pfcTransform3D_ptr ElementTreeManager::retrieveTransform(pfcFeature_ptr feat) {
-    pfcTransform3D_ptr parentCsys_H_childCsys = nullptr;
-    
-    wfcElemPathItems_ptr elemItems = wfcElemPathItems::create();
-    wfcElemPathItem_ptr Item;
-    wfcElement_ptr element;
-    
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_INIT_POS);
-    elemItems->append(Item);
-
-    wfcElementPath_ptr transform_path = wfcElementPath::Create(elemItems);
-    element = tree->GetElement(transform_path);
-
-    auto value_ptr = element->GetValue();
-    if(!value_ptr)
-        printToMessageWindow("wfcPRO_E_COMPONENT_INIT_POS value is null");
-    else {
-        parentCsys_H_childCsys = value_ptr->GetTransformValue();
-        // Because the transform is from child to parent, we need to invert it
-        parentCsys_H_childCsys->Invert();
-    }
-    
-    return parentCsys_H_childCsys;
-}
+    try {
+        tree = wfeat->GetElementTree(nullptr, wfcFEAT_EXTRACT_NO_OPTS);
 
+        const auto& paths = getElementPaths();
+        tree->GetElement(paths.regen_value_flag)->SetValue(wfcCreateBoolElemValue(xtrue));
+        tree->GetElement(paths.regen_value)->SetValue(wfcCreateDoubleElemValue(value));
 
-std::pair<double, double> ElementTreeManager::retrieveLimits(pfcFeature_ptr feat)
-{
-    wfcElemPathItems_ptr elemItems = wfcElemPathItems::create();
-    wfcElemPathItem_ptr Item;
-    wfcElement_ptr element;
-
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_SETS);
-    elemItems->append(Item);
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_SET);
-    elemItems->append(Item);
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_SETS);
-    elemItems->append(Item);
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_SET);
-    elemItems->append(Item);
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_MAX_LIMIT);
-    elemItems->append(Item);
-    Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_MAX_LIMIT_VAL);
-    elemItems->append(Item);
-
-    wfcElementPath_ptr limitpath = wfcElementPath::Create(elemItems);
-    element = tree->GetElement(limitpath);
-
-    double max = element->GetValue()->GetDoubleValue();
-
-     elemItems->clear();
-
-     Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_SETS);
-     elemItems->append(Item);
-     Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_SET);
-     elemItems->append(Item);
-     Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_SETS);
-     elemItems->append(Item);
-     Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_SET);
-     elemItems->append(Item);
-     Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_MIN_LIMIT);
-     elemItems->append(Item);
-     Item = wfcElemPathItem::Create(wfcELEM_PATH_ITEM_TYPE_ID, wfcPRO_E_COMPONENT_JAS_MIN_LIMIT_VAL);
-     elemItems->append(Item);
-
-     limitpath = wfcElementPath::Create(elemItems);
-     element = tree->GetElement(limitpath);
-
-     double min = element->GetValue()->GetDoubleValue();
-
-    return std::pair<double, double>(min, max);
+        auto options = wfcFeatureCreateOptions::create();
+        options->append(wfcFEAT_CR_NO_OPTS);
+        wfeat->RedefineFeature(nullptr, tree, options);
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        printToMessageWindow("Unable to set the regeneration value of the joint: " + string(pfcXPFC::cast(defaultEx)->GetMessage()), c2uLogLevel::WARN);
+        return false;
+    }
+    xcatchend
+
+    return true;
 }
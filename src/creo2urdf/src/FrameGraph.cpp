@@ -0,0 +1,142 @@
+/**
+ * @file FrameGraph.cpp
+ * @brief Contains definitions for the FrameGraph class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/FrameGraph.h>
+#include <creo2urdf/Parallel.h>
+
+constexpr FrameGraph::FrameIndex FrameGraph::INVALID_FRAME_INDEX;
+
+std::string FrameGraph::getDatumFrameName(const std::string& model_name, const std::string& datum_name)
+{
+    return model_name + "::" + datum_name;
+}
+
+FrameGraph::FrameIndex FrameGraph::addFrame(const std::string& name, FrameIndex parent, const iDynTree::Transform& parent_H_frame)
+{
+    if (parent != INVALID_FRAME_INDEX && parent >= size()) {
+        return INVALID_FRAME_INDEX;
+    }
+    const FrameIndex index = size();
+    if (!name.empty() && !m_indices.insert(std::make_pair(name, index)).second) {
+        return INVALID_FRAME_INDEX;
+    }
+    m_names.push_back(name);
+    m_parents.push_back(parent);
+    m_depths.push_back(parent == INVALID_FRAME_INDEX ? 0 : m_depths[parent] + 1);
+    m_parent_H_frames.push_back(parent_H_frame);
+    return index;
+}
+
+FrameGraph::FrameIndex FrameGraph::getFrameIndex(const std::string& name) const
+{
+    auto it = m_indices.find(name);
+    return it == m_indices.end() ? INVALID_FRAME_INDEX : it->second;
+}
+
+iDynTree::Transform FrameGraph::getTransform(FrameIndex frame_a, FrameIndex frame_b)
+{
+    if (frame_a == frame_b) {
+        return iDynTree::Transform::Identity();
+    }
+    const std::uint64_t key = (static_cast<std::uint64_t>(frame_a) << 32) | static_cast<std::uint64_t>(frame_b);
+    auto it = m_cache.find(key);
+    if (it != m_cache.end()) {
+        return it->second;
+    }
+
+    // The transform is composed along the tree through the closest common ancestor, so that the transforms
+    // between frames of the same part never go through the pose of the part in the assembly
+    iDynTree::Transform a_H_b;
+    const FrameIndex ancestor = findCommonAncestor(frame_a, frame_b);
+    if (ancestor == frame_a) {
+        a_H_b = getTransform(frame_a, m_parents[frame_b]) * m_parent_H_frames[frame_b];
+    }
+    else if (ancestor == frame_b) {
+        a_H_b = getTransform(frame_b, frame_a).inverse();
+    }
+    else if (ancestor != INVALID_FRAME_INDEX) {
+        a_H_b = getTransform(ancestor, frame_a).inverse() * getTransform(ancestor, frame_b);
+    }
+    else {
+        return iDynTree::Transform::Identity();
+    }
+    m_cache.insert(std::make_pair(key, a_H_b));
+    return a_H_b;
+}
+
+std::pair<bool, iDynTree::Transform> FrameGraph::getTransform(const std::string& frame_a, const std::string& frame_b)
+{
+    const FrameIndex index_a = getFrameIndex(frame_a);
+    const FrameIndex index_b = getFrameIndex(frame_b);
+    if (index_a == INVALID_FRAME_INDEX || index_b == INVALID_FRAME_INDEX || findCommonAncestor(index_a, index_b) == INVALID_FRAME_INDEX) {
+        return { false, iDynTree::Transform::Identity() };
+    }
+    return { true, getTransform(index_a, index_b) };
+}
+
+bool FrameGraph::areConnected(FrameIndex frame_a, FrameIndex frame_b) const
+{
+    return frame_a < size() && frame_b < size() && findCommonAncestor(frame_a, frame_b) != INVALID_FRAME_INDEX;
+}
+
+iDynTree::Transform FrameGraph::composeTransform(FrameIndex frame_a, FrameIndex frame_b) const
+{
+    if (!areConnected(frame_a, frame_b)) {
+        return iDynTree::Transform::Identity();
+    }
+    const FrameIndex ancestor = findCommonAncestor(frame_a, frame_b);
+    // Both chains are walked up to the common ancestor, as done by getTransform
+    iDynTree::Transform ancestor_H_a = iDynTree::Transform::Identity();
+    for (FrameIndex frame = frame_a; frame != ancestor; frame = m_parents[frame]) {
+        ancestor_H_a = m_parent_H_frames[frame] * ancestor_H_a;
+    }
+    iDynTree::Transform ancestor_H_b = iDynTree::Transform::Identity();
+    for (FrameIndex frame = frame_b; frame != ancestor; frame = m_parents[frame]) {
+        ancestor_H_b = m_parent_H_frames[frame] * ancestor_H_b;
+    }
+    return ancestor_H_a.inverse() * ancestor_H_b;
+}
+
+std::vector<iDynTree::Transform> FrameGraph::composeTransforms(const std::vector<std::pair<FrameIndex, FrameIndex>>& queries) const
+{
+    std::vector<iDynTree::Transform> transforms(queries.size(), iDynTree::Transform::Identity());
+    parallelFor(queries.size(), [&](std::size_t i) {
+        transforms[i] = composeTransform(queries[i].first, queries[i].second);
+    });
+    return transforms;
+}
+
+iDynTree::Transform FrameGraph::getTransformFromRoot(FrameIndex frame)
+{
+    FrameIndex root = frame;
+    while (m_parents[root] != INVALID_FRAME_INDEX) {
+        root = m_parents[root];
+    }
+    return getTransform(root, frame);
+}
+
+void FrameGraph::clear()
+{
+    *this = FrameGraph();
+}
+
+FrameGraph::FrameIndex FrameGraph::findCommonAncestor(FrameIndex frame_a, FrameIndex frame_b) const
+{
+    while (m_depths[frame_a] > m_depths[frame_b]) {
+        frame_a = m_parents[frame_a];
+    }
+    while (m_depths[frame_b] > m_depths[frame_a]) {
+        frame_b = m_parents[frame_b];
+    }
+    while (frame_a != frame_b && frame_a != INVALID_FRAME_INDEX) {
+        frame_a = m_parents[frame_a];
+        frame_b = m_parents[frame_b];
+    }
+    return frame_a;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file JointTable.cpp
+ * @brief Contains definitions for the JointTable class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/JointTable.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+#include <libxml2/libxml/parser.h>
+#include <libxml2/libxml/tree.h>
+
+#include <rapidcsv.h>
+
+namespace {
+
+/**
+ * @brief Member of JointParameters filled by each supported column.
+ */
+const std::unordered_map<std::string, double JointParameters::*> joint_parameter_columns = {
+    { "lower_limit", &JointParameters::lower_limit },
+    { "upper_limit", &JointParameters::upper_limit },
+    { "velocity_limit", &JointParameters::velocity_limit },
+    { "effort_limit", &JointParameters::effort_limit },
+    { "damping", &JointParameters::damping },
+    { "friction", &JointParameters::friction },
+};
+
+std::string trim(const std::string& s)
+{
+    const auto begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return s.substr(begin, s.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+/**
+ * @brief Converts a cell to a number, accepting inf and -inf.
+ * @return true if the whole cell is a number.
+ */
+bool parseNumber(const std::string& cell, double& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(cell.c_str(), &end);
+    return end != cell.c_str() && *end == '\0' && errno != ERANGE;
+}
+
+xmlNodePtr findChild(xmlNodePtr node, const char* name)
+{
+    for (xmlNodePtr child = node->children; child != NULL; child = child->next) {
+        if (child->type == XML_ELEMENT_NODE && xmlStrEqual(child->name, BAD_CAST name)) {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+std::string toXmlString(double value)
+{
+    std::ostringstream ss;
+    ss.precision(std::numeric_limits<double>::max_digits10);
+    ss << value;
+    return ss.str();
+}
+
+} // namespace
+
+bool JointTable::load(const std::string& filename, std::vector<std::string>& errors)
+{
+    std::ifstream stream(filename);
+    if (!stream) {
+        clear();
+        errors.push_back("Unable to open " + filename);
+        return false;
+    }
+    return load(stream, errors);
+}
+
+bool JointTable::load(std::istream& stream, std::vector<std::string>& errors)
+{
+    clear();
+    try {
+        return loadDocument(rapidcsv::Document(stream, rapidcsv::LabelParams(0, -1)), errors);
+    }
+    catch (const std::exception& e) {
+        clear();
+        errors.push_back(std::string("Unable to parse the csv: ") + e.what());
+        return false;
+    }
+}
+
+bool JointTable::loadDocument(const rapidcsv::Document& csv, std::vector<std::string>& errors)
+{
+    const std::size_t nr_of_errors = errors.size();
+
+    // The joint names are read as a plain column, so that duplicated rows can be reported
+    const auto column_names = csv.GetColumnNames();
+    if (column_names.empty() || trim(column_names[0]) != "joint_name") {
+        errors.push_back("The first column of the csv must be joint_name");
+        return false;
+    }
+
+    std::vector<std::pair<std::size_t, double JointParameters::*>> columns;
+    for (std::size_t c = 1; c < column_names.size(); c++) {
+        const auto column = joint_parameter_columns.find(trim(column_names[c]));
+        if (column == joint_parameter_columns.end()) {
+            errors.push_back("Unknown column " + column_names[c] + " in the csv");
+            continue;
+        }
+        columns.emplace_back(c, column->second);
+    }
+
+    const std::size_t nr_of_rows = csv.GetRowCount();
+    m_joint_names.reserve(nr_of_rows);
+    m_parameters.reserve(nr_of_rows);
+    m_indices.reserve(nr_of_rows);
+    for (std::size_t r = 0; r < nr_of_rows; r++) {
+        const std::string joint_name = trim(csv.GetCell<std::string>(0, r));
+        if (joint_name.empty()) {
+            errors.push_back("Row " + std::to_string(r + 1) + " of the csv has no joint name");
+            continue;
+        }
+        if (m_indices.find(joint_name) != m_indices.end()) {
+            errors.push_back("Joint " + joint_name + " appears more than once in the csv, only the first row is used");
+            continue;
+        }
+
+        JointParameters parameters;
+        bool valid = true;
+        for (const auto& column : columns) {
+            const std::string cell = trim(column.first < csv.GetColumnCount() ? csv.GetCell<std::string>(column.first, r) : "");
+            // An empty cell keeps the default value
+            if (cell.empty()) {
+                continue;
+            }
+            double value = 0.0;
+            if (!parseNumber(cell, value)) {
+                errors.push_back("The " + column_names[column.first] + " of " + joint_name + " is not a number: " + cell);
+                valid = false;
+                continue;
+            }
+            parameters.*column.second = value;
+        }
+        if (parameters.lower_limit > parameters.upper_limit) {
+            errors.push_back("The lower limit of " + joint_name + " is greater than its upper limit");
+            valid = false;
+        }
+        if (!valid) {
+            continue;
+        }
+
+        m_indices.insert(std::make_pair(joint_name, m_joint_names.size()));
+        m_joint_names.push_back(joint_name);
+        m_parameters.push_back(parameters);
+    }
+
+    return errors.size() == nr_of_errors;
+}
+
+const JointParameters* JointTable::find(const std::string& joint_name) const
+{
+    auto it = m_indices.find(joint_name);
+    return it == m_indices.end() ? nullptr : &m_parameters[it->second];
+}
+
+void JointTable::checkJoints(const std::vector<std::string>& joint_names, std::vector<std::string>& missing, std::vector<std::string>& extra) const
+{
+    std::unordered_set<std::string> model_joints(joint_names.begin(), joint_names.end());
+    for (const auto& joint_name : joint_names) {
+        if (m_indices.find(joint_name) == m_indices.end()) {
+            missing.push_back(joint_name);
+        }
+    }
+    for (const auto& joint_name : m_joint_names) {
+        if (model_joints.find(joint_name) == model_joints.end()) {
+            extra.push_back(joint_name);
+        }
+    }
+}
+
+bool JointTable::hasVelocityOrEffortLimits() const
+{
+    return std::any_of(m_parameters.begin(), m_parameters.end(), [](const JointParameters& parameters) {
+        return std::isfinite(parameters.velocity_limit) || std::isfinite(parameters.effort_limit);
+    });
+}
+
+void JointTable::clear()
+{
+    m_joint_names.clear();
+    m_parameters.clear();
+    m_indices.clear();
+}
+
+bool writeJointLimitsToUrdf(const std::string& filename, const JointTable& joint_table)
+{
+    xmlDocPtr doc = xmlReadFile(filename.c_str(), NULL, XML_PARSE_NOBLANKS);
+    if (doc == NULL) {
+        return false;
+    }
+
+    xmlNodePtr root_node = xmlDocGetRootElement(doc);
+    for (xmlNodePtr joint_node = root_node ? root_node->children : NULL; joint_node != NULL; joint_node = joint_node->next) {
+        if (joint_node->type != XML_ELEMENT_NODE || !xmlStrEqual(joint_node->name, BAD_CAST "joint")) {
+            continue;
+        }
+        xmlChar* joint_name = xmlGetProp(joint_node, BAD_CAST "name");
+        xmlChar* joint_type = xmlGetProp(joint_node, BAD_CAST "type");
+        const JointParameters* parameters = joint_name ? joint_table.find(reinterpret_cast<const char*>(joint_name)) : nullptr;
+        const bool moving = joint_type != NULL && !xmlStrEqual(joint_type, BAD_CAST "fixed");
+        xmlFree(joint_name);
+        xmlFree(joint_type);
+        if (parameters == nullptr || !moving) {
+            continue;
+        }
+        const bool has_velocity = parameters->velocity_limit < std::numeric_limits<double>::infinity();
+        const bool has_effort = parameters->effort_limit < std::numeric_limits<double>::infinity();
+        if (!has_velocity && !has_effort) {
+            continue;
+        }
+
+        xmlNodePtr limit_node = findChild(joint_node, "limit");
+        if (limit_node == NULL) {
+            limit_node = xmlNewChild(joint_node, NULL, BAD_CAST "limit", NULL);
+        }
+        if (has_velocity) {
+            xmlSetProp(limit_node, BAD_CAST "velocity", BAD_CAST toXmlString(parameters->velocity_limit).c_str());
+        }
+        if (has_effort) {
+            xmlSetProp(limit_node, BAD_CAST "effort", BAD_CAST toXmlString(parameters->effort_limit).c_str());
+        }
+    }
+
+    bool ok = xmlSaveFormatFileEnc(filename.c_str(), doc, "UTF-8", 1) >= 0;
+    xmlFreeDoc(doc);
+    return ok;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file LinkTable.cpp
+ * @brief Contains definitions for the LinkTable class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/LinkTable.h>
+
+#include <limits>
+
+namespace {
+
+using Column = Eigen::Map<Eigen::ArrayXd>;
+using ConstColumn = Eigen::Map<const Eigen::ArrayXd>;
+
+template <std::size_t N, class Vector>
+void append(std::array<std::vector<double>, N>& components, const Vector& values)
+{
+    for (std::size_t k = 0; k < N; k++) {
+        components[k].push_back(values(k));
+    }
+}
+
+template <std::size_t N>
+void resize(std::array<std::vector<double>, N>& components, std::size_t size)
+{
+    for (auto& component : components) {
+        component.resize(size);
+    }
+}
+
+} // namespace
+
+std::size_t LinkTable::add(const std::string& name, double creo_mass, const Eigen::Vector3d& creo_com, const Eigen::Matrix3d& creo_inertia,
+                           const Eigen::Matrix3d& csysPart_R_link, const Eigen::Vector3d& csysPart_p_link)
+{
+    const Eigen::Vector3d not_assigned = Eigen::Vector3d::Constant(std::numeric_limits<double>::quiet_NaN());
+    m_names.push_back(name);
+    m_creo_masses.push_back(creo_mass);
+    append(m_creo_coms, creo_com);
+    append(m_creo_inertias, Eigen::Map<const Eigen::Matrix<double, 9, 1>>(creo_inertia.data()));
+    append(m_rotations, Eigen::Map<const Eigen::Matrix<double, 9, 1>>(csysPart_R_link.data()));
+    append(m_positions, csysPart_p_link);
+    m_assigned_masses.push_back(std::numeric_limits<double>::quiet_NaN());
+    append(m_assigned_inertias, not_assigned);
+    return m_names.size() - 1;
+}
+
+void LinkTable::assignMass(std::size_t index, double mass)
+{
+    m_assigned_masses[index] = mass;
+}
+
+void LinkTable::assignInertia(std::size_t index, const std::array<double, 3>& diagonal)
+{
+    for (std::size_t k = 0; k < 3; k++) {
+        m_assigned_inertias[k][index] = diagonal[k];
+    }
+}
+
+void LinkTable::computeInertias(const std::array<double, 3>& scale)
+{
+    const Eigen::Index n = static_cast<Eigen::Index>(size());
+    m_masses.resize(n);
+    resize(m_coms, n);
+    resize(m_inertias, n);
+    m_consistent.resize(n);
+
+    auto in = [n](const std::vector<double>& component) { return ConstColumn(component.data(), n); };
+    auto out = [n](std::vector<double>& component) { return Column(component.data(), n); };
+    const auto& R = m_rotations;
+
+    // Every operation below runs on whole components, i.e. on contiguous arrays over all the links
+
+    // The COM returned by Creo is in the part csys, it is moved to the link frame: R^T * (s .* com - p)
+    std::array<Eigen::ArrayXd, 3> d;
+    for (int k = 0; k < 3; k++) {
+        d[k] = in(m_creo_coms[k]) * scale[k] - in(m_positions[k]);
+    }
+    for (int k = 0; k < 3; k++) {
+        out(m_coms[k]) = in(R[3 * k]) * d[0] + in(R[1 + 3 * k]) * d[1] + in(R[2 + 3 * k]) * d[2];
+    }
+
+    // The inertia is scaled and rotated to the link orientation: R^T * (S * I * S) * R
+    std::array<Eigen::ArrayXd, 9> I_R;
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            I_R[i + 3 * j] = in(m_creo_inertias[i]) * (scale[i] * scale[0]) * in(R[3 * j]) +
+                             in(m_creo_inertias[i + 3]) * (scale[i] * scale[1]) * in(R[1 + 3 * j]) +
+                             in(m_creo_inertias[i + 6]) * (scale[i] * scale[2]) * in(R[2 + 3 * j]);
+        }
+    }
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            out(m_inertias[i + 3 * j]) = in(R[3 * i]) * I_R[3 * j] + in(R[1 + 3 * i]) * I_R[1 + 3 * j] + in(R[2 + 3 * i]) * I_R[2 + 3 * j];
+        }
+    }
+
+    // The assigned inertias are diagonal and already in the link frame
+    const Eigen::Array<bool, Eigen::Dynamic, 1> has_assigned_inertia = in(m_assigned_inertias[0]) == in(m_assigned_inertias[0]);
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            if (i == j) {
+                out(m_inertias[i + 3 * j]) = has_assigned_inertia.select(in(m_assigned_inertias[i]), in(m_inertias[i + 3 * j]));
+            }
+            else {
+                out(m_inertias[i + 3 * j]) = has_assigned_inertia.select(0.0, in(m_inertias[i + 3 * j]));
+            }
+        }
+    }
+
+    const ConstColumn assigned_masses = in(m_assigned_masses);
+    out(m_masses) = (assigned_masses == assigned_masses).select(assigned_masses, in(m_creo_masses));
+
+    // The principal moments are non-negative and satisfy the triangle inequality if and only if
+    // J = tr(I) / 2 * 1 - I is positive semidefinite, i.e. all its principal minors are non-negative
+    const ConstColumn I00 = in(m_inertias[0]);
+    const ConstColumn I11 = in(m_inertias[4]);
+    const ConstColumn I22 = in(m_inertias[8]);
+    const Eigen::ArrayXd half_trace = 0.5 * (I00 + I11 + I22);
+    const Eigen::ArrayXd j00 = half_trace - I00;
+    const Eigen::ArrayXd j11 = half_trace - I11;
+    const Eigen::ArrayXd j22 = half_trace - I22;
+    const Eigen::ArrayXd j01 = -in(m_inertias[3]);
+    const Eigen::ArrayXd j02 = -in(m_inertias[6]);
+    const Eigen::ArrayXd j12 = -in(m_inertias[7]);
+    const Eigen::ArrayXd minor01 = j00 * j11 - j01 * j01;
+    const Eigen::ArrayXd minor02 = j00 * j22 - j02 * j02;
+    const Eigen::ArrayXd minor12 = j11 * j22 - j12 * j12;
+    const Eigen::ArrayXd determinant = j00 * minor12 - j01 * (j01 * j22 - j12 * j02) + j02 * (j01 * j12 - j11 * j02);
+    Eigen::Map<Eigen::Array<std::uint8_t, Eigen::Dynamic, 1>>(m_consistent.data(), n) =
+        (in(m_masses) > 0.0 && j00 >= 0.0 && j11 >= 0.0 && j22 >= 0.0 && minor01 >= 0.0 && minor02 >= 0.0 &&
+         minor12 >= 0.0 && determinant >= 0.0).cast<std::uint8_t>();
+}
+
+void LinkTable::clear()
+{
+    *this = LinkTable();
+}
+
+void LinkTable::reserve(std::size_t nr_of_links)
+{
+    m_names.reserve(nr_of_links);
+    m_creo_masses.reserve(nr_of_links);
+    m_assigned_masses.reserve(nr_of_links);
+    for (auto* components : { &m_creo_coms, &m_positions, &m_assigned_inertias }) {
+        for (auto& component : *components) {
+            component.reserve(nr_of_links);
+        }
+    }
+    for (auto* components : { &m_creo_inertias, &m_rotations }) {
+        for (auto& component : *components) {
+            component.reserve(nr_of_links);
+        }
+    }
+}
+
+Eigen::Vector3d LinkTable::getCenterOfMass(std::size_t index) const
+{
+    return { m_coms[0][index], m_coms[1][index], m_coms[2][index] };
+}
+
+Eigen::Matrix3d LinkTable::getInertia(std::size_t index) const
+{
+    Eigen::Matrix3d inertia;
+    for (int k = 0; k < 9; k++) {
+        inertia(k % 3, k / 3) = m_inertias[k][index];
+    }
+    return inertia;
+}
@@ -0,0 +1,293 @@
+/**
+ * @file Mesh.cpp
+ * @brief Contains definitions for reading the exported meshes and computing their properties.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/Mesh.h>
+
+#include <Eigen/Geometry>
+#include <Eigen/Eigenvalues>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t stl_header_size = 80;
+constexpr std::size_t stl_triangle_size = 50; // normal, 3 vertices and attribute byte count
+
+bool readBinarySTL(const std::vector<char>& buffer, TriangleMesh& mesh, const std::array<double, 3>& scale)
+{
+    std::uint32_t n_triangles{ 0 };
+    std::memcpy(&n_triangles, buffer.data() + stl_header_size, sizeof(n_triangles));
+    if (buffer.size() != stl_header_size + sizeof(n_triangles) + n_triangles * stl_triangle_size) {
+        return false;
+    }
+
+    mesh.v0.resize(3, n_triangles);
+    mesh.v1.resize(3, n_triangles);
+    mesh.v2.resize(3, n_triangles);
+
+    const char* triangle = buffer.data() + stl_header_size + sizeof(n_triangles);
+    for (std::uint32_t t = 0; t < n_triangles; t++, triangle += stl_triangle_size) {
+        float coordinates[9];
+        // Skip the normal, it is recomputed from the vertices
+        std::memcpy(coordinates, triangle + 3 * sizeof(float), sizeof(coordinates));
+        for (int i = 0; i < 3; i++) {
+            mesh.v0(i, t) = coordinates[i] * scale[i];
+            mesh.v1(i, t) = coordinates[3 + i] * scale[i];
+            mesh.v2(i, t) = coordinates[6 + i] * scale[i];
+        }
+    }
+    return true;
+}
+
+bool readAsciiSTL(const std::vector<char>& buffer, TriangleMesh& mesh, const std::array<double, 3>& scale)
+{
+    std::istringstream stream(std::string(buffer.begin(), buffer.end()));
+    std::vector<double> vertices;
+    std::string token;
+    while (stream >> token) {
+        if (token != "vertex") {
+            continue;
+        }
+        for (int i = 0; i < 3; i++) {
+            double coordinate{ 0.0 };
+            if (!(stream >> coordinate)) {
+                return false;
+            }
+            vertices.push_back(coordinate * scale[i]);
+        }
+    }
+
+    if (vertices.size() % 9 != 0) {
+        return false;
+    }
+
+    const Eigen::Index n_triangles = vertices.size() / 9;
+    Eigen::Map<const Eigen::Matrix<double, 9, Eigen::Dynamic>> triangles(vertices.data(), 9, n_triangles);
+    mesh.v0 = triangles.topRows<3>();
+    mesh.v1 = triangles.middleRows<3>(3);
+    mesh.v2 = triangles.bottomRows<3>();
+    return true;
+}
+
+} // namespace
+
+bool readSTL(const std::string& filename, TriangleMesh& mesh, const std::array<double, 3>& scale)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // A binary STL is recognized by its size, since an ascii one may start with "solid" as well
+    if (buffer.size() >= stl_header_size + sizeof(std::uint32_t) && readBinarySTL(buffer, mesh, scale)) {
+        return true;
+    }
+    return readAsciiSTL(buffer, mesh, scale);
+}
+
+bool writeSTL(const std::string& filename, const TriangleMesh& mesh, bool binary, const std::array<double, 3>& scale)
+{
+    std::ofstream file(filename, binary ? std::ios::binary : std::ios::out);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const Eigen::Vector3d inverse_scale(1.0 / scale[0], 1.0 / scale[1], 1.0 / scale[2]);
+    auto normal = [&mesh](Eigen::Index t) {
+        return (mesh.v1.col(t) - mesh.v0.col(t)).cross(mesh.v2.col(t) - mesh.v0.col(t)).normalized().eval();
+    };
+
+    if (!binary) {
+        file.precision(9);
+        file << "solid creo2urdf\n";
+        for (Eigen::Index t = 0; t < mesh.size(); t++) {
+            const Eigen::Vector3d n = normal(t);
+            file << "facet normal " << n(0) << " " << n(1) << " " << n(2) << "\nouter loop\n";
+            for (const auto* vertices : { &mesh.v0, &mesh.v1, &mesh.v2 }) {
+                const Eigen::Vector3d v = vertices->col(t).cwiseProduct(inverse_scale);
+                file << "vertex " << v(0) << " " << v(1) << " " << v(2) << "\n";
+            }
+            file << "endloop\nendfacet\n";
+        }
+        file << "endsolid creo2urdf\n";
+        return static_cast<bool>(file);
+    }
+
+    char header[stl_header_size] = "creo2urdf";
+    file.write(header, stl_header_size);
+    const std::uint32_t n_triangles = static_cast<std::uint32_t>(mesh.size());
+    file.write(reinterpret_cast<const char*>(&n_triangles), sizeof(n_triangles));
+    for (Eigen::Index t = 0; t < mesh.size(); t++) {
+        char triangle[stl_triangle_size] = {};
+        float coordinates[12];
+        const Eigen::Vector3d n = normal(t);
+        for (int i = 0; i < 3; i++) {
+            coordinates[i] = static_cast<float>(n(i));
+            coordinates[3 + i] = static_cast<float>(mesh.v0(i, t) * inverse_scale(i));
+            coordinates[6 + i] = static_cast<float>(mesh.v1(i, t) * inverse_scale(i));
+            coordinates[9 + i] = static_cast<float>(mesh.v2(i, t) * inverse_scale(i));
+        }
+        std::memcpy(triangle, coordinates, sizeof(coordinates));
+        file.write(triangle, stl_triangle_size);
+    }
+    return static_cast<bool>(file);
+}
+
+MeshMassProperties computeMeshMassProperties(const TriangleMesh& mesh)
+{
+    MeshMassProperties properties;
+    if (mesh.size() == 0) {
+        return properties;
+    }
+
+    // Each row holds one coordinate of the vertices of all the triangles
+    const Eigen::ArrayXXd a = mesh.v0.array();
+    const Eigen::ArrayXXd b = mesh.v1.array();
+    const Eigen::ArrayXXd c = mesh.v2.array();
+
+    Eigen::Matrix3Xd d(3, mesh.size());
+    for (Eigen::Index t = 0; t < mesh.size(); t++) {
+        d.col(t) = (mesh.v1.col(t) - mesh.v0.col(t)).cross(mesh.v2.col(t) - mesh.v0.col(t));
+    }
+
+    // Subexpressions of Eberly's algorithm, for the three coordinates at once
+    const Eigen::ArrayXXd w0 = a + b;
+    const Eigen::ArrayXXd f1 = w0 + c;
+    const Eigen::ArrayXXd temp0 = a * a;
+    const Eigen::ArrayXXd temp1 = temp0 + b * w0;
+    const Eigen::ArrayXXd f2 = temp1 + c * f1;
+    const Eigen::ArrayXXd f3 = a * temp0 + b * temp1 + c * f2;
+    const Eigen::ArrayXXd g0 = f2 + a * (f1 + a);
+    const Eigen::ArrayXXd g1 = f2 + b * (f1 + b);
+    const Eigen::ArrayXXd g2 = f2 + c * (f1 + c);
+
+    const Eigen::ArrayXXd n = d.array();
+    const double integral_1 = (n.row(0) * f1.row(0)).sum() / 6.0;
+    const Eigen::Vector3d integral_x = ((n * f2).rowwise().sum() / 24.0).matrix();
+    const Eigen::Vector3d integral_x2 = ((n * f3).rowwise().sum() / 60.0).matrix();
+    const double integral_xy = (n.row(0) * (a.row(1) * g0.row(0) + b.row(1) * g1.row(0) + c.row(1) * g2.row(0))).sum() / 120.0;
+    const double integral_yz = (n.row(1) * (a.row(2) * g0.row(1) + b.row(2) * g1.row(1) + c.row(2) * g2.row(1))).sum() / 120.0;
+    const double integral_zx = (n.row(2) * (a.row(0) * g0.row(2) + b.row(0) * g1.row(2) + c.row(0) * g2.row(2))).sum() / 120.0;
+
+    properties.volume = integral_1;
+
+    // For a closed mesh the area vectors of the triangles sum to zero
+    const double total_area = d.colwise().norm().sum();
+    properties.closed = integral_1 > 0.0 && d.rowwise().sum().norm() <= 1e-6 * total_area;
+
+    if (integral_1 <= 0.0) {
+        return properties;
+    }
+
+    const Eigen::Vector3d com = integral_x / integral_1;
+    properties.com = com;
+
+    Eigen::Matrix3d& I = properties.inertia;
+    I(0, 0) = integral_x2(1) + integral_x2(2) - integral_1 * (com(1) * com(1) + com(2) * com(2));
+    I(1, 1) = integral_x2(2) + integral_x2(0) - integral_1 * (com(2) * com(2) + com(0) * com(0));
+    I(2, 2) = integral_x2(0) + integral_x2(1) - integral_1 * (com(0) * com(0) + com(1) * com(1));
+    I(0, 1) = I(1, 0) = -(integral_xy - integral_1 * com(0) * com(1));
+    I(1, 2) = I(2, 1) = -(integral_yz - integral_1 * com(1) * com(2));
+    I(0, 2) = I(2, 0) = -(integral_zx - integral_1 * com(2) * com(0));
+
+    return properties;
+}
+
+OrientedBox computeOrientedBox(const TriangleMesh& mesh)
+{
+    OrientedBox box;
+    if (mesh.size() == 0) {
+        return box;
+    }
+
+    Eigen::Matrix3Xd vertices(3, 3 * mesh.size());
+    vertices << mesh.v0, mesh.v1, mesh.v2;
+
+    // Covariance of the surface, so that it does not depend on how the vertices are distributed
+    // (see S. Gottschalk, M. C. Lin, D. Manocha, "OBBTree: A Hierarchical Structure for Rapid Interference Detection")
+    const Eigen::Matrix3Xd centroids = (mesh.v0 + mesh.v1 + mesh.v2) / 3.0;
+    Eigen::RowVectorXd areas(mesh.size());
+    for (Eigen::Index t = 0; t < mesh.size(); t++) {
+        areas(t) = 0.5 * (mesh.v1.col(t) - mesh.v0.col(t)).cross(mesh.v2.col(t) - mesh.v0.col(t)).norm();
+    }
+    const double total_area = areas.sum();
+
+    Eigen::Matrix3d covariance = Eigen::Matrix3d::Identity();
+    if (total_area > 0.0) {
+        const Eigen::Vector3d mean = centroids * areas.transpose() / total_area;
+        const Eigen::Matrix3Xd weighted_centroids = centroids.array().rowwise() * areas.array();
+        covariance = (9.0 * weighted_centroids * centroids.transpose()
+                      + (mesh.v0.array().rowwise() * areas.array()).matrix() * mesh.v0.transpose()
+                      + (mesh.v1.array().rowwise() * areas.array()).matrix() * mesh.v1.transpose()
+                      + (mesh.v2.array().rowwise() * areas.array()).matrix() * mesh.v2.transpose()) / (12.0 * total_area)
+                     - mean * mean.transpose();
+    }
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(covariance);
+
+    // The principal directions are not unique for symmetric shapes, so the box aligned with
+    // the frame of the mesh is used when it is smaller
+    OrientedBox candidates[2];
+    candidates[0].axes = solver.eigenvectors();
+    candidates[1].axes = Eigen::Matrix3d::Identity();
+    for (auto& candidate : candidates) {
+        const Eigen::Matrix3Xd projected = candidate.axes.transpose() * vertices;
+        const Eigen::Vector3d min_corner = projected.rowwise().minCoeff();
+        const Eigen::Vector3d max_corner = projected.rowwise().maxCoeff();
+        candidate.half_extents = 0.5 * (max_corner - min_corner);
+        candidate.center = candidate.axes * (0.5 * (max_corner + min_corner));
+    }
+    box = (candidates[0].half_extents.prod() < candidates[1].half_extents.prod()) ? candidates[0] : candidates[1];
+
+    return box;
+}
+
+bool overlaps(const OrientedBox& a, const OrientedBox& b)
+{
+    // See S. Gottschalk, M. C. Lin, D. Manocha, "OBBTree: A Hierarchical Structure for Rapid Interference Detection"
+    const double epsilon = 1e-12;
+    const Eigen::Matrix3d R = a.axes.transpose() * b.axes;
+    const Eigen::Matrix3d abs_R = R.cwiseAbs().array() + epsilon;
+    const Eigen::Vector3d t = a.axes.transpose() * (b.center - a.center);
+    const Eigen::Vector3d& ea = a.half_extents;
+    const Eigen::Vector3d& eb = b.half_extents;
+
+    // Axes of a
+    for (int i = 0; i < 3; i++) {
+        if (std::abs(t(i)) > ea(i) + abs_R.row(i).dot(eb)) {
+            return false;
+        }
+    }
+    // Axes of b
+    for (int j = 0; j < 3; j++) {
+        if (std::abs(t.dot(R.col(j))) > ea.dot(abs_R.col(j)) + eb(j)) {
+            return false;
+        }
+    }
+    // Cross products of the axes
+    for (int i = 0; i < 3; i++) {
+        const int i1 = (i + 1) % 3;
+        const int i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            const int j1 = (j + 1) % 3;
+            const int j2 = (j + 2) % 3;
+            const double ra = ea(i1) * abs_R(i2, j) + ea(i2) * abs_R(i1, j);
+            const double rb = eb(j1) * abs_R(i, j2) + eb(j2) * abs_R(i, j1);
+            if (std::abs(t(i2) * R(i1, j) - t(i1) * R(i2, j)) > ra + rb) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
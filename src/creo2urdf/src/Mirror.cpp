@@ -0,0 +1,170 @@
+/**
+ * @file Mirror.cpp
+ * @brief Contains definitions for detecting mirrored parts and deriving their meshes.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/Mirror.h>
+
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+std::vector<double> pairwiseDistances(const std::vector<Eigen::Vector3d>& points)
+{
+    std::vector<double> distances;
+    for (std::size_t i = 0; i < points.size(); i++) {
+        for (std::size_t j = i + 1; j < points.size(); j++) {
+            distances.push_back((points[i] - points[j]).norm());
+        }
+    }
+    std::sort(distances.begin(), distances.end());
+    return distances;
+}
+
+/**
+ * @brief Checks whether the points span a plane, so that they determine a reflection mapping them.
+ */
+bool spansPlane(const std::vector<Eigen::Vector3d>& points, double length_tolerance)
+{
+    for (std::size_t i = 1; i < points.size(); i++) {
+        const Eigen::Vector3d first = points[i] - points[0];
+        for (std::size_t j = i + 1; j < points.size(); j++) {
+            const Eigen::Vector3d second = points[j] - points[0];
+            if (first.cross(second).norm() > length_tolerance * std::max(first.norm(), second.norm())) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Largest distance from a transformed source datum to the closest target datum.
+ */
+double datumMismatch(const std::vector<Eigen::Vector3d>& source, const std::vector<Eigen::Vector3d>& target, const MirrorTransform& transform)
+{
+    double mismatch = 0.0;
+    for (const auto& origin : source) {
+        const Eigen::Vector3d mirrored = transform.reflection * origin + transform.translation;
+        double closest = std::numeric_limits<double>::infinity();
+        for (const auto& target_origin : target) {
+            closest = std::min(closest, (mirrored - target_origin).norm());
+        }
+        mismatch = std::max(mismatch, closest);
+    }
+    return mismatch;
+}
+
+} // namespace
+
+std::vector<MirrorTransform> findMirrorTransforms(const MirrorSignature& source, const MirrorSignature& target, double tolerance)
+{
+    std::vector<MirrorTransform> transforms;
+    if (source.volume <= 0.0 || std::abs(source.volume - target.volume) > tolerance * source.volume) {
+        return transforms;
+    }
+
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> source_solver(source.gyration);
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> target_solver(target.gyration);
+    const Eigen::Vector3d& source_moments = source_solver.eigenvalues();
+    const double moment_tolerance = tolerance * source_moments.maxCoeff();
+    if ((source_moments - target_solver.eigenvalues()).cwiseAbs().maxCoeff() > moment_tolerance) {
+        return transforms;
+    }
+    // With two equal moments the principal axes, and therefore the reflection, are not unique
+    if (source_moments(1) - source_moments(0) <= moment_tolerance || source_moments(2) - source_moments(1) <= moment_tolerance) {
+        return transforms;
+    }
+
+    // The datum layout is compared through the distances between the origins, which do not depend on the frame
+    const double length_tolerance = tolerance * std::max(source.outline.half_extents.norm(), std::sqrt(source_moments.sum()));
+    if (source.datum_origins.size() != target.datum_origins.size()) {
+        return transforms;
+    }
+    // With fewer than three non collinear datums several reflections match them, and the mesh cannot tell which one is right
+    if (!spansPlane(source.datum_origins, length_tolerance)) {
+        return transforms;
+    }
+    const auto source_distances = pairwiseDistances(source.datum_origins);
+    const auto target_distances = pairwiseDistances(target.datum_origins);
+    for (std::size_t i = 0; i < source_distances.size(); i++) {
+        if (std::abs(source_distances[i] - target_distances[i]) > length_tolerance) {
+            return transforms;
+        }
+    }
+
+    // The reflection maps the principal axes of the source onto the ones of the target, up to their signs
+    std::vector<std::pair<double, MirrorTransform>> candidates;
+    for (int signs = 0; signs < 8; signs++) {
+        const Eigen::Vector3d s((signs & 1) ? -1.0 : 1.0, (signs & 2) ? -1.0 : 1.0, (signs & 4) ? -1.0 : 1.0);
+        MirrorTransform transform;
+        transform.reflection = target_solver.eigenvectors() * s.asDiagonal() * source_solver.eigenvectors().transpose();
+        if (transform.reflection.determinant() > 0.0) {
+            continue;
+        }
+        transform.translation = target.com - transform.reflection * source.com;
+        const double mismatch = datumMismatch(source.datum_origins, target.datum_origins, transform);
+        if (mismatch <= length_tolerance) {
+            candidates.emplace_back(mismatch, transform);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<double, MirrorTransform>& a, const std::pair<double, MirrorTransform>& b) { return a.first < b.first; });
+    for (const auto& candidate : candidates) {
+        transforms.push_back(candidate.second);
+    }
+    return transforms;
+}
+
+TriangleMesh mirrorMesh(const TriangleMesh& mesh, const MirrorTransform& transform)
+{
+    // A reflection flips the orientation, so two vertices are swapped
+    TriangleMesh mirrored;
+    mirrored.v0 = (transform.reflection * mesh.v0).colwise() + transform.translation;
+    mirrored.v1 = (transform.reflection * mesh.v2).colwise() + transform.translation;
+    mirrored.v2 = (transform.reflection * mesh.v1).colwise() + transform.translation;
+    return mirrored;
+}
+
+bool confirmMirroredMesh(const TriangleMesh& mesh, const MirrorSignature& target, double tolerance)
+{
+    if (mesh.size() == 0) {
+        return false;
+    }
+
+    // Vertices in the frame of the outline, whose extent has to match the outline
+    const Eigen::Matrix3d& axes = target.outline.axes;
+    Eigen::Vector3d min_corner = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+    Eigen::Vector3d max_corner = -min_corner;
+    for (const auto* vertices : { &mesh.v0, &mesh.v1, &mesh.v2 }) {
+        const Eigen::Matrix3Xd local = axes.transpose() * (vertices->colwise() - target.outline.center);
+        min_corner = min_corner.cwiseMin(local.rowwise().minCoeff());
+        max_corner = max_corner.cwiseMax(local.rowwise().maxCoeff());
+    }
+
+    const double length_tolerance = tolerance * target.outline.half_extents.norm();
+    if ((min_corner + target.outline.half_extents).cwiseAbs().maxCoeff() > length_tolerance ||
+        (max_corner - target.outline.half_extents).cwiseAbs().maxCoeff() > length_tolerance) {
+        return false;
+    }
+
+    // The solid enclosed by the mesh has to match the volume, the centroid and the moments of the part about the outline axes
+    const auto properties = computeMeshMassProperties(mesh);
+    if (!properties.closed || std::abs(properties.volume - target.volume) > tolerance * target.volume ||
+        (axes.transpose() * (properties.com - target.com)).cwiseAbs().maxCoeff() > length_tolerance) {
+        return false;
+    }
+    const Eigen::Matrix3d mesh_moments = axes.transpose() * (properties.inertia / properties.volume) * axes;
+    const Eigen::Matrix3d target_moments = axes.transpose() * target.gyration * axes;
+    return (mesh_moments - target_moments).cwiseAbs().maxCoeff() <= tolerance * target_moments.trace();
+}
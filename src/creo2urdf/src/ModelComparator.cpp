@@ -0,0 +1,353 @@
+/**
+ * @file ModelComparator.cpp
+ * @brief Contains definitions for the ModelComparator class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/ModelComparator.h>
+
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/Model/RevoluteJoint.h>
+#include <iDynTree/Model/PrismaticJoint.h>
+#include <iDynTree/Model/FixedJoint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+
+double rotationAngle(const iDynTree::Rotation& a, const iDynTree::Rotation& b)
+{
+    Eigen::Matrix3d R = iDynTree::toEigen(a).transpose() * iDynTree::toEigen(b);
+    Eigen::Vector3d skew(R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1));
+    return std::atan2(0.5 * skew.norm(), 0.5 * (R.trace() - 1.0));
+}
+
+std::string toString(const Eigen::Vector3d& v)
+{
+    std::ostringstream ss;
+    ss.precision(9);
+    ss << v(0) << " " << v(1) << " " << v(2);
+    return ss.str();
+}
+
+} // namespace
+
+bool ModelComparator::canonicalise(const iDynTree::Model& model, const std::string& base_link, CanonicalModel& canonical)
+{
+    canonical = CanonicalModel();
+
+    auto base_index = model.getLinkIndex(base_link);
+    if (base_index == iDynTree::LINK_INVALID_INDEX) {
+        return false;
+    }
+
+    iDynTree::KinDynComputations kinDyn;
+    if (!kinDyn.loadRobotModel(model) || !kinDyn.setFloatingBase(base_link)) {
+        return false;
+    }
+    // The default state of KinDynComputations has all the joints in 0 and the base in the origin
+
+    canonical.links.reserve(model.getNrOfLinks());
+    for (iDynTree::LinkIndex l = 0; l < static_cast<iDynTree::LinkIndex>(model.getNrOfLinks()); l++) {
+        CanonicalModel::Link link;
+        link.base_H_link = kinDyn.getWorldTransform(l);
+
+        const auto& inertia = model.getLink(l)->getInertia();
+        const Eigen::Matrix3d R = iDynTree::toEigen(link.base_H_link.getRotation());
+        link.mass = inertia.getMass();
+        link.com = iDynTree::toEigen((link.base_H_link * inertia.getCenterOfMass()));
+        link.inertia = R * iDynTree::toEigen(inertia.getRotationalInertiaWrtCenterOfMass()) * R.transpose();
+
+        canonical.links.emplace(model.getLinkName(l), link);
+    }
+
+    canonical.joints.reserve(model.getNrOfJoints());
+    for (iDynTree::JointIndex j = 0; j < static_cast<iDynTree::JointIndex>(model.getNrOfJoints()); j++) {
+        const auto joint_ptr = model.getJoint(j);
+        CanonicalModel::Joint joint;
+        const auto parent_index = joint_ptr->getFirstAttachedLink();
+        const auto child_index = joint_ptr->getSecondAttachedLink();
+        joint.parent = model.getLinkName(parent_index);
+        joint.child = model.getLinkName(child_index);
+
+        iDynTree::Axis axis;
+        bool has_axis = true;
+        if (auto revolute = dynamic_cast<const iDynTree::RevoluteJoint*>(joint_ptr)) {
+            joint.type = "revolute";
+            axis = revolute->getAxis(child_index, parent_index);
+        }
+        else if (auto prismatic = dynamic_cast<const iDynTree::PrismaticJoint*>(joint_ptr)) {
+            joint.type = "prismatic";
+            axis = prismatic->getAxis(child_index, parent_index);
+        }
+        else {
+            joint.type = dynamic_cast<const iDynTree::FixedJoint*>(joint_ptr) ? "fixed" : "other";
+            has_axis = false;
+        }
+
+        if (has_axis) {
+            // The axis is expressed in the child link frame
+            const auto base_axis = canonical.links.at(joint.child).base_H_link * axis;
+            joint.axis_direction = iDynTree::toEigen(base_axis.getDirection());
+            joint.axis_point = iDynTree::toEigen(base_axis.getOrigin());
+        }
+
+        if (joint_ptr->getNrOfDOFs() == 1) {
+            joint.has_limits = joint_ptr->hasPosLimits();
+            if (joint.has_limits) {
+                joint_ptr->getPosLimits(0, joint.min, joint.max);
+            }
+            joint.damping = joint_ptr->getDamping(0);
+            joint.friction = joint_ptr->getStaticFriction(0);
+        }
+
+        canonical.joints.emplace(model.getJointName(j), joint);
+    }
+
+    for (iDynTree::FrameIndex f = model.getNrOfLinks(); f < static_cast<iDynTree::FrameIndex>(model.getNrOfFrames()); f++) {
+        canonical.frames.emplace(model.getFrameName(f),
+                                 std::make_pair(model.getLinkName(model.getFrameLink(f)), kinDyn.getWorldTransform(f)));
+    }
+
+    return true;
+}
+
+bool ModelComparator::compare(const iDynTree::Model& reference, const iDynTree::Model& loaded, const std::string& base_link)
+{
+    const std::size_t initial_differences = m_differences.size();
+
+    CanonicalModel ref, other;
+    if (!canonicalise(reference, base_link, ref)) {
+        m_differences.push_back("base link " + base_link + " is not in the exported model");
+        return false;
+    }
+    if (!canonicalise(loaded, base_link, other)) {
+        m_differences.push_back("base link " + base_link + " is not in the reloaded model");
+        return false;
+    }
+
+    // The size of the model is used as scale for the tolerances of the positions
+    double length_scale = 0.0;
+    for (const auto& link : ref.links) {
+        length_scale = std::max(length_scale, iDynTree::toEigen(link.second.base_H_link.getPosition()).norm());
+    }
+
+    for (const auto& link : ref.links) {
+        const auto& name = link.first;
+        const auto it = other.links.find(name);
+        if (it == other.links.end()) {
+            m_differences.push_back("link " + name + " is missing in the reloaded model");
+            continue;
+        }
+        const auto& a = link.second;
+        const auto& b = it->second;
+
+        checkScalar(a.mass, b.mass, "link " + name + " mass");
+
+        const double com_error = (a.com - b.com).norm();
+        if (com_error > m_options.absolute_tolerance + m_options.relative_tolerance * length_scale) {
+            m_differences.push_back("link " + name + " center of mass " + toString(a.com) + " vs " + toString(b.com));
+        }
+
+        const double inertia_error = (a.inertia - b.inertia).cwiseAbs().maxCoeff();
+        const double inertia_scale = std::max(a.inertia.cwiseAbs().maxCoeff(), b.inertia.cwiseAbs().maxCoeff());
+        if (inertia_error > m_options.inertia_tolerance + m_options.relative_tolerance * inertia_scale) {
+            std::ostringstream ss;
+            ss << "link " << name << " rotational inertia differs by " << inertia_error << " kg m^2";
+            m_differences.push_back(ss.str());
+        }
+    }
+
+    for (const auto& link : other.links) {
+        if (ref.links.find(link.first) == ref.links.end()) {
+            m_differences.push_back("link " + link.first + " is not in the exported model");
+        }
+    }
+
+    for (const auto& joint : ref.joints) {
+        const auto& name = joint.first;
+        const auto it = other.joints.find(name);
+        if (it == other.joints.end()) {
+            m_differences.push_back("joint " + name + " is missing in the reloaded model");
+            continue;
+        }
+        const auto& a = joint.second;
+        auto b = it->second;
+
+        // The exporter may invert a joint if the base link is not the one of the in-memory model
+        if (a.parent == b.child && a.child == b.parent) {
+            std::swap(b.parent, b.child);
+            b.axis_direction = -b.axis_direction;
+            std::swap(b.min, b.max);
+            b.min = -b.min;
+            b.max = -b.max;
+        }
+
+        if (a.parent != b.parent || a.child != b.child) {
+            m_differences.push_back("joint " + name + " connects " + a.parent + " and " + a.child +
+                                    " in the exported model, " + b.parent + " and " + b.child + " in the reloaded one");
+            continue;
+        }
+
+        if (a.type != b.type) {
+            m_differences.push_back("joint " + name + " is " + a.type + " in the exported model, " + b.type + " in the reloaded one");
+            continue;
+        }
+
+        if (a.type == "revolute" || a.type == "prismatic") {
+            const double cos_angle = std::max(-1.0, std::min(1.0, a.axis_direction.dot(b.axis_direction)));
+            if (std::acos(cos_angle) > m_options.angle_tolerance) {
+                m_differences.push_back("joint " + name + " axis direction " + toString(a.axis_direction) + " vs " + toString(b.axis_direction));
+            }
+            // For revolute joints the axis is a line, for prismatic joints only the direction matters
+            if (a.type == "revolute") {
+                const double distance = (b.axis_point - a.axis_point).cross(a.axis_direction).norm();
+                if (distance > m_options.absolute_tolerance + m_options.relative_tolerance * length_scale) {
+                    m_differences.push_back("joint " + name + " axis is displaced by " + std::to_string(distance) + " m");
+                }
+            }
+        }
+
+        if (a.has_limits != b.has_limits) {
+            m_differences.push_back("joint " + name + " position limits are " + (a.has_limits ? "enabled" : "disabled") +
+                                    " in the exported model only");
+        }
+        else if (a.has_limits) {
+            checkScalar(a.min, b.min, "joint " + name + " lower limit");
+            checkScalar(a.max, b.max, "joint " + name + " upper limit");
+        }
+        checkScalar(a.damping, b.damping, "joint " + name + " damping");
+        checkScalar(a.friction, b.friction, "joint " + name + " friction");
+    }
+
+    for (const auto& joint : other.joints) {
+        if (ref.joints.find(joint.first) == ref.joints.end()) {
+            m_differences.push_back("joint " + joint.first + " is not in the exported model");
+        }
+    }
+
+    for (const auto& frame : ref.frames) {
+        const auto& name = frame.first;
+        const auto it = other.frames.find(name);
+        if (it == other.frames.end()) {
+            m_differences.push_back("frame " + name + " is missing in the reloaded model");
+            continue;
+        }
+        if (frame.second.first != it->second.first) {
+            m_differences.push_back("frame " + name + " is attached to " + frame.second.first + " in the exported model, " +
+                                    it->second.first + " in the reloaded one");
+        }
+        checkPose(frame.second.second, it->second.second, length_scale, "frame " + name);
+    }
+
+    return m_differences.size() == initial_differences;
+}
+
+bool ModelComparator::compareSensors(const std::vector<SensorReference>& expected, const iDynTree::Model& loaded,
+                                     const iDynTree::Model& reference, const std::string& base_link)
+{
+    const std::size_t initial_differences = m_differences.size();
+
+    CanonicalModel ref, other;
+    if (!canonicalise(reference, base_link, ref) || !canonicalise(loaded, base_link, other)) {
+        m_differences.push_back("base link " + base_link + " is not in the model, the sensors cannot be compared");
+        return false;
+    }
+
+    double length_scale = 0.0;
+    for (const auto& link : ref.links) {
+        length_scale = std::max(length_scale, iDynTree::toEigen(link.second.base_H_link.getPosition()).norm());
+    }
+
+    const auto& sensors = loaded.sensors();
+    // Only the sensor types parsed by the iDynTree URDF loader can be compared
+    std::unordered_map<std::string, const iDynTree::Sensor*> loaded_sensors;
+    for (auto type : { iDynTree::ACCELEROMETER, iDynTree::GYROSCOPE, iDynTree::SIX_AXIS_FORCE_TORQUE }) {
+        for (std::size_t s = 0; s < sensors.getNrOfSensors(type); s++) {
+            const auto sensor = sensors.getSensor(type, s);
+            loaded_sensors.emplace(sensor->getName(), sensor);
+        }
+    }
+
+    std::unordered_set<std::string> found;
+    for (const auto& sensor : expected) {
+        const auto it = loaded_sensors.find(sensor.name);
+        if (it == loaded_sensors.end()) {
+            m_differences.push_back("sensor " + sensor.name + " is missing in the reloaded model");
+            continue;
+        }
+        found.insert(sensor.name);
+
+        if (sensor.is_joint_sensor) {
+            const auto joint_sensor = dynamic_cast<const iDynTree::JointSensor*>(it->second);
+            if (!joint_sensor || joint_sensor->getParentJoint() != sensor.parent) {
+                m_differences.push_back("sensor " + sensor.name + " is not attached to joint " + sensor.parent);
+            }
+            continue;
+        }
+
+        const auto link_sensor = dynamic_cast<const iDynTree::LinkSensor*>(it->second);
+        if (!link_sensor) {
+            m_differences.push_back("sensor " + sensor.name + " is not attached to a link in the reloaded model");
+            continue;
+        }
+        const auto ref_link = ref.links.find(sensor.parent);
+        const auto other_link = other.links.find(link_sensor->getParentLink());
+        if (ref_link == ref.links.end() || other_link == other.links.end()) {
+            m_differences.push_back("sensor " + sensor.name + " is attached to " + link_sensor->getParentLink() + " instead of " + sensor.parent);
+            continue;
+        }
+        checkPose(ref_link->second.base_H_link * sensor.parentLink_H_sensor,
+                  other_link->second.base_H_link * link_sensor->getLinkSensorTransform(),
+                  length_scale, "sensor " + sensor.name);
+    }
+
+    for (const auto& sensor : loaded_sensors) {
+        if (found.find(sensor.first) == found.end()) {
+            m_differences.push_back("sensor " + sensor.first + " is not expected in the reloaded model");
+        }
+    }
+
+    return m_differences.size() == initial_differences;
+}
+
+bool ModelComparator::checkScalar(double reference, double loaded, const std::string& description)
+{
+    if (std::isinf(reference) || std::isinf(loaded)) {
+        if (reference == loaded) {
+            return true;
+        }
+    }
+    else if (std::abs(reference - loaded) <= m_options.absolute_tolerance + m_options.relative_tolerance * std::max(std::abs(reference), std::abs(loaded))) {
+        return true;
+    }
+
+    std::ostringstream ss;
+    ss.precision(9);
+    ss << description << " " << reference << " vs " << loaded;
+    m_differences.push_back(ss.str());
+    return false;
+}
+
+bool ModelComparator::checkPose(const iDynTree::Transform& reference, const iDynTree::Transform& loaded, double length_scale, const std::string& description)
+{
+    bool ok = true;
+    const double position_error = (iDynTree::toEigen(reference.getPosition()) - iDynTree::toEigen(loaded.getPosition())).norm();
+    if (position_error > m_options.absolute_tolerance + m_options.relative_tolerance * length_scale) {
+        m_differences.push_back(description + " position differs by " + std::to_string(position_error) + " m");
+        ok = false;
+    }
+    const double rotation_error = rotationAngle(reference.getRotation(), loaded.getRotation());
+    if (rotation_error > m_options.angle_tolerance) {
+        m_differences.push_back(description + " orientation differs by " + std::to_string(rotation_error) + " rad");
+        ok = false;
+    }
+    return ok;
+}
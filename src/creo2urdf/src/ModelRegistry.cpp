@@ -0,0 +1,144 @@
+/**
+ * @file ModelRegistry.cpp
+ * @brief Contains definitions for the ModelRegistry class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/ModelRegistry.h>
+
+#include <pfcExceptions.h>
+
+namespace {
+
+/**
+ * @brief Calls answered by a record found in the registry: RetrieveModel, GetFullName, GetType and GetIsSkeleton.
+ */
+constexpr std::size_t calls_per_record = 4;
+
+} // namespace
+
+ModelRecord* ModelRegistry::retrieve(pfcSession_ptr session, pfcModelDescriptor_ptr descriptor)
+{
+    const std::string key = std::string(descriptor->GetFullName()) + "." + std::to_string(static_cast<int>(descriptor->GetType()));
+    m_statistics.lookups++;
+
+    auto record = m_records.find(key);
+    if (record != m_records.end() && record->second.handle) {
+        m_statistics.saved_calls += calls_per_record;
+        return &record->second;
+    }
+
+    ModelRecord new_record;
+    try {
+        new_record.handle = session->RetrieveModel(descriptor);
+        if (new_record.handle == nullptr) {
+            return nullptr;
+        }
+        new_record.full_name = std::string(new_record.handle->GetFullName());
+        new_record.type = new_record.handle->GetType();
+        new_record.is_skeleton = (new_record.type == pfcMDL_PART || new_record.type == pfcMDL_ASSEMBLY) &&
+                                 pfcSolid::cast(new_record.handle)->GetIsSkeleton();
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        return nullptr;
+    }
+    xcatchend
+
+    m_statistics.models++;
+    if (record != m_records.end()) {
+        // The model was released, the record is filled again in place since the traversal may point to it
+        new_record.released = true;
+        record->second = new_record;
+        return &record->second;
+    }
+    return &m_records.insert({ key, new_record }).first->second;
+}
+
+pfcMassProperty_ptr ModelRegistry::getMassProperty(ModelRecord& record)
+{
+    if (record.mass_property) {
+        m_statistics.saved_calls++;
+        return record.mass_property;
+    }
+    record.mass_property = pfcSolid::cast(record.handle)->GetMassProperty();
+    return record.mass_property;
+}
+
+bool ModelRegistry::loadGeometry(ModelRecord& record)
+{
+    if (record.geometry_loaded || record.type != pfcMDL_PART) {
+        return true;
+    }
+    // The representation of a released part was changed, whatever the representation of the assembly
+    if (!m_geometry_on_demand && !record.released) {
+        return true;
+    }
+    try {
+        auto solid = pfcSolid::cast(record.handle);
+        record.previous_rep = solid->GetActiveSimpRep();
+        solid->ActivateSimpRep(solid->GetMasterSimpRep());
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        return false;
+    }
+    xcatchend
+
+    record.geometry_loaded = true;
+    m_statistics.geometry_loads++;
+    return true;
+}
+
+void ModelRegistry::release(ModelRecord& record)
+{
+    if (!record.handle) {
+        return;
+    }
+    // A part used by the assembly cannot be erased from the session, so only its geometry is unloaded: a part loaded
+    // on demand goes back to its previous representation, the others to the graphics one in batch mode only
+    try {
+        auto solid = pfcSolid::cast(record.handle);
+        if (record.geometry_loaded && record.previous_rep) {
+            solid->ActivateSimpRep(record.previous_rep);
+            m_statistics.unloaded_models++;
+        }
+        else if (m_unload_on_release && record.type == pfcMDL_PART) {
+            solid->ActivateSimpRep(solid->GetGraphicsSimpRep());
+            m_statistics.unloaded_models++;
+        }
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        // The representation cannot be changed, only the handle is dropped
+    }
+    xcatchend
+
+    record.handle = nullptr;
+    record.mass_property = nullptr;
+    record.geometry_loaded = false;
+    record.previous_rep = nullptr;
+    record.released = true;
+    m_statistics.released_models++;
+}
+
+void ModelRegistry::clear()
+{
+    m_records.clear();
+    m_statistics = Statistics();
+}
+
+std::string ModelRegistry::getStatisticsSummary() const
+{
+    return "Models: " + std::to_string(m_statistics.models) + " retrieved for " + std::to_string(m_statistics.lookups) +
+           " components, " + std::to_string(m_statistics.saved_calls) + " calls to Creo saved" +
+           (m_geometry_on_demand || m_statistics.geometry_loads > 0 ? ", " + std::to_string(m_statistics.geometry_loads) + " parts loaded on demand" : "") +
+           (m_statistics.released_models > 0 ? ", " + std::to_string(m_statistics.released_models) + " released (" +
+                                               std::to_string(m_statistics.unloaded_models) + " with their geometry unloaded, all kept in session)" : "");
+}
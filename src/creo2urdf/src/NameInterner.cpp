@@ -0,0 +1,83 @@
+/**
+ * @file NameInterner.cpp
+ * @brief Contains definitions for the NameInterner class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/NameInterner.h>
+
+#include <functional>
+
+constexpr NameInterner::Id NameInterner::INVALID_ID;
+
+NameInterner::Id NameInterner::intern(const std::string& name)
+{
+    // The table is kept at most half full, so that the probe sequences stay short
+    if (2 * (m_names.size() + 1) > m_table.size()) {
+        grow();
+    }
+    const std::size_t hash = std::hash<std::string>()(name);
+    const std::size_t slot = findSlot(name, hash);
+    if (m_table[slot] != INVALID_ID) {
+        return m_table[slot];
+    }
+    const Id id = static_cast<Id>(m_names.size());
+    m_names.push_back(name);
+    m_hashes.push_back(hash);
+    m_table[slot] = id;
+    return id;
+}
+
+NameInterner::Id NameInterner::find(const std::string& name) const
+{
+    if (m_table.empty()) {
+        return INVALID_ID;
+    }
+    return m_table[findSlot(name, std::hash<std::string>()(name))];
+}
+
+void NameInterner::clear()
+{
+    m_names.clear();
+    m_hashes.clear();
+    m_table.clear();
+}
+
+std::size_t NameInterner::getMemoryUsage() const
+{
+    std::size_t bytes = m_names.size() * sizeof(std::string) + m_hashes.capacity() * sizeof(std::size_t) + m_table.capacity() * sizeof(Id);
+    const std::size_t short_capacity = std::string().capacity();
+    for (const auto& name : m_names) {
+        if (name.capacity() > short_capacity) {
+            bytes += name.capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+std::size_t NameInterner::findSlot(const std::string& name, std::size_t hash) const
+{
+    const std::size_t mask = m_table.size() - 1;
+    std::size_t slot = hash & mask;
+    while (m_table[slot] != INVALID_ID && (m_hashes[m_table[slot]] != hash || m_names[m_table[slot]] != name)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void NameInterner::grow()
+{
+    const std::size_t capacity = m_table.empty() ? 64 : 2 * m_table.size();
+    m_table.assign(capacity, INVALID_ID);
+    const std::size_t mask = capacity - 1;
+    for (Id id = 0; id < m_names.size(); id++) {
+        std::size_t slot = m_hashes[id] & mask;
+        while (m_table[slot] != INVALID_ID) {
+            slot = (slot + 1) & mask;
+        }
+        m_table[slot] = id;
+    }
+}
@@ -0,0 +1,127 @@
+/**
+ * @file PrincipalInertia.cpp
+ * @brief Contains definitions for expressing the link inertias in their principal axes.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/PrincipalInertia.h>
+#include <creo2urdf/Parallel.h>
+
+#include <iDynTree/EigenHelpers.h>
+
+#include <libxml2/libxml/parser.h>
+#include <libxml2/libxml/tree.h>
+
+#include <Eigen/Eigenvalues>
+
+#include <limits>
+#include <sstream>
+
+namespace {
+
+std::string toXmlString(const std::vector<double>& values)
+{
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<double>::max_digits10);
+    for (std::size_t i = 0; i < values.size(); i++) {
+        stream << (i > 0 ? " " : "") << values[i];
+    }
+    return stream.str();
+}
+
+xmlNodePtr findChild(xmlNodePtr node, const char* name)
+{
+    for (xmlNodePtr child = node->children; child != NULL; child = child->next) {
+        if (child->type == XML_ELEMENT_NODE && xmlStrEqual(child->name, BAD_CAST name)) {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+} // namespace
+
+std::vector<PrincipalInertia> computePrincipalInertias(const iDynTree::Model& model, double tolerance)
+{
+    std::vector<PrincipalInertia> inertias(model.getNrOfLinks());
+
+    parallelFor(inertias.size(), [&](std::size_t l) {
+        const iDynTree::RotationalInertiaRaw link_inertia = model.getLink(l)->getInertia().getRotationalInertiaWrtCenterOfMass();
+        const Eigen::Matrix3d inertia = iDynTree::toEigen(link_inertia);
+        auto& principal = inertias[l];
+
+        const double max_moment = inertia.diagonal().cwiseAbs().maxCoeff();
+        const Eigen::Matrix3d off_diagonal = inertia - Eigen::Matrix3d(inertia.diagonal().asDiagonal());
+        if (max_moment <= 0.0 || off_diagonal.cwiseAbs().maxCoeff() <= tolerance * max_moment) {
+            principal.moments = { { inertia(0, 0), inertia(1, 1), inertia(2, 2) } };
+            return;
+        }
+
+        const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(inertia);
+        Eigen::Matrix3d link_R_principal = solver.eigenvectors();
+        if (link_R_principal.determinant() < 0.0) {
+            link_R_principal.col(2) *= -1.0;
+        }
+        iDynTree::toEigen(principal.link_R_principal) = link_R_principal;
+        principal.moments = { { solver.eigenvalues()(0), solver.eigenvalues()(1), solver.eigenvalues()(2) } };
+        principal.rotated = true;
+    });
+
+    return inertias;
+}
+
+bool writePrincipalInertiasToUrdf(const std::string& filename, const iDynTree::Model& model, const std::vector<PrincipalInertia>& inertias)
+{
+    xmlKeepBlanksDefault(0);
+    xmlDocPtr doc = xmlReadFile(filename.c_str(), NULL, XML_PARSE_NOBLANKS);
+    if (doc == NULL) {
+        return false;
+    }
+
+    xmlNodePtr root_node = xmlDocGetRootElement(doc);
+    for (xmlNodePtr link_node = root_node ? root_node->children : NULL; link_node != NULL; link_node = link_node->next) {
+        if (link_node->type != XML_ELEMENT_NODE || !xmlStrEqual(link_node->name, BAD_CAST "link")) {
+            continue;
+        }
+        xmlChar* link_name = xmlGetProp(link_node, BAD_CAST "name");
+        if (link_name == NULL) {
+            continue;
+        }
+        const auto link_index = model.getLinkIndex(std::string(reinterpret_cast<const char*>(link_name)));
+        xmlFree(link_name);
+
+        xmlNodePtr inertial_node = findChild(link_node, "inertial");
+        if (link_index == iDynTree::LINK_INVALID_INDEX || inertial_node == NULL || !inertias[link_index].rotated) {
+            continue;
+        }
+        const auto& principal = inertias[link_index];
+
+        // The origin is placed in the center of mass, so only its orientation changes
+        xmlNodePtr origin_node = findChild(inertial_node, "origin");
+        if (origin_node == NULL) {
+            origin_node = xmlNewChild(inertial_node, NULL, BAD_CAST "origin", NULL);
+        }
+        const iDynTree::Position com = model.getLink(link_index)->getInertia().getCenterOfMass();
+        const iDynTree::Vector3 rpy = principal.link_R_principal.asRPY();
+        xmlSetProp(origin_node, BAD_CAST "xyz", BAD_CAST toXmlString({ com(0), com(1), com(2) }).c_str());
+        xmlSetProp(origin_node, BAD_CAST "rpy", BAD_CAST toXmlString({ rpy(0), rpy(1), rpy(2) }).c_str());
+
+        xmlNodePtr inertia_node = findChild(inertial_node, "inertia");
+        if (inertia_node == NULL) {
+            inertia_node = xmlNewChild(inertial_node, NULL, BAD_CAST "inertia", NULL);
+        }
+        xmlSetProp(inertia_node, BAD_CAST "ixx", BAD_CAST toXmlString({ principal.moments[0] }).c_str());
+        xmlSetProp(inertia_node, BAD_CAST "ixy", BAD_CAST "0");
+        xmlSetProp(inertia_node, BAD_CAST "ixz", BAD_CAST "0");
+        xmlSetProp(inertia_node, BAD_CAST "iyy", BAD_CAST toXmlString({ principal.moments[1] }).c_str());
+        xmlSetProp(inertia_node, BAD_CAST "iyz", BAD_CAST "0");
+        xmlSetProp(inertia_node, BAD_CAST "izz", BAD_CAST toXmlString({ principal.moments[2] }).c_str());
+    }
+
+    bool ok = xmlSaveFormatFileEnc(filename.c_str(), doc, "UTF-8", 1) >= 0;
+    xmlFreeDoc(doc);
+    return ok;
+}
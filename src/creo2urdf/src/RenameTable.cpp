@@ -0,0 +1,50 @@
+/**
+ * @file RenameTable.cpp
+ * @brief Contains definitions for the RenameTable class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/RenameTable.h>
+
+void RenameTable::load(const YAML::Node& rename)
+{
+    clear();
+    if (!rename.IsDefined() || !rename.IsMap()) {
+        return;
+    }
+    m_creo_to_urdf.reserve(rename.size());
+    m_urdf_to_creo.reserve(rename.size());
+    for (const auto& entry : rename) {
+        const std::string& creo_name = entry.first.Scalar();
+        const std::string& urdf_name = entry.second.Scalar();
+        m_creo_to_urdf.insert(std::make_pair(creo_name, urdf_name));
+        m_urdf_to_creo.insert(std::make_pair(urdf_name, creo_name));
+    }
+}
+
+const std::string* RenameTable::findRenamed(const std::string& creo_name) const
+{
+    auto it = m_creo_to_urdf.find(creo_name);
+    return it == m_creo_to_urdf.end() ? nullptr : &it->second;
+}
+
+const std::string* RenameTable::findCreoName(const std::string& urdf_name) const
+{
+    auto it = m_urdf_to_creo.find(urdf_name);
+    return it == m_urdf_to_creo.end() ? nullptr : &it->second;
+}
+
+const std::string& RenameTable::getRenamed(const std::string& creo_name) const
+{
+    const std::string* renamed = findRenamed(creo_name);
+    return renamed ? *renamed : creo_name;
+}
+
+void RenameTable::clear()
+{
+    m_creo_to_urdf.clear();
+    m_urdf_to_creo.clear();
+}
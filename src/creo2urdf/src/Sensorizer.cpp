@@ -8,10 +8,153 @@
  */
 
 #include <creo2urdf/Sensorizer.h>
+#include <creo2urdf/XMLTemplate.h>
+#include <creo2urdf/Parallel.h>
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+/**
+ * @brief Slots of the templates of the generic sensors.
+ */
+enum SensorSlot {
+    SENSOR_SLOT_LINK,
+    SENSOR_SLOT_NAME,
+    SENSOR_SLOT_UPDATE_RATE,
+    SENSOR_SLOT_POSE,
+    SENSOR_SLOT_RPY,
+    SENSOR_SLOT_XYZ,
+    NR_OF_SENSOR_SLOTS
+};
+
+/**
+ * @brief Slots of the templates of the force/torque sensors.
+ */
+enum FTSlot {
+    FT_SLOT_JOINT,
+    FT_SLOT_NAME,
+    FT_SLOT_FRAME,
+    FT_SLOT_DIRECTION,
+    FT_SLOT_POSE,
+    FT_SLOT_RPY,
+    FT_SLOT_XYZ,
+    NR_OF_FT_SLOTS
+};
+
+std::string marker(std::size_t slot)
+{
+    return XMLTemplate::getSlotMarker(slot);
+}
+
+/**
+ * @brief Parses the blobs of a sensor and adds them to a node, skipping the ones that are not well formed.
+ */
+void addBlobsToNode(xmlNodePtr node, const std::vector<std::string>& blobs, const std::string& sensor_name)
+{
+    for (const auto& blob : blobs)
+    {
+        xmlNodePtr node_xmlblob = nullptr;
+        if (xmlParseInNodeContext(node, blob.c_str(), static_cast<int>(blob.size()), 0, &node_xmlblob) != XML_ERR_OK)
+        {
+            printToMessageWindow("Sensorizer: a sensor blob of " + sensor_name + " is not valid XML and it is skipped.", c2uLogLevel::WARN);
+            xmlFreeNodeList(node_xmlblob);
+            continue;
+        }
+        if (node_xmlblob)
+            xmlAddChildList(node, node_xmlblob);
+    }
+}
+
+/**
+ * @brief Builds the gazebo and the sensor templates of a generic sensor, with the blobs parsed once.
+ */
+bool buildSensorXMLTemplates(SensorType type, const std::vector<std::string>& blobs, const std::string& sensor_name,
+                             XMLTemplate& gazebo_template, XMLTemplate& sensor_template)
+{
+    xmlKeepBlanksDefault(0);
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+    xmlNodePtr root_node = xmlNewNode(NULL, BAD_CAST "gazebo");
+    xmlDocSetRootElement(doc, root_node);
+    xmlNewProp(root_node, BAD_CAST "reference", BAD_CAST marker(SENSOR_SLOT_LINK).c_str());
+
+    xmlNodePtr node = xmlNewChild(root_node, NULL, BAD_CAST "sensor", NULL);
+    xmlNewProp(node, BAD_CAST "name", BAD_CAST marker(SENSOR_SLOT_NAME).c_str());
+    xmlNewProp(node, BAD_CAST "type", BAD_CAST gazebo_sensor_type_map.at(type).c_str());
+    xmlNewChild(node, NULL, BAD_CAST "always_on", BAD_CAST "1");
+    xmlNewChild(node, NULL, BAD_CAST "update_rate", BAD_CAST marker(SENSOR_SLOT_UPDATE_RATE).c_str());
+    xmlNewChild(node, NULL, BAD_CAST "pose", BAD_CAST marker(SENSOR_SLOT_POSE).c_str());
+    addBlobsToNode(node, blobs, sensor_name);
+
+    bool ok = gazebo_template.compile(doc, root_node, NR_OF_SENSOR_SLOTS);
+    xmlFreeDoc(doc);
+
+    doc = xmlNewDoc(BAD_CAST "1.0");
+    root_node = xmlNewNode(NULL, BAD_CAST "sensor");
+    xmlDocSetRootElement(doc, root_node);
+    xmlNewProp(root_node, BAD_CAST "name", BAD_CAST marker(SENSOR_SLOT_NAME).c_str());
+    xmlNewProp(root_node, BAD_CAST "type", BAD_CAST sensor_type_map.at(type).c_str());
+    node = xmlNewChild(root_node, NULL, BAD_CAST "parent", NULL);
+    xmlNewProp(node, BAD_CAST "link", BAD_CAST marker(SENSOR_SLOT_LINK).c_str());
+    node = xmlNewChild(root_node, NULL, BAD_CAST "origin", NULL);
+    xmlNewProp(node, BAD_CAST "rpy", BAD_CAST marker(SENSOR_SLOT_RPY).c_str());
+    xmlNewProp(node, BAD_CAST "xyz", BAD_CAST marker(SENSOR_SLOT_XYZ).c_str());
+
+    ok = sensor_template.compile(doc, root_node, NR_OF_SENSOR_SLOTS) && ok;
+    xmlFreeDoc(doc);
+    return ok;
+}
+
+/**
+ * @brief Builds the gazebo and the sensor templates of a force/torque sensor, with the blobs parsed once.
+ */
+bool buildFTXMLTemplates(const std::vector<std::string>& blobs, const std::string& sensor_name,
+                         XMLTemplate& gazebo_template, XMLTemplate& sensor_template)
+{
+    xmlKeepBlanksDefault(0);
+    xmlDocPtr doc = xmlNewDoc(NULL);
+    xmlNodePtr root_node = xmlNewNode(NULL, BAD_CAST "gazebo");
+    xmlDocSetRootElement(doc, root_node);
+    xmlNewProp(root_node, BAD_CAST "reference", BAD_CAST marker(FT_SLOT_JOINT).c_str());
+
+    xmlNodePtr node = xmlNewChild(root_node, NULL, BAD_CAST "sensor", NULL);
+    xmlNewProp(node, BAD_CAST "name", BAD_CAST marker(FT_SLOT_NAME).c_str());
+    xmlNewProp(node, BAD_CAST "type", BAD_CAST "force_torque");
+    xmlNewChild(node, NULL, BAD_CAST "always_on", BAD_CAST "1");
+    xmlNewChild(node, NULL, BAD_CAST "update_rate", BAD_CAST "100");
+    xmlNodePtr ft_node = xmlNewChild(node, NULL, BAD_CAST "force_torque", NULL);
+    xmlNewChild(ft_node, NULL, BAD_CAST "frame", BAD_CAST marker(FT_SLOT_FRAME).c_str());
+    xmlNewChild(ft_node, NULL, BAD_CAST "measure_direction", BAD_CAST marker(FT_SLOT_DIRECTION).c_str());
+    xmlNewChild(node, NULL, BAD_CAST "pose", BAD_CAST marker(FT_SLOT_POSE).c_str());
+    addBlobsToNode(node, blobs, sensor_name);
+
+    bool ok = gazebo_template.compile(doc, root_node, NR_OF_FT_SLOTS);
+    xmlFreeDoc(doc);
+
+    doc = xmlNewDoc(BAD_CAST "1.0");
+    root_node = xmlNewNode(NULL, BAD_CAST "sensor");
+    xmlDocSetRootElement(doc, root_node);
+    xmlNewProp(root_node, BAD_CAST "name", BAD_CAST marker(FT_SLOT_NAME).c_str());
+    xmlNewProp(root_node, BAD_CAST "type", BAD_CAST "force_torque");
+    node = xmlNewChild(root_node, NULL, BAD_CAST "parent", NULL);
+    xmlNewProp(node, BAD_CAST "joint", BAD_CAST marker(FT_SLOT_JOINT).c_str());
+    node = xmlNewChild(root_node, NULL, BAD_CAST "force_torque", NULL);
+    xmlNewChild(node, NULL, BAD_CAST "frame", BAD_CAST marker(FT_SLOT_FRAME).c_str());
+    xmlNewChild(node, NULL, BAD_CAST "measure_direction", BAD_CAST marker(FT_SLOT_DIRECTION).c_str());
+    node = xmlNewChild(root_node, NULL, BAD_CAST "origin", NULL);
+    xmlNewProp(node, BAD_CAST "rpy", BAD_CAST marker(FT_SLOT_RPY).c_str());
+    xmlNewProp(node, BAD_CAST "xyz", BAD_CAST marker(FT_SLOT_XYZ).c_str());
+
+    ok = sensor_template.compile(doc, root_node, NR_OF_FT_SLOTS) && ok;
+    xmlFreeDoc(doc);
+    return ok;
+}
+
+} // namespace
 
 void Sensorizer::readSensorsFromConfig(const YAML::Node & config)
 {
-    m_config = config;
     if (!config["sensors"].IsDefined())
         return;
 
@@ -40,10 +183,10 @@ void Sensorizer::readSensorsFromConfig(const YAML::Node & config)
         if (s["exportedFrameName"].IsDefined()) {
             exported_frame_name = s["exportedFrameName"].Scalar();
         }
-        std::vector<string> sensor_blobs;
+        auto sensor_blobs = std::make_shared<std::vector<std::string>>();
         if (s["sensorBlobs"].IsDefined())
         {
-            sensor_blobs = s["sensorBlobs"].as<std::vector<std::string>>();
+            *sensor_blobs = s["sensorBlobs"].as<std::vector<std::string>>();
         }
 
         try
@@ -66,6 +209,159 @@ void Sensorizer::readSensorsFromConfig(const YAML::Node & config)
     }
 }
 
+void Sensorizer::readSensorGeneratorsFromConfig(const YAML::Node& config)
+{
+    if (!config["sensorGenerators"].IsDefined())
+        return;
+
+    for (const auto& g : config["sensorGenerators"]) {
+        try
+        {
+            SensorGenerator generator;
+            generator.linkName = g["linkName"].Scalar();
+            generator.frameNamePattern = g["frameNamePattern"].Scalar();
+            generator.frameNameRegex = std::regex(generator.frameNamePattern, std::regex::ECMAScript | std::regex::optimize);
+            generator.type = stringToEnum<SensorType>(sensor_type_map, g["sensorType"].Scalar());
+            if (g["sensorNameTemplate"].IsDefined()) {
+                generator.sensorNameTemplate = g["sensorNameTemplate"].Scalar();
+            }
+            if (g["exportFrameInURDF"].IsDefined()) {
+                generator.exportFrameInURDF = g["exportFrameInURDF"].as<bool>();
+            }
+            if (g["updateRate"].IsDefined()) {
+                generator.updateRate = g["updateRate"].as<double>();
+            }
+            auto sensor_blobs = std::make_shared<std::vector<std::string>>();
+            if (g["sensorBlobs"].IsDefined()) {
+                *sensor_blobs = g["sensorBlobs"].as<std::vector<std::string>>();
+            }
+            generator.xmlBlobs = sensor_blobs;
+            sensor_generators.push_back(std::move(generator));
+        }
+        catch (YAML::Exception& e)
+        {
+            printToMessageWindow(e.msg, c2uLogLevel::WARN);
+        }
+        catch (std::regex_error& e)
+        {
+            printToMessageWindow("Sensorizer: invalid frameNamePattern " + g["frameNamePattern"].Scalar() + " (" + e.what() + ")", c2uLogLevel::WARN);
+        }
+    }
+}
+
+std::string Sensorizer::fillSensorNameTemplate(const std::string& name_template, const std::string& link_name,
+                                               const std::smatch& match, std::size_t index)
+{
+    std::string name;
+    name.reserve(name_template.size() + link_name.size() + match.length(0));
+    std::size_t pos = 0;
+    while (pos < name_template.size()) {
+        const auto open = name_template.find('{', pos);
+        const auto close = open == std::string::npos ? std::string::npos : name_template.find('}', open);
+        if (close == std::string::npos) {
+            name.append(name_template, pos, std::string::npos);
+            break;
+        }
+        name.append(name_template, pos, open - pos);
+        const std::string key = name_template.substr(open + 1, close - open - 1);
+        if (key == "link") {
+            name += link_name;
+        }
+        else if (key == "frame") {
+            name += match.str(0);
+        }
+        else if (key == "index") {
+            name += std::to_string(index);
+        }
+        else if (!key.empty() && key.find_first_not_of("0123456789") == std::string::npos && std::stoul(key) < match.size()) {
+            name += match.str(std::stoul(key));
+        }
+        else {
+            // Unknown placeholders are copied as they are
+            name.append(name_template, open, close - open + 1);
+        }
+        pos = close + 1;
+    }
+    return name;
+}
+
+void Sensorizer::expandSensorGenerators(const NameMap<LinkInfo>& link_info_map, const RenameTable& rename_table, const FrameGraph& frame_graph)
+{
+    // The generators are grouped by link, keeping their order within each link
+    std::vector<std::string> link_names;
+    std::unordered_map<std::string, std::vector<const SensorGenerator*>> generators_by_link;
+    for (const auto& generator : sensor_generators) {
+        auto& generators = generators_by_link[generator.linkName];
+        if (generators.empty()) {
+            link_names.push_back(generator.linkName);
+        }
+        generators.push_back(&generator);
+    }
+
+    // The transforms of the generated sensors are composed in parallel once all the sensors are added
+    const std::size_t first_generated_sensor = sensors.size();
+    std::vector<std::pair<FrameGraph::FrameIndex, FrameGraph::FrameIndex>> queries;
+
+    for (const auto& link_name : link_names)
+    {
+        const std::string* renamed_cad_link_name = rename_table.findCreoName(link_name);
+        const std::string& cad_link_name = renamed_cad_link_name ? *renamed_cad_link_name : link_name;
+        const auto link_info = link_info_map.find(cad_link_name);
+        if (link_info == link_info_map.end())
+        {
+            printToMessageWindow("Sensorizer: link " + cad_link_name + " not found in the link info map, sensor generators of " + link_name + " skipped.", c2uLogLevel::WARN);
+            continue;
+        }
+
+        const auto link_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(cad_link_name, link_info->second.link_frame_name));
+        if (link_frame == FrameGraph::INVALID_FRAME_INDEX)
+        {
+            printToMessageWindow("Sensorizer: frame " + link_info->second.link_frame_name + " of " + cad_link_name + " not found, sensor generators of " + link_name + " skipped.", c2uLogLevel::WARN);
+            continue;
+        }
+
+        for (const auto* generator : generators_by_link.at(link_name))
+        {
+            std::size_t index = 0;
+            std::smatch match;
+            for (const auto& csys_name : link_info->second.csys_names)
+            {
+                if (!std::regex_match(csys_name, match, generator->frameNameRegex))
+                    continue;
+
+                const auto csys_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(cad_link_name, csys_name));
+                if (csys_frame == FrameGraph::INVALID_FRAME_INDEX)
+                {
+                    printToMessageWindow("Unable to get the transform for " + csys_name, c2uLogLevel::WARN);
+                    continue;
+                }
+
+                SensorInfo sensor;
+                sensor.sensorName = fillSensorNameTemplate(generator->sensorNameTemplate, link_name, match, index++);
+                sensor.frameName = csys_name;
+                sensor.linkName = link_name;
+                sensor.exportedFrameName = sensor.sensorName;
+                sensor.exportFrameInURDF = generator->exportFrameInURDF;
+                sensor.type = generator->type;
+                sensor.updateRate = generator->updateRate;
+                sensor.xmlBlobs = generator->xmlBlobs;
+                sensors.push_back(std::move(sensor));
+                queries.push_back(std::make_pair(link_frame, csys_frame));
+            }
+            if (index == 0)
+            {
+                printToMessageWindow("Sensorizer: no csys of " + link_name + " matches " + generator->frameNamePattern, c2uLogLevel::WARN);
+            }
+        }
+    }
+
+    const auto transforms = frame_graph.composeTransforms(queries);
+    for (std::size_t i = 0; i < transforms.size(); i++)
+    {
+        sensors[first_generated_sensor + i].transform = transforms[i];
+    }
+}
+
 void Sensorizer::readFTSensorsFromConfig(const YAML::Node& config)
 {
     if (config["forceTorqueSensors"].IsDefined())
@@ -108,142 +404,142 @@ void Sensorizer::readFTSensorsFromConfig(const YAML::Node& config)
 
 }
 
-void Sensorizer::assignTransformToFTSensor(const std::map<std::string, ExportedFrameInfo>& exported_frame_info_map,const std::map<std::string, LinkInfo>& link_info_map, const std::map<std::string, JointInfo>& joint_info_map, const std::array<double, 3> scale)
+void Sensorizer::assignTransformToFTSensor(const NameMap<ExportedFrameInfo>& exported_frame_info_map,const NameMap<LinkInfo>& link_info_map, const NameMap<JointInfo>& joint_info_map, const FrameGraph& frame_graph)
 {
+    // The joints are indexed by datum once, the first joint by name using a datum wins
+    std::unordered_map<std::string, const JointInfo*> datum_to_joint;
+    datum_to_joint.reserve(joint_info_map.size());
+    for (auto joint_info_it : joint_info_map.sortedByName()) {
+        const auto& joint_info = *joint_info_it;
+        datum_to_joint.insert(std::make_pair(joint_info.second.datum_name, &joint_info.second));
+    }
+
+    // The ids of the link names can be used directly only if the maps share the table of names
+    const auto& joint_names = *joint_info_map.getNames();
+    auto findLink = [&](NameInterner::Id id) {
+        return link_info_map.getNames() == joint_info_map.getNames() ? link_info_map.find(id) : link_info_map.find(joint_names.getName(id));
+    };
+
+    // The frames are resolved here, then the transforms are composed in parallel in the order of the sensors
+    std::vector<std::pair<FrameGraph::FrameIndex, FrameGraph::FrameIndex>> queries;
+    std::vector<iDynTree::Transform*> queried_transforms;
+
     // Iterate over all sensors
-    for (auto& f : ft_sensors)
-    {   
-        if (exported_frame_info_map.find(f.second.frameName) != exported_frame_info_map.end())
+    for (auto f_it : ft_sensors.sortedByName())
+    {
+        auto& f = *f_it;
+        auto exported_frame = exported_frame_info_map.find(f.second.frameName);
+        if (exported_frame != exported_frame_info_map.end())
         {
             // If the frame used is in the exported frames map, use the transform from there
-            f.second.child_link_H_sensor = exported_frame_info_map.at(f.second.frameName).linkFrame_H_additionalFrame * exported_frame_info_map.at(f.second.frameName).additionalTransformation;
+            f.second.child_link_H_sensor = exported_frame->second.linkFrame_H_additionalFrame * exported_frame->second.additionalTransformation;
         }
         else {
 
-            auto joint_it = std::find_if(joint_info_map.begin(), joint_info_map.end(),
-                [f](const std::pair<std::string, JointInfo>& pair) {
-                    return pair.second.datum_name == f.second.frameName;
-                });
+            auto joint_it = datum_to_joint.find(f.second.frameName);
 
-            if (joint_it == joint_info_map.end())
+            if (joint_it == datum_to_joint.end())
             {
                 continue;
             }
 
-            JointInfo j_info = joint_it->second;
+            const JointInfo& j_info = *joint_it->second;
 
-            LinkInfo parent_l_info = link_info_map.at(j_info.parent_link_name);
-            LinkInfo child_l_info = link_info_map.at(j_info.child_link_name);
+            auto parent_link_info = findLink(j_info.parent_link_id);
+            auto child_link_info = findLink(j_info.child_link_id);
+            if (parent_link_info == link_info_map.end() || child_link_info == link_info_map.end())
+            {
+                printToMessageWindow("Sensorizer: the links of the joint of " + f.second.sensorName + " are not in the link info map, sensor skipped.", c2uLogLevel::WARN);
+                continue;
+            }
+            const auto& parent_link_name = parent_link_info->first;
+            const auto& child_link_name = child_link_info->first;
+            const LinkInfo& parent_l_info = parent_link_info->second;
+            const LinkInfo& child_l_info = child_link_info->second;
 
-            auto parent_csys_H_sensor = (getTransformFromPart(parent_l_info.modelhdl, f.second.frameName, scale)).second;
-            auto parent_csys_H_parent_link = (getTransformFromPart(parent_l_info.modelhdl, parent_l_info.link_frame_name, scale)).second;
             // This transform is used for exporting the ft frame
-            f.second.parent_link_H_sensor = parent_csys_H_parent_link.inverse() * parent_csys_H_sensor;
+            const auto parent_link_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(parent_link_name, parent_l_info.link_frame_name));
+            const auto parent_sensor_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(parent_link_name, f.second.frameName));
+            if (frame_graph.areConnected(parent_link_frame, parent_sensor_frame))
+            {
+                queries.push_back(std::make_pair(parent_link_frame, parent_sensor_frame));
+                queried_transforms.push_back(&f.second.parent_link_H_sensor);
+            }
+            else
+            {
+                printToMessageWindow("Unable to get the transform for " + f.second.frameName + " in " + parent_link_name, c2uLogLevel::WARN);
+            }
 
-            auto child_csys_H_sensor = (getTransformFromPart(child_l_info.modelhdl, f.second.frameName, scale)).second;
-            auto child_csys_H_child_link = (getTransformFromPart(child_l_info.modelhdl, child_l_info.link_frame_name, scale)).second;
             // This transform is used for defining the pose of the ft sensor
-            f.second.child_link_H_sensor = child_csys_H_child_link.inverse() * child_csys_H_sensor;
+            const auto child_link_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(child_link_name, child_l_info.link_frame_name));
+            const auto child_sensor_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(child_link_name, f.second.frameName));
+            if (frame_graph.areConnected(child_link_frame, child_sensor_frame))
+            {
+                queries.push_back(std::make_pair(child_link_frame, child_sensor_frame));
+                queried_transforms.push_back(&f.second.child_link_H_sensor);
+            }
+            else
+            {
+                printToMessageWindow("Unable to get the transform for " + f.second.frameName + " in " + child_link_name, c2uLogLevel::WARN);
+            }
         }
     }
+
+    const auto transforms = frame_graph.composeTransforms(queries);
+    for (std::size_t i = 0; i < queried_transforms.size(); i++)
+    {
+        *queried_transforms[i] = transforms[i];
+    }
 }
 
 std::vector<std::string> Sensorizer::buildFTXMLBlobs()
 {
-    std::vector<std::string> ft_xml_blobs;
-
-    for (const auto& ft : ft_sensors)
+    // The templates are built one by one, since each sensor has its own blobs
+    std::vector<std::pair<XMLTemplate, XMLTemplate>> templates;
+    std::vector<const FTSensorInfo*> ft_infos;
+    std::vector<const std::string*> joint_names;
+    for (auto ft_it : ft_sensors.sortedByName())
     {
-        xmlKeepBlanksDefault(0);
-        xmlDocPtr doc = NULL;
-        xmlNodePtr root_node = NULL, node = NULL;
-        doc = xmlNewDoc(NULL);
-        root_node = xmlNewNode(NULL, BAD_CAST "gazebo");
-
-        xmlDocSetRootElement(doc, root_node);
-
-        xmlNewProp(root_node, BAD_CAST "reference", BAD_CAST ft.first.c_str());
-
-        node = xmlNewChild(root_node, NULL, BAD_CAST "sensor", NULL);
-        xmlNewProp(node, BAD_CAST "name", BAD_CAST ft.second.sensorName.c_str());
-        xmlNewProp(node, BAD_CAST "type", BAD_CAST "force_torque");
-
-        auto node1 = xmlNewChild(node, NULL, BAD_CAST "always_on", BAD_CAST "1");
-        node1 = xmlNewChild(node, NULL, BAD_CAST "update_rate", BAD_CAST "100");
-        node1 = xmlNewChild(node, NULL, BAD_CAST "force_torque", NULL);
-
-        auto node2 = xmlNewChild(node1, NULL, BAD_CAST "frame", BAD_CAST ft.second.frame.c_str());
-
-        auto& trf = ft.second.child_link_H_sensor;
-
-        if (ft.second.directionChildToParent)
+        const auto& ft = *ft_it;
+        templates.emplace_back();
+        if (!buildFTXMLTemplates(ft.second.xmlBlobs, ft.second.sensorName, templates.back().first, templates.back().second))
         {
-            node2 = xmlNewChild(node1, NULL, BAD_CAST "measure_direction", BAD_CAST "child_to_parent");
+            printToMessageWindow("Sensorizer: unable to build the XML template of " + ft.second.sensorName + ", sensor skipped.", c2uLogLevel::WARN);
+            templates.pop_back();
+            continue;
         }
-        else
-        {
-            node2 = xmlNewChild(node1, NULL, BAD_CAST "measure_direction", BAD_CAST "parent_to_child");
-        }
-
-        std::string pose_xyz_rpy = trf.getPosition().toString() + " " + trf.getRotation().asRPY().toString();
-        node1 = xmlNewChild(node, NULL, BAD_CAST "pose", BAD_CAST pose_xyz_rpy.c_str());
-
-        for (auto & blob : ft.second.xmlBlobs)
-        {
-            xmlNodePtr node_xmlblob = nullptr;
-
-            xmlParseInNodeContext(node, blob.c_str(), blob.size(), 0, &node_xmlblob);
-
-            if (node_xmlblob)
-                xmlAddChild(node, node_xmlblob);
-        }
-
-        xmlOutputBufferPtr gazebo_doc_buffer = xmlAllocOutputBuffer(NULL);
-        xmlNodeDumpOutput(gazebo_doc_buffer, doc, root_node, 0, 1, NULL);
-        ft_xml_blobs.push_back(string((char*)xmlBufContent(gazebo_doc_buffer->buffer)));
-
-        xmlOutputBufferClose(gazebo_doc_buffer);
-
-        xmlFreeDoc(doc);
-
-        doc = xmlNewDoc(BAD_CAST "1.0");
-        root_node = xmlNewNode(NULL, BAD_CAST "sensor");
-
-        xmlDocSetRootElement(doc, root_node);
-
-        xmlNewProp(root_node, BAD_CAST "name", BAD_CAST ft.second.sensorName.c_str());
-        xmlNewProp(root_node, BAD_CAST "type", BAD_CAST "force_torque");
-        node = xmlNewChild(root_node, NULL, BAD_CAST "parent", NULL);
-        xmlNewProp(node, BAD_CAST "joint", BAD_CAST ft.first.c_str());
-
-        node = xmlNewChild(root_node, NULL, BAD_CAST "force_torque", NULL);
-        xmlNewChild(node, NULL, BAD_CAST "frame", BAD_CAST ft.second.frame.c_str());
-        if (ft.second.directionChildToParent)
-        {
-            xmlNewChild(node, NULL, BAD_CAST "measure_direction", BAD_CAST "child_to_parent");
-        }
-        else
-        {
-            xmlNewChild(node, NULL, BAD_CAST "measure_direction", BAD_CAST "parent_to_child");
-        }
-        node = xmlNewChild(root_node, NULL, BAD_CAST "origin", NULL);
-        xmlNewProp(node, BAD_CAST "rpy", BAD_CAST trf.getRotation().asRPY().toString().c_str());
-        xmlNewProp(node, BAD_CAST "xyz", BAD_CAST trf.getPosition().toString().c_str());
-
-        xmlOutputBufferPtr sensor_doc_buffer = xmlAllocOutputBuffer(NULL);
-        xmlNodeDumpOutput(sensor_doc_buffer, doc, root_node, 0, 1, NULL);
-        ft_xml_blobs.push_back(string((char*)xmlBufContent(sensor_doc_buffer->buffer)));
-
-        xmlOutputBufferClose(sensor_doc_buffer);
-
-        xmlFreeDoc(doc);
+        ft_infos.push_back(&ft.second);
+        joint_names.push_back(&ft.first);
     }
 
+    std::vector<std::string> ft_xml_blobs(2 * ft_infos.size());
+    parallelFor(ft_infos.size(), [&](std::size_t i) {
+        const auto& ft = *ft_infos[i];
+        const auto& trf = ft.child_link_H_sensor;
+        const auto rpy = trf.getRotation().asRPY();
+
+        std::array<std::string, NR_OF_FT_SLOTS> values;
+        values[FT_SLOT_JOINT] = escapeXML(*joint_names[i]);
+        values[FT_SLOT_NAME] = escapeXML(ft.sensorName);
+        values[FT_SLOT_FRAME] = escapeXML(ft.frame);
+        values[FT_SLOT_DIRECTION] = ft.directionChildToParent ? "child_to_parent" : "parent_to_child";
+        values[FT_SLOT_XYZ] = formatDoubles(trf.getPosition().data(), 3);
+        values[FT_SLOT_RPY] = formatDoubles(rpy.data(), 3);
+        values[FT_SLOT_POSE] = values[FT_SLOT_XYZ] + " " + values[FT_SLOT_RPY];
+
+        ft_xml_blobs[2 * i] = templates[i].first.fill(values.data());
+        ft_xml_blobs[2 * i + 1] = templates[i].second.fill(values.data());
+    });
+
     return ft_xml_blobs;
 }
 
-void Sensorizer::assignTransformToSensors(const std::map<std::string, ExportedFrameInfo>& exported_frame_info_map, const std::map<std::string, LinkInfo>& link_info_map, const std::array<double, 3> scale)
+void Sensorizer::assignTransformToSensors(const NameMap<ExportedFrameInfo>& exported_frame_info_map, const NameMap<LinkInfo>& link_info_map,
+                                          const RenameTable& rename_table, const FrameGraph& frame_graph)
 {
+    // The frames are resolved here, then the transforms are composed in parallel in the order of the sensors
+    std::vector<std::pair<FrameGraph::FrameIndex, FrameGraph::FrameIndex>> queries;
+    std::vector<SensorInfo*> queried_sensors;
     for (auto& s : sensors)
     {
         if (exported_frame_info_map.find(s.frameName) != exported_frame_info_map.end())
@@ -254,19 +550,8 @@ void Sensorizer::assignTransformToSensors(const std::map<std::string, ExportedFr
         else
         {
             // Otherwise let's try to compute the transform
-            bool ret = false;
-            iDynTree::Transform csys_H_additionalFrame{ iDynTree::Transform::Identity() };
-            iDynTree::Transform csys_H_linkFrame{ iDynTree::Transform::Identity() };
-            iDynTree::Transform linkFrame_H_additionalFrame{ iDynTree::Transform::Identity() };
-            std::string cad_link_name = "";
-            for (auto& rename : m_config["rename"])
-            {
-                if (rename.second.Scalar() == s.linkName)
-                {
-                    cad_link_name = rename.first.Scalar();
-                    break;
-                }
-            }
+            const std::string* renamed_cad_link_name = rename_table.findCreoName(s.linkName);
+            const std::string cad_link_name = renamed_cad_link_name ? *renamed_cad_link_name : "";
 
             if (link_info_map.find(cad_link_name) == link_info_map.end())
             {
@@ -274,90 +559,74 @@ void Sensorizer::assignTransformToSensors(const std::map<std::string, ExportedFr
                 continue;
             }
 
-            auto link_info = link_info_map.at(cad_link_name);
-            std::tie(ret, csys_H_additionalFrame) = getTransformFromPart(link_info.modelhdl, s.frameName, scale);
-            if (!ret)
+            const auto& link_info = link_info_map.at(cad_link_name);
+            const auto link_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(cad_link_name, link_info.link_frame_name));
+            const auto sensor_frame = frame_graph.getFrameIndex(FrameGraph::getDatumFrameName(cad_link_name, s.frameName));
+            if (!frame_graph.areConnected(link_frame, sensor_frame))
             {
                 printToMessageWindow("Unable to get the transform for " + s.frameName, c2uLogLevel::WARN);
                 continue;
             }
-            std::tie(ret, csys_H_linkFrame) = getTransformFromPart(link_info.modelhdl, link_info.link_frame_name, scale);
-            if (!ret)
-            {
-                printToMessageWindow("Unable to get the transform for " + link_info.link_frame_name, c2uLogLevel::WARN);
-                continue;
-            }
-            linkFrame_H_additionalFrame = csys_H_linkFrame.inverse() * csys_H_additionalFrame;
-            s.transform = linkFrame_H_additionalFrame;
+            queries.push_back(std::make_pair(link_frame, sensor_frame));
+            queried_sensors.push_back(&s);
         }
     }
+
+    const auto transforms = frame_graph.composeTransforms(queries);
+    for (std::size_t i = 0; i < queried_sensors.size(); i++)
+    {
+        queried_sensors[i]->transform = transforms[i];
+    }
 }
 
 std::vector<std::string> Sensorizer::buildSensorsXMLBlobs()
 {
-    std::vector<std::string> xml_blobs;
-
-    for (const auto& s : sensors)
+    // The sensors sharing type and blobs (e.g. the ones of a generator) share the templates
+    std::vector<std::pair<XMLTemplate, XMLTemplate>> templates;
+    std::map<std::pair<SensorType, const std::vector<std::string>*>, std::size_t> template_indices;
+    std::vector<std::size_t> sensor_templates(sensors.size(), 0);
+    std::vector<bool> valid(sensors.size(), true);
+    const std::vector<std::string> no_blobs;
+    for (std::size_t i = 0; i < sensors.size(); i++)
     {
-        xmlKeepBlanksDefault(0);
-        xmlDocPtr doc = NULL;
-        xmlNodePtr root_node = NULL, node = NULL;
-        doc = xmlNewDoc(BAD_CAST "1.0");
-        root_node = xmlNewNode(NULL, BAD_CAST "gazebo");
-
-        xmlDocSetRootElement(doc, root_node);
-
-        xmlNewProp(root_node, BAD_CAST "reference", BAD_CAST s.linkName.c_str());
-
-        node = xmlNewChild(root_node, NULL, BAD_CAST "sensor", NULL);
-        xmlNewProp(node, BAD_CAST "name", BAD_CAST s.sensorName.c_str());
-
-        xmlNewProp(node, BAD_CAST "type", BAD_CAST gazebo_sensor_type_map.at(s.type).c_str());
-
-        xmlNewChild(node, NULL, BAD_CAST "always_on", BAD_CAST "1");
-        xmlNewChild(node, NULL, BAD_CAST "update_rate", BAD_CAST to_string(s.updateRate).c_str());
-
-        iDynTree::Transform trf = s.transform;
-
-        string pose = trf.getPosition().toString() + " " + trf.getRotation().asRPY().toString();
-
-        xmlNewChild(node, NULL, BAD_CAST "pose", BAD_CAST pose.c_str());
-
-        for (auto & blob : s.xmlBlobs)
+        const auto& s = sensors[i];
+        const auto* blobs = s.xmlBlobs ? s.xmlBlobs.get() : &no_blobs;
+        auto it = template_indices.find(std::make_pair(s.type, blobs));
+        if (it == template_indices.end())
         {
-            xmlNodePtr node_xmlblob = nullptr;
-
-            xmlParseInNodeContext(node, blob.c_str(), blob.size(), 0, &node_xmlblob);
-
-            if (node_xmlblob)
-                xmlAddChild(node, node_xmlblob);
+            templates.emplace_back();
+            if (!buildSensorXMLTemplates(s.type, *blobs, s.sensorName, templates.back().first, templates.back().second))
+            {
+                printToMessageWindow("Sensorizer: unable to build the XML template of " + s.sensorName + ", sensor skipped.", c2uLogLevel::WARN);
+                templates.pop_back();
+                valid[i] = false;
+                continue;
+            }
+            it = template_indices.insert(std::make_pair(std::make_pair(s.type, blobs), templates.size() - 1)).first;
         }
-
-        xmlOutputBufferPtr doc_buffer = xmlAllocOutputBuffer(NULL);
-        xmlNodeDumpOutput(doc_buffer, doc, root_node, 0, 1, NULL);
-        xml_blobs.push_back(string((char*)xmlBufContent(doc_buffer->buffer)));
-
-        xmlOutputBufferClose(doc_buffer);
-        xmlFreeDoc(doc);
-
-        doc = xmlNewDoc(BAD_CAST "1.0");
-        root_node = xmlNewNode(NULL, BAD_CAST "sensor");
-        xmlDocSetRootElement(doc, root_node);
-
-        xmlNewProp(root_node, BAD_CAST "name", BAD_CAST s.sensorName.c_str());
-        xmlNewProp(root_node, BAD_CAST "type", BAD_CAST sensor_type_map.at(s.type).c_str());
-        node = xmlNewChild(root_node, NULL, BAD_CAST "parent", NULL);
-        xmlNewProp(node, BAD_CAST "link", BAD_CAST s.linkName.c_str());
-        node = xmlNewChild(root_node, NULL, BAD_CAST "origin", NULL);
-        xmlNewProp(node, BAD_CAST "rpy", BAD_CAST trf.getRotation().asRPY().toString().c_str());
-        xmlNewProp(node, BAD_CAST "xyz", BAD_CAST trf.getPosition().toString().c_str());
-        doc_buffer = xmlAllocOutputBuffer(NULL);
-        xmlNodeDumpOutput(doc_buffer, doc, root_node, 0, 1, NULL);
-        xml_blobs.push_back(string((char*)xmlBufContent(doc_buffer->buffer)));
-
-        xmlOutputBufferClose(doc_buffer);
-        xmlFreeDoc(doc);
+        sensor_templates[i] = it->second;
     }
 
+    std::vector<std::string> xml_blobs(2 * sensors.size());
+    parallelFor(sensors.size(), [&](std::size_t i) {
+        if (!valid[i])
+            return;
+        const auto& s = sensors[i];
+        const auto& trf = s.transform;
+        const auto rpy = trf.getRotation().asRPY();
+
+        std::array<std::string, NR_OF_SENSOR_SLOTS> values;
+        values[SENSOR_SLOT_LINK] = escapeXML(s.linkName);
+        values[SENSOR_SLOT_NAME] = escapeXML(s.sensorName);
+        values[SENSOR_SLOT_UPDATE_RATE] = formatDoubles(&s.updateRate, 1);
+        values[SENSOR_SLOT_XYZ] = formatDoubles(trf.getPosition().data(), 3);
+        values[SENSOR_SLOT_RPY] = formatDoubles(rpy.data(), 3);
+        values[SENSOR_SLOT_POSE] = values[SENSOR_SLOT_XYZ] + " " + values[SENSOR_SLOT_RPY];
+
+        xml_blobs[2 * i] = templates[sensor_templates[i]].first.fill(values.data());
+        xml_blobs[2 * i + 1] = templates[sensor_templates[i]].second.fill(values.data());
+    });
+
+    xml_blobs.erase(std::remove(xml_blobs.begin(), xml_blobs.end(), std::string()), xml_blobs.end());
     return xml_blobs;
 }
\ No newline at end of file
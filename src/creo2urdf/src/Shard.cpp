@@ -0,0 +1,194 @@
+/**
+ * @file Shard.cpp
+ * @brief Contains definitions for the shards of a sharded export.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/Shard.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Version of the file format, the files written with another version are ignored.
+ */
+constexpr int shard_version = 1;
+
+/**
+ * @brief Replaces all the occurrences of a placeholder.
+ */
+void replaceAll(std::string& text, const std::string& placeholder, const std::string& value)
+{
+    for (auto pos = text.find(placeholder); pos != std::string::npos; pos = text.find(placeholder, pos + value.size())) {
+        text.replace(pos, placeholder.size(), value);
+    }
+}
+
+/**
+ * @brief Checks whether two links have the same mass properties.
+ */
+bool sameMassProperties(const ShardLink& lhs, const ShardLink& rhs)
+{
+    return lhs.mass == rhs.mass && lhs.com == rhs.com && lhs.inertia == rhs.inertia && lhs.volume == rhs.volume;
+}
+
+} // namespace
+
+bool ShardSpec::parse(const std::string& text)
+{
+    const auto separator = text.find('/');
+    if (separator == std::string::npos) {
+        return false;
+    }
+    try {
+        std::size_t parsed = 0;
+        const auto new_index = std::stoul(text.substr(0, separator), &parsed);
+        if (parsed != separator) {
+            return false;
+        }
+        const auto new_count = std::stoul(text.substr(separator + 1), &parsed);
+        if (parsed != text.size() - separator - 1 || new_count == 0 || new_index >= new_count) {
+            return false;
+        }
+        index = new_index;
+        count = new_count;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+std::string ShardSpec::toString() const
+{
+    return std::to_string(index) + "/" + std::to_string(count);
+}
+
+bool Shard::load(const std::string& filename)
+{
+    links.clear();
+
+    YAML::Node node;
+    try {
+        node = YAML::LoadFile(filename);
+    }
+    catch (const YAML::Exception&) {
+        return false;
+    }
+    if (!node["version"].IsDefined() || node["version"].as<int>() != shard_version || !node["links"].IsSequence()) {
+        return false;
+    }
+
+    try {
+        if (!spec.parse(node["shard"].as<std::string>())) {
+            return false;
+        }
+        for (const auto& entry : node["links"]) {
+            ShardLink link;
+            link.name = entry["name"].as<std::string>();
+            link.mass = entry["mass"].as<double>();
+            link.com = entry["com"].as<std::array<double, 3>>();
+            link.inertia = entry["inertia"].as<std::array<double, 9>>();
+            link.volume = entry["volume"].as<double>();
+            links.push_back(link);
+        }
+    }
+    catch (const YAML::Exception&) {
+        links.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Shard::save(const std::string& filename) const
+{
+    YAML::Emitter out;
+    out.SetDoublePrecision(17);
+    out << YAML::BeginMap;
+    out << YAML::Key << "version" << YAML::Value << shard_version;
+    out << YAML::Key << "shard" << YAML::Value << spec.toString();
+    out << YAML::Key << "links" << YAML::Value << YAML::BeginSeq;
+    for (const auto& link : links) {
+        out << YAML::BeginMap;
+        out << YAML::Key << "name" << YAML::Value << link.name;
+        out << YAML::Key << "mass" << YAML::Value << link.mass;
+        out << YAML::Key << "com" << YAML::Value << YAML::Flow << std::vector<double>(link.com.begin(), link.com.end());
+        out << YAML::Key << "inertia" << YAML::Value << YAML::Flow << std::vector<double>(link.inertia.begin(), link.inertia.end());
+        out << YAML::Key << "volume" << YAML::Value << link.volume;
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << out.c_str() << std::endl;
+    return file.good();
+}
+
+bool mergeShardFiles(const std::vector<std::string>& filenames, const std::vector<int>& exit_codes,
+                     std::map<std::string, ShardLink>& links, std::vector<std::string>& warnings)
+{
+    bool ok = true;
+    for (std::size_t i = 0; i < filenames.size(); i++) {
+        if (i < exit_codes.size() && exit_codes[i] != 0) {
+            warnings.push_back("The worker of the shard " + std::to_string(i) + " exited with code " + std::to_string(exit_codes[i]));
+        }
+        Shard shard;
+        if (!shard.load(filenames[i]) || shard.spec.index != i || shard.spec.count != filenames.size()) {
+            warnings.push_back("Unable to read the shard " + filenames[i]);
+            ok = false;
+            continue;
+        }
+        for (const auto& link : shard.links) {
+            auto merged = links.insert({ link.name, link });
+            if (!merged.second && !sameMassProperties(merged.first->second, link)) {
+                warnings.push_back(link.name + " has different mass properties in the shard " + std::to_string(i));
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+std::string expandWorkerCommand(std::string command, const std::string& asm_path, const std::string& yaml_path,
+                                const std::string& csv_path, const std::string& output_path, const ShardSpec& spec)
+{
+    replaceAll(command, "{asm}", asm_path);
+    replaceAll(command, "{yaml}", yaml_path);
+    replaceAll(command, "{csv}", csv_path);
+    replaceAll(command, "{output}", output_path);
+    replaceAll(command, "{shard}", spec.toString());
+    return command;
+}
+
+std::vector<int> runWorkerCommands(const std::vector<std::string>& commands)
+{
+    std::vector<int> exit_codes(commands.size(), -1);
+    std::vector<std::thread> workers;
+    workers.reserve(commands.size());
+    for (std::size_t i = 0; i < commands.size(); i++) {
+        workers.emplace_back([&commands, &exit_codes, i]() {
+#ifdef _WIN32
+            // cmd.exe strips the outer quotes of the command, so that the quoted paths inside it are preserved
+            exit_codes[i] = std::system(("\"" + commands[i] + "\"").c_str());
+#else
+            exit_codes[i] = std::system(commands[i].c_str());
+#endif
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return exit_codes;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file SolidReferenceCache.cpp
+ * @brief Contains definitions for the SolidReferenceCache class.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/SolidReferenceCache.h>
+
+#include <pfcExceptions.h>
+
+const SolidReferenceCache::SolidReferences* SolidReferenceCache::find(pfcFeature_ptr feat)
+{
+    pfcSolid_ptr owner = nullptr;
+    std::string owner_name;
+    int revision = -1;
+    bool modified = true;
+    int feature_id = -1;
+    try {
+        owner = feat->GetSolid();
+        owner_name = std::string(owner->GetFullName());
+        revision = owner->GetRevisionNumber();
+        modified = owner->GetIsModified();
+        feature_id = feat->GetId();
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        return nullptr;
+    }
+    xcatchend
+
+    m_statistics.lookups++;
+    // The references of a previous revision of the owner are replaced, and so are the ones of a modified owner
+    // resolved in a previous run, since unsaved changes do not change the revision
+    auto& owner_references = m_owners[owner_name];
+    if (owner_references.revision != revision || ((modified || owner_references.modified) && owner_references.run != m_run)) {
+        owner_references.revision = revision;
+        owner_references.modified = modified;
+        owner_references.run = m_run;
+        owner_references.features.clear();
+        resolveOwner(owner, owner_references.features);
+    }
+
+    auto references = owner_references.features.find(feature_id);
+    if (references == owner_references.features.end()) {
+        // The feature was not listed by the pass over its owner
+        m_statistics.queries++;
+        references = owner_references.features.insert({ feature_id, resolve(wfcWFeature::cast(feat)) }).first;
+    }
+    return &references->second;
+}
+
+SolidReferenceCache::SolidReferences SolidReferenceCache::resolve(wfcWFeature_ptr wfeat)
+{
+    SolidReferences references;
+
+    wfcExternalReferenceInfos_ptr parents = nullptr;
+    try {
+        parents = wfeat->GetExternalParents(wfcExternalReferenceType::wfcALL_REF_TYPES);
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        return references;
+    }
+    xcatchend
+
+    if (parents == NULL) {
+        return references;
+    }
+
+    for (int l = 0; l < parents->getarraysize(); l++)
+    {
+        auto extrefs = parents->get(l)->GetExtRefs();
+
+        if (extrefs == NULL) {
+            return references;
+        }
+
+        // each element in this array is given by a constraint and
+        // the number of parts that compose it
+        // e.g. 2 parts x 3 constraints = size(extrefs) = 6
+        // We assume there are only two parts and they are named differently
+        if (extrefs->getarraysize() == 0)
+            return references;
+
+        for (int m = 0; m < extrefs->getarraysize(); m++) {
+            auto extref = extrefs->get(m)->GetAsmcomponents()->GetPathToRef()->GetLeaf();
+            // While defining a constraint the first part is the parent link and the second part is the child link
+            if (extref && references.parent_name.empty()) {
+                references.parent_name = std::string(extref->GetFullName());
+            }
+            else if (extref && references.child_name.empty()) {
+                references.child_name = std::string(extref->GetFullName());
+            }
+            else {
+                break;
+            }
+        }
+    }
+    references.valid = true;
+    return references;
+}
+
+std::string SolidReferenceCache::getStatisticsSummary() const
+{
+    return "External references: " + std::to_string(m_statistics.queries) + " queries in " + std::to_string(m_statistics.owner_passes) +
+           " assemblies for " + std::to_string(m_statistics.lookups) + " features, " + std::to_string(getNrOfAvoidedQueries()) + " queries avoided";
+}
+
+void SolidReferenceCache::clear()
+{
+    m_owners.clear();
+    m_statistics = Statistics();
+}
+
+void SolidReferenceCache::resolveOwner(pfcSolid_ptr owner, std::unordered_map<int, SolidReferences>& references)
+{
+    pfcFeatures_ptr features = nullptr;
+    try {
+        features = owner->ListFeaturesByType(xfalse, pfcFeatureType::pfcFEATTYPE_COMPONENT);
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
+    {
+        return;
+    }
+    xcatchend
+
+    if (features == nullptr) {
+        return;
+    }
+    m_statistics.owner_passes++;
+    for (int i = 0; i < features->getarraysize(); i++) {
+        auto feat = features->get(i);
+        m_statistics.queries++;
+        references[feat->GetId()] = resolve(wfcWFeature::cast(feat));
+    }
+}
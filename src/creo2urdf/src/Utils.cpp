@@ -10,6 +10,16 @@
 
 #include <creo2urdf/Utils.h>
 
+#include <iDynTree/EigenHelpers.h>
+
+#include <Eigen/Core>
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+
 std::array<double, 3> computeUnitVectorFromAxis(pfcCurveDescriptor_ptr axis_data)
 {
     auto axis_line = pfcLineDescriptor::cast(axis_data); // cursed cast from hell
@@ -151,10 +161,9 @@ std::pair<bool, iDynTree::Transform> getTransformFromPart(pfcModel_ptr modelhdl,
     iDynTree::Transform H_child;
     auto csys_list = modelhdl->ListItems(pfcModelItemType::pfcITEM_COORD_SYS);
 
-    auto link_child_name = string(modelhdl->GetFullName());
-    
     if (csys_list->getarraysize() == 0) {
-        printToMessageWindow("There are no Coordinate Systems in the part " + link_child_name, c2uLogLevel::WARN);
+        // The name is read only for the warning, GetFullName allocates a new string at each call
+        printToMessageWindow("There are no Coordinate Systems in the part " + string(modelhdl->GetFullName()), c2uLogLevel::WARN);
 
         H_child = iDynTree::Transform::Identity();
 
@@ -195,6 +204,61 @@ std::pair<bool, iDynTree::Transform> getTransformFromPart(pfcModel_ptr modelhdl,
     return { false, H_child };
 }
 
+std::vector<std::pair<std::string, iDynTree::Transform>> getCoordinateSystems(pfcModel_ptr modelhdl, const array<double, 3>& scale) {
+
+    std::vector<std::pair<std::string, iDynTree::Transform>> coordinate_systems;
+    auto csys_list = modelhdl->ListItems(pfcModelItemType::pfcITEM_COORD_SYS);
+    coordinate_systems.reserve(csys_list->getarraysize());
+
+    for (xint i = 0; i < csys_list->getarraysize(); i++)
+    {
+        auto csys = pfcCoordSystem::cast(csys_list->get(i));
+        coordinate_systems.emplace_back(string(csys->GetName()), fromCreo(csys->GetCoordSys(), scale));
+    }
+
+    return coordinate_systems;
+}
+
+namespace {
+
+/**
+ * @brief Reads the direction and the middle point of an axis.
+ * @param axis The axis.
+ * @param csys_H_linkFrame The transform from the default csys of the part to the link frame.
+ * @param scale The scaling factor for the middle point.
+ * @return The axis, with its direction expressed in the link frame.
+ */
+AxisInfo readAxis(pfcAxis_ptr axis, const iDynTree::Transform& csys_H_linkFrame, const array<double, 3>& scale) {
+
+    AxisInfo axis_info;
+    axis_info.name = string(axis->GetName());
+
+    auto axis_data = wfcWAxis::cast(axis)->GetAxisData();
+
+    auto axis_line = pfcLineDescriptor::cast(axis_data); // cursed cast from hell
+
+    auto unit = computeUnitVectorFromAxis(axis_line);
+
+    axis_info.direction.setVal(0, unit[0]);
+    axis_info.direction.setVal(1, unit[1]);
+    axis_info.direction.setVal(2, unit[2]);
+
+    // There are just two points in the array
+
+    // We use the medium point of the axis as offset
+    pfcPoint3D_ptr pstart = axis_line->GetEnd1();
+    pfcPoint3D_ptr pend = axis_line->GetEnd2();
+    axis_info.mid_point[0] = ((pend->get(0) + pstart->get(0)) / 2.0) * scale[0];
+    axis_info.mid_point[1] = ((pend->get(1) + pstart->get(1)) / 2.0) * scale[1];
+    axis_info.mid_point[2] = ((pend->get(2) + pstart->get(2)) / 2.0) * scale[2];
+
+    axis_info.direction = csys_H_linkFrame.inverse() * axis_info.direction;  // We might benefit from performing this operation directly in Creo
+    axis_info.direction.Normalize();
+    return axis_info;
+}
+
+} // namespace
+
 std::tuple<bool, iDynTree::Direction, iDynTree::Position> getAxisFromPart(pfcModel_ptr modelhdl, const std::string& axis_name, const string& link_frame_name, const array<double, 3>& scale) {
 
     iDynTree::Direction axis_unit_vector;
@@ -229,32 +293,34 @@ std::tuple<bool, iDynTree::Direction, iDynTree::Position> getAxisFromPart(pfcMod
         return { false, axis_unit_vector, axis_mid_point_pos };
     }
 
-    auto axis_data = wfcWAxis::cast(axis)->GetAxisData();
-
-    auto axis_line = pfcLineDescriptor::cast(axis_data); // cursed cast from hell
-
-    auto& csys_H_linkFrame = getTransformFromPart(modelhdl, link_frame_name, scale).second;
-
-
-    auto unit = computeUnitVectorFromAxis(axis_line);
-
-    axis_unit_vector.setVal(0, unit[0]);
-    axis_unit_vector.setVal(1, unit[1]);
-    axis_unit_vector.setVal(2, unit[2]);
+    auto csys_H_linkFrame = getTransformFromPart(modelhdl, link_frame_name, scale).second;
+    auto axis_info = readAxis(axis, csys_H_linkFrame, scale);
+    return { true, axis_info.direction, axis_info.mid_point };
+}
 
+std::vector<AxisInfo> getAxesFromPart(pfcModel_ptr modelhdl, const std::string& link_frame_name, const array<double, 3>& scale) {
 
-    // There are just two points in the array
+    std::vector<AxisInfo> axes;
+    auto axes_list = modelhdl->ListItems(pfcModelItemType::pfcITEM_AXIS);
+    if (axes_list->getarraysize() == 0) {
+        return axes;
+    }
 
-    // We use the medium point of the axis as offset
-    pfcPoint3D_ptr pstart = axis_line->GetEnd1();
-    pfcPoint3D_ptr pend = axis_line->GetEnd2();
-    axis_mid_point_pos[0] = ((pend->get(0) + pstart->get(0)) / 2.0) * scale[0];
-    axis_mid_point_pos[1] = ((pend->get(1) + pstart->get(1)) / 2.0) * scale[1];
-    axis_mid_point_pos[2] = ((pend->get(2) + pstart->get(2)) / 2.0) * scale[2];
+    // The link frame is read once for all the axes
+    auto csys_H_linkFrame = getTransformFromPart(modelhdl, link_frame_name, scale).second;
+    for (xint i = 0; i < axes_list->getarraysize(); i++)
+    {
+        axes.push_back(readAxis(pfcAxis::cast(axes_list->get(i)), csys_H_linkFrame, scale));
+    }
+    return axes;
+}
 
-    axis_unit_vector = csys_H_linkFrame.inverse() * axis_unit_vector;  // We might benefit from performing this operation directly in Creo
-    axis_unit_vector.Normalize();
-    return { true, axis_unit_vector, axis_mid_point_pos };
+std::size_t getPeakMemoryUsage() {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
 }
 
 std::string extractFolderPath(const std::string& filePath) {
@@ -302,3 +368,56 @@ void mergeYAMLNodes(YAML::Node& dest, const YAML::Node& src) {
         dest = src;
     }
 }
+
+bool loadYamlConfigWithIncludes(const std::string& filename, YAML::Node& config)
+{
+    try 
+    {
+        config = YAML::LoadFile(filename);
+        if (config["includes"].IsDefined() && config["includes"].IsSequence()) {
+            auto folder_path = extractFolderPath(filename);
+            for (const auto& include : config["includes"]) {
+                auto include_filename = folder_path + include.as<std::string>();
+                auto include_config = YAML::LoadFile(include_filename);
+                mergeYAMLNodes(config, include_config);
+            }
+        }
+    }
+    catch (YAML::BadFile file_does_not_exist) 
+    {
+        printToMessageWindow("Configuration file " + filename + " does not exist!", c2uLogLevel::WARN);
+        return false;
+    }
+    catch (YAML::ParserException badly_formed) 
+    {
+        printToMessageWindow(badly_formed.msg, c2uLogLevel::WARN);
+        return false;
+    }
+
+    return true;
+}
+
+std::string getLinkFrameNameFromConfig(const YAML::Node& config, const std::string& urdf_link_name)
+{
+    std::string link_frame_name{ "" };
+    for (const auto& lf : config["linkFrames"]) {
+        if (lf["linkName"].Scalar() != urdf_link_name)
+        {
+            continue;
+        }
+        link_frame_name = lf["frameName"].Scalar();
+    }
+    return link_frame_name;
+}
+
+std::pair<double, double> computePoseDistance(const iDynTree::Transform& a_H_frame, const iDynTree::Transform& b_H_frame)
+{
+    Eigen::Vector3d position_error = iDynTree::toEigen(a_H_frame.getPosition()) - iDynTree::toEigen(b_H_frame.getPosition());
+
+    // Angle of the rotation a_R_b, computed with atan2 to stay accurate close to 0 and pi
+    Eigen::Matrix3d a_R_b = iDynTree::toEigen(a_H_frame.getRotation()).transpose() * iDynTree::toEigen(b_H_frame.getRotation());
+    Eigen::Vector3d axis_times_sin{ a_R_b(2, 1) - a_R_b(1, 2), a_R_b(0, 2) - a_R_b(2, 0), a_R_b(1, 0) - a_R_b(0, 1) };
+    double rotation_error = std::atan2(0.5 * axis_times_sin.norm(), 0.5 * (a_R_b.trace() - 1.0));
+
+    return { position_error.norm(), rotation_error };
+}
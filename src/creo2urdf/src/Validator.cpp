@@ -1,4 +1,3 @@
-/*
 /*
  * Copyright (C) 2006-2023 Istituto Italiano di Tecnologia (IIT)
  * All rights reserved.
@@ -8,7 +7,44 @@
  */
 
 #include <creo2urdf/Validator.h>
+#include <creo2urdf/Parallel.h>
+#include <pfcExceptions.h>
+
+#include <iDynTree/EigenHelpers.h>
+
+#include <Eigen/Eigenvalues>
+
+#include <functional>
+#include <iomanip>
+#include <random>
+
+/**
+ * @brief Sets the state of kin_dyn to the configuration of a snapshot, with the base placed as recorded in Creo.
+ * It does not call the Creo API, so it can be used by worker threads.
+ * @return True if successful, false otherwise.
+ */
+static bool setKinDynStateFromSnapshot(iDynTree::KinDynComputations& kin_dyn, const iDynTree::Model& model, const ValidationSnapshot& snapshot)
+{
+    auto base_index = model.getDefaultBaseLink();
+    if (base_index == iDynTree::LINK_INVALID_INDEX || !snapshot.has_link[base_index]) {
+        return false;
+    }
+
+    iDynTree::Vector3 gravity; gravity.zero(); gravity(2) = gravity_z;
+    iDynTree::VectorDynSize joint_velocities(model.getNrOfDOFs());
+    joint_velocities.zero();
 
+    return kin_dyn.setRobotState(snapshot.root_H_links[base_index], snapshot.joint_positions,
+                                 iDynTree::Twist::Zero(), joint_velocities, gravity);
+}
+
+/**
+ * @brief Conversion factor from the URDF joint position to the Creo regeneration value.
+ */
+static double regenerationValueConversionFactor(JointType type, const std::array<double, 3>& scale)
+{
+    return (type == JointType::Revolute) ? rad2deg : 1.0 / scale[0];
+}
 
 bool Validator::loadUrdfFromFile(const std::string& filename) {
     iDynTree::ModelLoader mdl_loader;
@@ -23,20 +59,13 @@ bool Validator::loadUrdfFromFile(const std::string& filename) {
     return true;
 }
 
-bool Validator::assignCreoTransformToLink() {
-    bool ret{ false };
+bool Validator::collectLinksAndJoints(pfcModel_ptr model_owner, const std::vector<int>& owner_path) {
 
-    iDynTree::Transform H_child = iDynTree::Transform::Identity();
+    auto components = model_owner->ListItems(pfcModelItemType::pfcITEM_FEATURE);
 
-    auto components = creo_model_ptr->ListItems(pfcModelItemType::pfcITEM_FEATURE);
-    if (components->getarraysize() == 0) {
-        printToMessageWindow("There are no FEATURES in the asm", c2uLogLevel::WARN);
-        return false;
-    }
-    // Let's first retrieve the trfs from root to all the links and store it in a map.
     for (int i = 0; i < components->getarraysize(); i++)
     {
-
+        bool ret{ false };
         auto feat = pfcFeature::cast(components->get(i));
 
         if (feat->GetFeatType() != pfcFeatureType::pfcFEATTYPE_COMPONENT)
@@ -44,124 +73,756 @@ bool Validator::assignCreoTransformToLink() {
             continue;
         }
 
+        ModelRecord* component = model_registry.retrieve(creo_session_ptr, pfcComponentFeat::cast(feat)->GetModelDescr());
+        if (component == nullptr) {
+            return false;
+        }
+        auto component_handle = component->handle;
+
+        if (component->is_skeleton)
+        {
+            continue;
+        }
+
+        std::vector<int> component_path = owner_path;
+        component_path.push_back(feat->GetId());
+
+        // The joint between the component and its parent is defined in the element tree of the component feature
+        ElementTreeManager element_tree_manager(&solid_reference_cache);
+        NameMap<JointInfo> feature_joints;
+        if (element_tree_manager.populateJointInfoFromElementTree(feat, feature_joints)) {
+            for (const auto& joint_info : feature_joints) {
+                if (joint_info.second.type != JointType::Revolute && joint_info.second.type != JointType::Linear) {
+                    continue;
+                }
+                CreoJointRecord joint_record;
+                joint_record.feat = feat;
+                joint_record.type = joint_info.second.type;
+                std::tie(joint_record.drivable, joint_record.home_value) = element_tree_manager.retrieveRegenerationValue();
+                creo_joints[getRenameElementFromConfig(joint_info.first)] = joint_record;
+            }
+        }
+
+        if (component->type == pfcMDL_ASSEMBLY) {
+            if (!collectLinksAndJoints(component_handle, component_path)) {
+                return false;
+            }
+            continue;
+        }
+
+        CreoLinkRecord link_record;
+        link_record.urdf_link_name = getRenameElementFromConfig(component->full_name);
+
+        auto link_frame_name = getLinkFrameNameFromConfig(config, link_record.urdf_link_name);
+        if (link_frame_name.empty()) {
+            std::tie(ret, link_frame_name) = getFirstCoordinateSystemName(component_handle);
+            if (!ret) {
+                return false;
+            }
+        }
+
+        std::tie(ret, link_record.csysPart_H_linkFrame) = getTransformFromPart(component_handle, link_frame_name, scale);
+        if (!ret) {
+            printToMessageWindow("Unable to get the link frame of " + link_record.urdf_link_name + ", it will not be validated", c2uLogLevel::WARN);
+            continue;
+        }
+
         xintsequence_ptr seq = xintsequence::create();
-        seq->append(feat->GetId());
+        for (auto id : component_path) {
+            seq->append(id);
+        }
+        link_record.comp_path = pfcCreateComponentPath(pfcAssembly::cast(creo_model_ptr), seq);
 
-        pfcComponentPath_ptr comp_path = pfcCreateComponentPath(pfcAssembly::cast(creo_model_ptr), seq);
-        auto modelhdl = creo_session_ptr->RetrieveModel(pfcComponentFeat::cast(feat)->GetModelDescr());
-        auto link_child_name = string(modelhdl->GetFullName());
+        creo_links.push_back(link_record);
+    }
+
+    return true;
+}
 
-        ret = true;
+bool Validator::recordCreoSnapshot(const iDynTree::VectorDynSize& joint_positions, ValidationSnapshot& snapshot) {
 
-        if (!ret)
-            return ret;
+    snapshot.joint_positions = joint_positions;
+    snapshot.root_H_links.assign(idyn_model.getNrOfLinks(), iDynTree::Transform::Identity());
+    snapshot.has_link.assign(idyn_model.getNrOfLinks(), false);
 
-        link_name_to_creo_computed_trf_map[link_child_name] = H_child;
+    for (const auto& link_record : creo_links)
+    {
+        auto link_index = idyn_model.getLinkIndex(link_record.urdf_link_name);
+        if (link_index == iDynTree::LINK_INVALID_INDEX) {
+            continue;
+        }
+
+        try {
+            snapshot.root_H_links[link_index] = fromCreo(link_record.comp_path->GetTransform(xtrue), scale) * link_record.csysPart_H_linkFrame;
+            snapshot.has_link[link_index] = true;
+        }
+        xcatchbegin
+        xcatchcip(defaultEx)
+        {
+            printToMessageWindow("Exception caught: Could not retrieve transform of " + link_record.urdf_link_name, c2uLogLevel::WARN);
+            return false;
+        }
+        xcatchend
     }
 
     return true;
 }
 
-bool Validator::validatePositions(iDynTree::VectorDynSize positions) {
+bool Validator::driveCreoToConfiguration(const iDynTree::VectorDynSize& joint_positions) {
 
-    // Setting the `world_T_base`
-    iDynTree::Vector3 gravity; gravity.zero(); gravity(2) = gravity_z;
-    auto H_base = link_name_to_creo_computed_trf_map.at("SIM_ECUB_HEAD_NECK_1");
+    for (const auto& joint : creo_joints)
+    {
+        if (!joint.second.drivable) {
+            continue;
+        }
+
+        auto joint_index = idyn_model.getJointIndex(joint.first);
+        if (joint_index == iDynTree::JOINT_INVALID_INDEX) {
+            continue;
+        }
+
+        double position = joint_positions(idyn_model.getJoint(joint_index)->getDOFsOffset());
+        double value = joint.second.home_value + joint.second.direction * position * regenerationValueConversionFactor(joint.second.type, scale);
 
+        ElementTreeManager element_tree_manager;
+        if (!element_tree_manager.setRegenerationValue(joint.second.feat, value)) {
+            return false;
+        }
+    }
 
-    if (!computer.setRobotState(H_base, positions,
-        iDynTree::Twist(),
-        iDynTree::VectorDynSize(idyn_model.getNrOfDOFs()),
-        gravity))
+    try {
+        pfcSolid::cast(creo_model_ptr)->Regenerate(nullptr);
+    }
+    xcatchbegin
+    xcatchcip(defaultEx)
     {
-        printToMessageWindow("Could not set the robot state!", c2uLogLevel::WARN);
+        printToMessageWindow("Exception caught: Could not regenerate the assembly: " + string(pfcXPFC::cast(defaultEx)->GetMessage()), c2uLogLevel::WARN);
         return false;
     }
+    xcatchend
 
-    // Lets ask the same transform to idyntree and check the difference w/ the
-    // creo computed one
-    for (int i = 0; i < idyn_model.getNrOfLinks(); i++) {
-        auto link_name = idyn_model.getLinkName(i);
-        auto idyn_trf = computer.getWorldTransform(link_name);
-        auto creo_trf = link_name_to_creo_computed_trf_map.at(link_name);
+    return true;
+}
 
-        iDynTree::Position position_error = idyn_trf.getPosition() - creo_trf.getPosition();
-        double position_error_mag = sqrt(position_error[0] * position_error[0] + 
-                                         position_error[1] * position_error[1] + 
-                                         position_error[2] * position_error[2]);
-   
-        if (position_error_mag > epsilon)
-        {
-            printToMessageWindow("Position error for " + link_name + " is outside tolerance! : " + to_string(position_error_mag), c2uLogLevel::WARN);
+void Validator::calibrateJointDirections(const ValidationSnapshot& home_snapshot) {
+
+    iDynTree::KinDynComputations kin_dyn;
+    kin_dyn.loadRobotModel(idyn_model);
+
+    if (!setKinDynStateFromSnapshot(kin_dyn, idyn_model, home_snapshot)) {
+        printToMessageWindow("The base link " + idyn_model.getLinkName(idyn_model.getDefaultBaseLink()) + " was not found in the assembly", c2uLogLevel::WARN);
+        for (auto& joint : creo_joints) {
+            joint.second.drivable = false;
         }
+        return;
+    }
 
-        double angle_error;
+    iDynTree::VectorDynSize zero_positions(idyn_model.getNrOfDOFs());
+    zero_positions.zero();
 
-        angle_error = idyn_trf.getRotation().asRPY()[0] - creo_trf.getRotation().asRPY()[0];
-        if (angle_error > epsilon * 1e3)
-        {
-            printToMessageWindow("Roll error for " + link_name + " is outside tolerance! " + to_string(angle_error), c2uLogLevel::WARN);
+    for (auto& joint : creo_joints)
+    {
+        if (!joint.second.drivable) {
+            continue;
         }
 
-        angle_error = idyn_trf.getRotation().asRPY()[1] - creo_trf.getRotation().asRPY()[1];
-        if (angle_error > epsilon * 1e3)
-        {
-            printToMessageWindow("Pitch error for " + link_name + " is outside tolerance! " + to_string(angle_error), c2uLogLevel::WARN);
+        auto joint_index = idyn_model.getJointIndex(joint.first);
+        if (joint_index == iDynTree::JOINT_INVALID_INDEX) {
+            joint.second.drivable = false;
+            continue;
         }
 
-        angle_error = idyn_trf.getRotation().asRPY()[2] - creo_trf.getRotation().asRPY()[2];
-        if (angle_error > epsilon * 1e3)
-        {
-            printToMessageWindow("Yaw error for " + link_name + " is outside tolerance! " + to_string(angle_error), c2uLogLevel::WARN);
+        auto child_index = idyn_model.getJoint(joint_index)->getSecondAttachedLink();
+        auto dof_index = idyn_model.getJoint(joint_index)->getDOFsOffset();
+        if (!home_snapshot.has_link[child_index]) {
+            joint.second.drivable = false;
+            continue;
+        }
+
+        // Constant offset between the Creo and the URDF child link frames
+        setKinDynStateFromSnapshot(kin_dyn, idyn_model, home_snapshot);
+        auto creoChild_H_urdfChild = home_snapshot.root_H_links[child_index].inverse() * kin_dyn.getWorldTransform(child_index);
+
+        // Move only this joint by a small amount, and check which sign of the URDF joint position matches the assembly
+        double probe = (joint.second.type == JointType::Revolute) ? 10.0 * deg2rad : 0.01;
+        iDynTree::VectorDynSize probe_positions = zero_positions;
+        probe_positions(dof_index) = probe;
+
+        joint.second.direction = 1.0;
+        ValidationSnapshot probe_snapshot;
+        bool ok = driveCreoToConfiguration(probe_positions) && recordCreoSnapshot(probe_positions, probe_snapshot);
+        if (!ok || !setKinDynStateFromSnapshot(kin_dyn, idyn_model, probe_snapshot)) {
+            printToMessageWindow("Unable to drive joint " + joint.first + ", it will be kept in its current position", c2uLogLevel::WARN);
+            joint.second.drivable = false;
+            driveCreoToConfiguration(zero_positions);
+            continue;
+        }
+
+        auto creo_root_H_urdfChild = probe_snapshot.root_H_links[child_index] * creoChild_H_urdfChild;
+        auto probeError = [&](double position) {
+            probe_positions(dof_index) = position;
+            kin_dyn.setJointPos(probe_positions);
+            auto distance = computePoseDistance(creo_root_H_urdfChild, kin_dyn.getWorldTransform(child_index));
+            return (joint.second.type == JointType::Revolute) ? distance.second : distance.first;
+        };
+        joint.second.direction = (probeError(-probe) < probeError(probe)) ? -1.0 : 1.0;
+
+        driveCreoToConfiguration(zero_positions);
+    }
+}
+
+std::vector<iDynTree::VectorDynSize> Validator::sampleJointConfigurations(const JointTable& csv, std::size_t nr_of_samples, unsigned int seed, bool drivable_only) {
+
+    std::mt19937 generator(seed);
+    std::vector<iDynTree::VectorDynSize> samples;
+    samples.reserve(nr_of_samples);
+
+    // Limits of the joints that can be moved, in URDF units
+    std::vector<std::tuple<std::size_t, double, double>> sampled_dofs;
+    for (iDynTree::JointIndex joint_index = 0; joint_index < static_cast<iDynTree::JointIndex>(idyn_model.getNrOfJoints()); joint_index++)
+    {
+        auto joint = idyn_model.getJoint(joint_index);
+        auto joint_name = idyn_model.getJointName(joint_index);
+        if (joint->getNrOfDOFs() != 1) {
+            continue;
+        }
+        if (drivable_only && (creo_joints.find(joint_name) == creo_joints.end() || !creo_joints.at(joint_name).drivable)) {
+            continue;
+        }
+
+        const bool revolute = dynamic_cast<const iDynTree::RevoluteJoint*>(joint) != nullptr;
+        double conversion_factor = revolute ? deg2rad : 1.0;
+        double lower = -std::numeric_limits<double>::infinity();
+        double upper = std::numeric_limits<double>::infinity();
+        if (const JointParameters* parameters = csv.find(joint_name)) {
+            lower = parameters->lower_limit * conversion_factor;
+            upper = parameters->upper_limit * conversion_factor;
+        }
+        // The limits left empty in the csv are taken from the URDF
+        if ((std::isinf(lower) || std::isinf(upper)) && joint->hasPosLimits()) {
+            lower = joint->getMinPosLimit(0);
+            upper = joint->getMaxPosLimit(0);
+        }
+        // An unlimited revolute joint is sampled over a turn, while an unlimited prismatic joint has no meaningful range
+        if ((std::isinf(lower) || std::isinf(upper)) && revolute) {
+            lower = -M_PI;
+            upper = M_PI;
+        }
+
+        if (std::isinf(lower) || std::isinf(upper) || upper < lower) {
+            continue;
+        }
+        sampled_dofs.emplace_back(joint->getDOFsOffset(), lower, upper);
+    }
+
+    for (std::size_t s = 0; s < nr_of_samples; s++)
+    {
+        iDynTree::VectorDynSize positions(idyn_model.getNrOfDOFs());
+        positions.zero();
+        for (const auto& dof : sampled_dofs) {
+            std::uniform_real_distribution<double> distribution(std::get<1>(dof), std::get<2>(dof));
+            positions(std::get<0>(dof)) = distribution(generator);
+        }
+        samples.push_back(positions);
+    }
+
+    return samples;
+}
+
+bool Validator::loadSnapshotsFromFile(const std::string& filename, std::vector<ValidationSnapshot>& snapshots) {
+
+    YAML::Node snapshots_config;
+    try {
+        snapshots_config = YAML::LoadFile(filename);
+    }
+    catch (YAML::Exception& e) {
+        printToMessageWindow("Unable to load the snapshot file " + filename + ": " + e.msg, c2uLogLevel::WARN);
+        return false;
+    }
+
+    for (const auto& s : snapshots_config["snapshots"])
+    {
+        ValidationSnapshot snapshot;
+        snapshot.joint_positions.resize(idyn_model.getNrOfDOFs());
+        snapshot.joint_positions.zero();
+        snapshot.root_H_links.assign(idyn_model.getNrOfLinks(), iDynTree::Transform::Identity());
+        snapshot.has_link.assign(idyn_model.getNrOfLinks(), false);
+
+        for (const auto& jp : s["jointPositions"]) {
+            auto joint_index = idyn_model.getJointIndex(jp.first.Scalar());
+            if (joint_index == iDynTree::JOINT_INVALID_INDEX || idyn_model.getJoint(joint_index)->getNrOfDOFs() != 1) {
+                printToMessageWindow("Joint " + jp.first.Scalar() + " of the snapshot file is not in the model", c2uLogLevel::WARN);
+                continue;
+            }
+            snapshot.joint_positions(idyn_model.getJoint(joint_index)->getDOFsOffset()) = jp.second.as<double>();
+        }
+
+        for (const auto& lp : s["linkPoses"]) {
+            auto link_index = idyn_model.getLinkIndex(lp.first.Scalar());
+            if (link_index == iDynTree::LINK_INVALID_INDEX) {
+                printToMessageWindow("Link " + lp.first.Scalar() + " of the snapshot file is not in the model", c2uLogLevel::WARN);
+                continue;
+            }
+            auto xyzrpy = lp.second.as<std::array<double, 6>>();
+            snapshot.root_H_links[link_index].setPosition({ xyzrpy[0], xyzrpy[1], xyzrpy[2] });
+            snapshot.root_H_links[link_index].setRotation(iDynTree::Rotation::RPY(xyzrpy[3], xyzrpy[4], xyzrpy[5]));
+            snapshot.has_link[link_index] = true;
         }
 
-        //printToMessageWindow("IDYN TRANSFORM: " + idyn_trf.toString());
-        //printToMessageWindow("CREO TRANSFORM: " + creo_trf.toString());
+        snapshots.push_back(snapshot);
     }
 
+    return !snapshots.empty();
+}
+
+std::vector<LinkValidationError> Validator::validatePositions(const std::vector<ValidationSnapshot>& snapshots) {
+
+    const std::size_t nr_of_links = idyn_model.getNrOfLinks();
+    std::vector<LinkValidationError> errors(nr_of_links);
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        errors[l].link_name = idyn_model.getLinkName(l);
+    }
+
+    if (snapshots.empty()) {
+        return errors;
+    }
+
+    // The first snapshot is the reference: the URDF link frames may differ from the Creo ones by a constant
+    // offset (e.g. when they are moved to be compatible with URDF), so that offset is computed here once
+    iDynTree::KinDynComputations kin_dyn;
+    kin_dyn.loadRobotModel(idyn_model);
+    if (!setKinDynStateFromSnapshot(kin_dyn, idyn_model, snapshots.front())) {
+        printToMessageWindow("The base link " + idyn_model.getLinkName(idyn_model.getDefaultBaseLink()) + " was not found in the reference snapshot", c2uLogLevel::WARN);
+        return errors;
+    }
+
+    std::vector<iDynTree::Transform> creoLink_H_urdfLink(nr_of_links, iDynTree::Transform::Identity());
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        if (!snapshots.front().has_link[l]) {
+            continue;
+        }
+        auto root_H_urdfLink = kin_dyn.getWorldTransform(l);
+        creoLink_H_urdfLink[l] = snapshots.front().root_H_links[l].inverse() * root_H_urdfLink;
+        std::tie(errors[l].home_position_offset, errors[l].home_rotation_offset) = computePoseDistance(snapshots.front().root_H_links[l], root_H_urdfLink);
+    }
+
+    // Forward kinematics of all the configurations, each worker with its own KinDynComputations
+    const std::size_t nr_of_snapshots = snapshots.size();
+    std::vector<double> position_errors(nr_of_snapshots * nr_of_links, -1.0);
+    std::vector<double> rotation_errors(nr_of_snapshots * nr_of_links, -1.0);
+
+    const iDynTree::Model& model = idyn_model;
+    parallelForChunks(nr_of_snapshots, [&](std::size_t begin, std::size_t end, std::size_t) {
+        iDynTree::KinDynComputations worker_kin_dyn;
+        worker_kin_dyn.loadRobotModel(model);
+
+        for (std::size_t s = begin; s < end; s++) {
+            if (!setKinDynStateFromSnapshot(worker_kin_dyn, model, snapshots[s])) {
+                continue;
+            }
+            for (std::size_t l = 0; l < nr_of_links; l++) {
+                if (!snapshots[s].has_link[l]) {
+                    continue;
+                }
+                auto expected_root_H_urdfLink = snapshots[s].root_H_links[l] * creoLink_H_urdfLink[l];
+                std::tie(position_errors[s * nr_of_links + l], rotation_errors[s * nr_of_links + l]) =
+                    computePoseDistance(expected_root_H_urdfLink, worker_kin_dyn.getWorldTransform(l));
+            }
+        }
+    });
+
+    for (std::size_t l = 0; l < nr_of_links; l++) {
+        auto& link_error = errors[l];
+        for (std::size_t s = 0; s < nr_of_snapshots; s++) {
+            double position_error = position_errors[s * nr_of_links + l];
+            double rotation_error = rotation_errors[s * nr_of_links + l];
+            if (position_error < 0.0) {
+                continue;
+            }
+            if (position_error > link_error.max_position_error) {
+                link_error.max_position_error = position_error;
+                link_error.worst_snapshot = s;
+            }
+            link_error.max_rotation_error = std::max(link_error.max_rotation_error, rotation_error);
+            link_error.mean_position_error += position_error;
+            link_error.mean_rotation_error += rotation_error;
+            link_error.nr_of_samples++;
+        }
+        if (link_error.nr_of_samples > 0) {
+            link_error.mean_position_error /= link_error.nr_of_samples;
+            link_error.mean_rotation_error /= link_error.nr_of_samples;
+        }
+    }
+
+    return errors;
+}
+
+DynamicsSweepReport Validator::runDynamicsSweep(const std::vector<iDynTree::VectorDynSize>& samples, const JointTable& csv) {
+
+    const std::size_t nr_of_dofs = idyn_model.getNrOfDOFs();
+    DynamicsSweepReport report;
+    report.nr_of_samples = samples.size();
+    report.joints.resize(nr_of_dofs);
+
+    for (iDynTree::JointIndex joint_index = 0; joint_index < static_cast<iDynTree::JointIndex>(idyn_model.getNrOfJoints()); joint_index++) {
+        auto joint = idyn_model.getJoint(joint_index);
+        if (joint->getNrOfDOFs() != 1) {
+            continue;
+        }
+        auto& info = report.joints[joint->getDOFsOffset()];
+        info.joint_name = idyn_model.getJointName(joint_index);
+        if (const JointParameters* parameters = csv.find(info.joint_name)) {
+            info.effort_limit = parameters->effort_limit;
+        }
+    }
+
+    if (samples.empty() || nr_of_dofs == 0) {
+        return report;
+    }
+
+    // Each worker accumulates its own maxima, merged afterwards
+    const std::size_t nr_of_workers = getNumberOfWorkers(samples.size());
+    std::vector<DynamicsSweepReport> partial_reports(nr_of_workers, report);
+
+    const iDynTree::Model& model = idyn_model;
+    parallelForChunks(samples.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        auto& partial = partial_reports[worker];
+
+        iDynTree::KinDynComputations kin_dyn;
+        kin_dyn.loadRobotModel(model);
+        kin_dyn.setFloatingBase(model.getLinkName(model.getDefaultBaseLink()));
+
+        iDynTree::Vector3 gravity; gravity.zero(); gravity(2) = gravity_z;
+        iDynTree::VectorDynSize joint_velocities(nr_of_dofs);
+        joint_velocities.zero();
+        iDynTree::FreeFloatingMassMatrix mass_matrix(model);
+        iDynTree::FreeFloatingGeneralizedTorques gravity_torques(model);
+
+        for (std::size_t s = begin; s < end; s++) {
+            if (!kin_dyn.setRobotState(iDynTree::Transform::Identity(), samples[s], iDynTree::Twist::Zero(), joint_velocities, gravity) ||
+                !kin_dyn.getFreeFloatingMassMatrix(mass_matrix) ||
+                !kin_dyn.generalizedGravityForces(gravity_torques)) {
+                continue;
+            }
+
+            // The base is fixed, so only the joint-space block matters
+            const Eigen::MatrixXd joint_mass_matrix = iDynTree::toEigen(mass_matrix).bottomRightCorner(nr_of_dofs, nr_of_dofs);
+            Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(joint_mass_matrix, Eigen::EigenvaluesOnly);
+            const double min_eigenvalue = solver.eigenvalues().minCoeff();
+            const double condition_number = (min_eigenvalue > 0.0) ? solver.eigenvalues().maxCoeff() / min_eigenvalue
+                                                                   : std::numeric_limits<double>::infinity();
+            if (condition_number > partial.worst_condition_number) {
+                partial.worst_condition_number = condition_number;
+                partial.worst_conditioned_sample = s;
+            }
+
+            const auto tau = iDynTree::toEigen(gravity_torques.jointTorques());
+            for (std::size_t dof = 0; dof < nr_of_dofs; dof++) {
+                auto& info = partial.joints[dof];
+                if (std::abs(tau(dof)) > info.peak_gravity_torque) {
+                    info.peak_gravity_torque = std::abs(tau(dof));
+                    info.peak_sample = s;
+                }
+                info.min_mass_matrix_diagonal = std::min(info.min_mass_matrix_diagonal, joint_mass_matrix(dof, dof));
+            }
+        }
+    });
+
+    for (const auto& partial : partial_reports) {
+        if (partial.worst_condition_number > report.worst_condition_number) {
+            report.worst_condition_number = partial.worst_condition_number;
+            report.worst_conditioned_sample = partial.worst_conditioned_sample;
+        }
+        for (std::size_t dof = 0; dof < nr_of_dofs; dof++) {
+            auto& info = report.joints[dof];
+            if (partial.joints[dof].peak_gravity_torque > info.peak_gravity_torque) {
+                info.peak_gravity_torque = partial.joints[dof].peak_gravity_torque;
+                info.peak_sample = partial.joints[dof].peak_sample;
+            }
+            info.min_mass_matrix_diagonal = std::min(info.min_mass_matrix_diagonal, partial.joints[dof].min_mass_matrix_diagonal);
+        }
+    }
+
+    return report;
+}
+
+std::vector<std::string> Validator::findTinyInertiaLinks(double min_mass, double min_inertia) {
+
+    std::vector<std::string> tiny_links;
+    for (iDynTree::LinkIndex link_index = 0; link_index < static_cast<iDynTree::LinkIndex>(idyn_model.getNrOfLinks()); link_index++) {
+        const auto& inertia = idyn_model.getLink(link_index)->getInertia();
+        const auto link_name = idyn_model.getLinkName(link_index);
+        if (inertia.getMass() < min_mass) {
+            tiny_links.push_back(link_name + " has mass " + to_string(inertia.getMass()) + " kg");
+            continue;
+        }
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(iDynTree::toEigen(inertia.getRotationalInertiaWrtCenterOfMass()), Eigen::EigenvaluesOnly);
+        if (solver.eigenvalues().minCoeff() < min_inertia) {
+            tiny_links.push_back(link_name + " has principal moment of inertia " + to_string(solver.eigenvalues().minCoeff()) + " kg m^2");
+        }
+    }
+    return tiny_links;
+}
+
+bool Validator::writeDynamicsReport(const std::string& filename, const DynamicsSweepReport& report) {
+
+    std::ofstream output(filename);
+    if (!output.is_open()) {
+        printToMessageWindow("Unable to write the dynamics report " + filename, c2uLogLevel::WARN);
+        return false;
+    }
+
+    output << "joint_name,effort_limit,peak_gravity_torque,peak_gravity_torque_ratio,peak_sample,min_mass_matrix_diagonal\n";
+    output << std::setprecision(9);
+    for (const auto& j : report.joints) {
+        if (j.joint_name.empty()) {
+            continue;
+        }
+        // A non-positive or infinite effort limit is unspecified, and leaves the ratio empty
+        const bool has_effort_limit = j.effort_limit > 0.0 && std::isfinite(j.effort_limit);
+        output << j.joint_name << "," << j.effort_limit << "," << j.peak_gravity_torque << ",";
+        if (has_effort_limit) {
+            output << j.peak_gravity_torque / j.effort_limit;
+        }
+        output << "," << j.peak_sample << "," << j.min_mass_matrix_diagonal << "\n";
+    }
+    output.close();
+
     return true;
+}
+
+bool Validator::writeReport(const std::string& filename, const std::vector<LinkValidationError>& errors) {
 
+    std::ofstream report(filename);
+    if (!report.is_open()) {
+        printToMessageWindow("Unable to write the validation report " + filename, c2uLogLevel::WARN);
+        return false;
+    }
+
+    report << "link_name,samples,home_position_offset,home_rotation_offset,max_position_error,mean_position_error,max_rotation_error,mean_rotation_error,worst_sample\n";
+    report << std::setprecision(9);
+    for (const auto& e : errors) {
+        report << e.link_name << "," << e.nr_of_samples << ","
+               << e.home_position_offset << "," << e.home_rotation_offset << ","
+               << e.max_position_error << "," << e.mean_position_error << ","
+               << e.max_rotation_error << "," << e.mean_rotation_error << ","
+               << e.worst_snapshot << "\n";
+    }
+    report.close();
+
+    return true;
+}
+
+std::string Validator::getRenameElementFromConfig(const std::string& elem_name) {
+    return rename_table.getRenamed(elem_name);
 }
 
 void Validator::OnCommand() {
 
-    printToMessageWindow("Model validation is not yet implemented", c2uLogLevel::INFO);
+    // The paths, the configuration and the model are reset on every exit, so that the next run asks for them again
+    struct StateReset {
+        std::function<void()> reset;
+        ~StateReset() { reset(); }
+    } state_reset{ [this]() {
+        m_urdf_path.clear();
+        m_yaml_path.clear();
+        m_csv_path.clear();
+        config = YAML::Node();
+        creo_model_ptr = nullptr;
+    } };
 
-    /*
-    iDynRedirectErrors idyn_redirect;
-    idyn_redirect.redirectBuffer(std::cerr.rdbuf(), "iDynTreeErrors.txt");
+    creo_session_ptr = pfcGetProESession();
+    if (!creo_session_ptr) {
+        printToMessageWindow("Failed to get the session", c2uLogLevel::WARN);
+        return;
+    }
+    if (!creo_model_ptr) {
+        creo_model_ptr = creo_session_ptr->GetCurrentModel();
+    }
+    if (!creo_model_ptr || creo_model_ptr->GetType() != pfcMDL_ASSEMBLY) {
+        printToMessageWindow("The validation requires an assembly", c2uLogLevel::WARN);
+        creo_model_ptr = nullptr;
+        return;
+    }
 
-    if (!loadUrdfFromFile("model.urdf")) {
+    if (m_urdf_path.empty()) {
+        auto urdf_file_open_option = pfcFileOpenOptions::Create("*.urdf");
+        urdf_file_open_option->SetDialogLabel("Select the urdf");
+        m_urdf_path = string(creo_session_ptr->UIOpenFile(urdf_file_open_option));
+    }
+    if (m_yaml_path.empty()) {
+        auto yaml_file_open_option = pfcFileOpenOptions::Create("*.yml,*.yaml");
+        yaml_file_open_option->SetDialogLabel("Select the yaml");
+        m_yaml_path = string(creo_session_ptr->UIOpenFile(yaml_file_open_option));
+    }
+    if (!loadYamlConfigWithIncludes(m_yaml_path, config)) {
+        printToMessageWindow("Failed to run the validation!", c2uLogLevel::WARN);
         return;
     }
+    rename_table.load(config["rename"]);
+    if (m_csv_path.empty()) {
+        auto csv_file_open_option = pfcFileOpenOptions::Create("*.csv");
+        csv_file_open_option->SetDialogLabel("Select the csv");
+        m_csv_path = string(creo_session_ptr->UIOpenFile(csv_file_open_option));
+    }
+    JointTable joints_csv_table;
+    std::vector<std::string> csv_errors;
+    joints_csv_table.load(m_csv_path, csv_errors);
+    for (const auto& error : csv_errors) {
+        printToMessageWindow(error, c2uLogLevel::WARN);
+    }
 
-    creo_session_ptr = pfcGetProESession();
-    creo_model_ptr = creo_session_ptr->GetCurrentModel();
+    if (config["scale"].IsDefined()) {
+        scale = config["scale"].as<std::array<double, 3>>();
+    }
 
-    iDynTree::VectorDynSize positions(idyn_model.getNrOfDOFs());
-    for (int i = 0; i < idyn_model.getNrOfJoints(); i++) {
-        printToMessageWindow("Please insert value for joint " + idyn_model.getJointName(i), c2uLogLevel::PROMPT);
-        positions[i] = creo_session_ptr->UIReadRealMessage(-360.0, 360.0) * deg2rad;
-        printToMessageWindow("joint" + to_string(i) + " value " + to_string(positions[i]), c2uLogLevel::INFO);
+    std::size_t nr_of_samples = 20;
+    unsigned int seed = 0;
+    double position_tolerance = 1e-5;
+    double rotation_tolerance = 1e-4;
+    const auto& validation_config = config["validation"];
+    if (validation_config["samples"].IsDefined()) {
+        nr_of_samples = validation_config["samples"].as<std::size_t>();
+    }
+    if (validation_config["seed"].IsDefined()) {
+        seed = validation_config["seed"].as<unsigned int>();
+    }
+    if (validation_config["positionTolerance"].IsDefined()) {
+        position_tolerance = validation_config["positionTolerance"].as<double>();
     }
+    if (validation_config["rotationTolerance"].IsDefined()) {
+        rotation_tolerance = validation_config["rotationTolerance"].as<double>();
+    }
+
+    iDynRedirectErrors idyn_redirect;
+    idyn_redirect.redirectBuffer(std::cerr.rdbuf(), "iDynTreeErrors.txt");
 
-    if (!assignCreoTransformToLink()) {
+    if (!loadUrdfFromFile(m_urdf_path)) {
         return;
     }
 
-    printToMessageWindow("Running model validation");
+    std::vector<ValidationSnapshot> snapshots;
+    if (validation_config["snapshotFile"].IsDefined()) {
+        if (!loadSnapshotsFromFile(extractFolderPath(m_yaml_path) + validation_config["snapshotFile"].Scalar(), snapshots)) {
+            printToMessageWindow("Failed to load the recorded snapshots", c2uLogLevel::WARN);
+            return;
+        }
+    }
+    else {
+        creo_links.clear();
+        creo_joints.clear();
+        solid_reference_cache.startRun();
+        model_registry.clear();
+        if (!collectLinksAndJoints(creo_model_ptr, {})) {
+            printToMessageWindow("Failed to process the assembly", c2uLogLevel::WARN);
+            return;
+        }
+        printToMessageWindow(solid_reference_cache.getStatisticsSummary());
+        printToMessageWindow(model_registry.getStatisticsSummary());
+
+        // The current configuration of the assembly corresponds to all the URDF joints in 0
+        iDynTree::VectorDynSize home_positions(idyn_model.getNrOfDOFs());
+        home_positions.zero();
+        ValidationSnapshot home_snapshot;
+        if (!recordCreoSnapshot(home_positions, home_snapshot)) {
+            return;
+        }
+        snapshots.push_back(home_snapshot);
+
+        calibrateJointDirections(home_snapshot);
+
+        printToMessageWindow("Driving the assembly to " + to_string(nr_of_samples) + " configurations");
+        for (const auto& positions : sampleJointConfigurations(joints_csv_table, nr_of_samples, seed)) {
+            ValidationSnapshot snapshot;
+            if (!driveCreoToConfiguration(positions) || !recordCreoSnapshot(positions, snapshot)) {
+                printToMessageWindow("Unable to record a sampled configuration, skipping it", c2uLogLevel::WARN);
+                continue;
+            }
+            snapshots.push_back(snapshot);
+        }
+
+        // Restore the configuration the assembly had before the validation
+        driveCreoToConfiguration(home_positions);
+    }
+
+    printToMessageWindow("Running model validation on " + to_string(snapshots.size()) + " configurations");
 
-    computer.loadRobotModel(idyn_model);
+    auto errors = validatePositions(snapshots);
+    auto report_path = extractFolderPath(m_urdf_path) + "validation_report.csv";
+    writeReport(report_path, errors);
 
-    if (!validatePositions(positions))
+    std::size_t nr_of_failed_links = 0;
+    for (const auto& e : errors) {
+        if (e.max_position_error > position_tolerance || e.max_rotation_error > rotation_tolerance) {
+            printToMessageWindow("Pose error for " + e.link_name + " is outside tolerance! position: " + to_string(e.max_position_error) +
+                                 " m, rotation: " + to_string(e.max_rotation_error) + " rad", c2uLogLevel::WARN);
+            nr_of_failed_links++;
+        }
+    }
+
+    if (nr_of_failed_links > 0)
     {
-        printToMessageWindow("Validation unsuccessful!", c2uLogLevel::WARN);
+        printToMessageWindow("Validation unsuccessful for " + to_string(nr_of_failed_links) + " links, see " + report_path, c2uLogLevel::WARN);
     }
     else
     {
-        printToMessageWindow("Validation successful!");
+        printToMessageWindow("Validation successful! Report written in " + report_path);
+    }
+
+    const auto& dynamics_config = validation_config["dynamics"];
+    if (dynamics_config["enabled"].IsDefined() && dynamics_config["enabled"].as<bool>()) {
+        std::size_t nr_of_dynamics_samples = 200;
+        double max_condition_number = 1e8;
+        double min_mass = 1e-6;
+        double min_inertia = 1e-10;
+        if (dynamics_config["samples"].IsDefined()) {
+            nr_of_dynamics_samples = dynamics_config["samples"].as<std::size_t>();
+        }
+        if (dynamics_config["maxConditionNumber"].IsDefined()) {
+            max_condition_number = dynamics_config["maxConditionNumber"].as<double>();
+        }
+        if (dynamics_config["minMass"].IsDefined()) {
+            min_mass = dynamics_config["minMass"].as<double>();
+        }
+        if (dynamics_config["minInertia"].IsDefined()) {
+            min_inertia = dynamics_config["minInertia"].as<double>();
+        }
+
+        printToMessageWindow("Running the dynamics sweep on " + to_string(nr_of_dynamics_samples) + " configurations");
+
+        // The dynamics does not depend on Creo, so all the joints are sampled
+        auto dynamics_samples = sampleJointConfigurations(joints_csv_table, nr_of_dynamics_samples, seed, false);
+        auto dynamics_report = runDynamicsSweep(dynamics_samples, joints_csv_table);
+        auto dynamics_report_path = extractFolderPath(m_urdf_path) + "dynamics_report.csv";
+        writeDynamicsReport(dynamics_report_path, dynamics_report);
+
+        std::size_t nr_of_dynamics_issues = 0;
+        if (dynamics_report.worst_condition_number > max_condition_number) {
+            printToMessageWindow("The condition number of the mass matrix reaches " + to_string(dynamics_report.worst_condition_number) +
+                                 " in sample " + to_string(dynamics_report.worst_conditioned_sample), c2uLogLevel::WARN);
+            nr_of_dynamics_issues++;
+        }
+        for (const auto& j : dynamics_report.joints) {
+            // A non-positive effort limit is considered not specified
+            if (!j.joint_name.empty() && j.effort_limit > 0.0 && std::isfinite(j.effort_limit) && j.peak_gravity_torque > j.effort_limit) {
+                printToMessageWindow("The gravity torque of " + j.joint_name + " reaches " + to_string(j.peak_gravity_torque) +
+                                     ", above the effort limit " + to_string(j.effort_limit), c2uLogLevel::WARN);
+                nr_of_dynamics_issues++;
+            }
+        }
+        for (const auto& tiny_link : findTinyInertiaLinks(min_mass, min_inertia)) {
+            printToMessageWindow("Tiny inertia: " + tiny_link, c2uLogLevel::WARN);
+            nr_of_dynamics_issues++;
+        }
+
+        if (nr_of_dynamics_issues > 0) {
+            printToMessageWindow("Dynamics sweep found " + to_string(nr_of_dynamics_issues) + " issues, see " + dynamics_report_path, c2uLogLevel::WARN);
+        }
+        else {
+            printToMessageWindow("Dynamics sweep successful! Worst condition number " + to_string(dynamics_report.worst_condition_number) +
+                                 ", report written in " + dynamics_report_path);
+        }
     }
-    */
 
     return;
 }
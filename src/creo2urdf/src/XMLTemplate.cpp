@@ -0,0 +1,119 @@
+/**
+ * @file XMLTemplate.cpp
+ * @brief Contains definitions for the XMLTemplate class and the helpers used to fill it.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/XMLTemplate.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+const std::string slot_marker_prefix = "c2u-slot-";
+}
+
+std::string XMLTemplate::getSlotMarker(std::size_t slot)
+{
+    return slot_marker_prefix + std::to_string(slot) + "-";
+}
+
+bool XMLTemplate::compile(xmlDocPtr doc, xmlNodePtr root_node, std::size_t nr_of_slots)
+{
+    xmlOutputBufferPtr doc_buffer = xmlAllocOutputBuffer(NULL);
+    xmlNodeDumpOutput(doc_buffer, doc, root_node, 0, 1, NULL);
+    const std::string serialised((char*)xmlBufContent(doc_buffer->buffer));
+    xmlOutputBufferClose(doc_buffer);
+    return compile(serialised, nr_of_slots);
+}
+
+bool XMLTemplate::compile(const std::string& serialised, std::size_t nr_of_slots)
+{
+    m_literals.assign(1, "");
+    m_slots.clear();
+    m_nr_of_slots = nr_of_slots;
+
+    std::size_t pos = 0;
+    while (true) {
+        const auto marker = serialised.find(slot_marker_prefix, pos);
+        if (marker == std::string::npos) {
+            m_literals.back().append(serialised, pos, std::string::npos);
+            return true;
+        }
+        m_literals.back().append(serialised, pos, marker - pos);
+
+        const auto digits = marker + slot_marker_prefix.size();
+        char* digits_end = nullptr;
+        const auto slot = std::strtoul(serialised.c_str() + digits, &digits_end, 10);
+        const auto end = static_cast<std::size_t>(digits_end - serialised.c_str());
+        if (end == digits || end >= serialised.size() || serialised[end] != '-' || slot >= nr_of_slots) {
+            return false;
+        }
+        m_slots.push_back(slot);
+        m_literals.emplace_back();
+        pos = end + 1;
+    }
+}
+
+std::string XMLTemplate::fill(const std::string* values) const
+{
+    std::size_t size = 0;
+    for (const auto& literal : m_literals) {
+        size += literal.size();
+    }
+    for (auto slot : m_slots) {
+        size += values[slot].size();
+    }
+
+    std::string xml;
+    xml.reserve(size);
+    xml += m_literals[0];
+    for (std::size_t i = 0; i < m_slots.size(); i++) {
+        xml += values[m_slots[i]];
+        xml += m_literals[i + 1];
+    }
+    return xml;
+}
+
+std::string escapeXML(const std::string& value)
+{
+    if (value.find_first_of("&<>\"") == std::string::npos) {
+        return value;
+    }
+    std::string escaped;
+    escaped.reserve(value.size() + 16);
+    for (char c : value) {
+        switch (c) {
+        case '&': escaped += "&amp;"; break;
+        case '<': escaped += "&lt;"; break;
+        case '>': escaped += "&gt;"; break;
+        case '"': escaped += "&quot;"; break;
+        default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void appendFormattedDouble(std::string& out, double value)
+{
+    // %g with 6 significant digits is what a std::ostream writes with its default settings
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    out.append(buffer, length > 0 ? static_cast<std::size_t>(length) : 0);
+}
+
+std::string formatDoubles(const double* values, std::size_t count)
+{
+    std::string formatted;
+    formatted.reserve(count * 14);
+    for (std::size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            formatted += ' ';
+        }
+        appendFormattedDouble(formatted, values[i]);
+    }
+    return formatted;
+}
@@ -15,7 +15,7 @@
 
  /*! @brief Do batch mode stuff
  */
-ProError evaluateBatchMode(const std::string& asm_path, const std::string& yaml_path, const std::string& csv_path, const std::string& output_path) {
+ProError evaluateBatchMode(const std::string& asm_path, const std::string& yaml_path, const std::string& csv_path, const std::string& output_path, const ShardSpec& shard) {
     if (asm_path.empty() || yaml_path.empty() || csv_path.empty() || output_path.empty()) { 
         return PRO_TK_BAD_INPUTS; // to be safe
     } 
@@ -27,20 +27,8 @@ ProError evaluateBatchMode(const std::string& asm_path, const std::string& yaml_
         return PRO_TK_GENERAL_ERROR;
     }
 
-    pfcModel_ptr asm_model_ptr{ nullptr };
-
-    try {
-        asm_model_ptr = session->RetrieveModel(pfcModelDescriptor::CreateFromFileName(asm_path.c_str()));
-    }
-    xcatchbegin
-    xcatchcip(defaultEx)
-    {
-        ProTKPrintf("Exception caught: %s", pfcXPFC::cast(defaultEx)->GetMessage());
-        return PRO_TK_E_NOT_FOUND;
-    }
-    xcatchend
-
-    Creo2Urdf creo2urdfApp(yaml_path, csv_path, output_path, asm_model_ptr);
+    // The assembly is retrieved by Creo2Urdf once the configuration is loaded, since it may ask for a simplified representation
+    Creo2Urdf creo2urdfApp(yaml_path, csv_path, output_path, asm_path, shard);
     creo2urdfApp.OnCommand();
     return err;
 }
@@ -71,10 +59,22 @@ extern "C" int user_initialize(
         csv_path.erase(std::find(csv_path.begin(), csv_path.end(), '+'));
         output_path.erase(std::find(output_path.begin(), output_path.end(), '+'));
 
+        // The workers of a sharded export receive their shard, e.g. +1/4, as fifth argument
+        ShardSpec shard;
+        if (argc > 5) {
+            std::string shard_arg = argv[5];
+            shard_arg.erase(std::find(shard_arg.begin(), shard_arg.end(), '+'));
+            if (!shard.parse(shard_arg)) {
+                ProTKPrintf("Creo2Urdf: invalid shard %s\n", shard_arg.c_str());
+                ProEngineerEnd();
+                return (int)PRO_TK_BAD_INPUTS;
+            }
+        }
+
         ProTKPrintf("Running in batch mode");
-        auto debug_msg = "Assembly path: " + asm_path + " yaml path " + yaml_path + " csv_path " + csv_path + " output_path " + output_path;
+        auto debug_msg = "Assembly path: " + asm_path + " yaml path " + yaml_path + " csv_path " + csv_path + " output_path " + output_path + " shard " + shard.toString();
         ProTKPrintf("%s\n", debug_msg.c_str());
-        ProError err = evaluateBatchMode(asm_path, yaml_path, csv_path, output_path);
+        ProError err = evaluateBatchMode(asm_path, yaml_path, csv_path, output_path, shard);
         ProEngineerEnd();
         return (int)err; // or whatever you want
     }
@@ -0,0 +1,148 @@
+/**
+ * @file ShardMergeCheck.cpp
+ * @brief Checks a sharded export without Creo: the stand-in worker is run for each shard through runWorkerCommands,
+ * and the shard files it writes are merged with mergeShardFiles, as the coordinator does. The merge is also checked
+ * with a missing shard and with a link listed by two shards with different mass properties.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/Shard.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+namespace {
+
+bool check(bool condition, const std::string& message)
+{
+    if (!condition) {
+        std::cerr << "FAILED: " << message << std::endl;
+    }
+    return condition;
+}
+
+bool checkParse()
+{
+    ShardSpec spec;
+    bool ok = check(spec.parse("1/4") && spec.index == 1 && spec.count == 4 && spec.toString() == "1/4", "1/4 is a valid shard");
+    for (const auto* invalid : { "4/4", "1/0", "a/2", "1/4x", "14", "" }) {
+        ok = check(!spec.parse(invalid), std::string(invalid) + " is not a valid shard") && ok;
+    }
+    return check(spec.index == 1 && spec.count == 4, "an invalid shard leaves the spec unchanged") && ok;
+}
+
+/**
+ * @brief Writes two shards listing the same part, with the same or with different mass properties, and merges them.
+ */
+bool checkDuplicateLinks(const std::string& output_path)
+{
+    ShardLink link;
+    link.name = "SHARED.PRT";
+    link.mass = 1.0;
+    link.com = { { 1.0, 2.0, 3.0 } };
+    link.inertia = { { 1.0, 0.0, 0.0, 0.0, 2.0, 0.0, 0.0, 0.0, 3.0 } };
+    link.volume = 0.5;
+
+    std::vector<std::string> filenames;
+    std::vector<Shard> shards(2);
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        shards[i].spec = ShardSpec{ i, shards.size() };
+        shards[i].links.push_back(link);
+        filenames.push_back(output_path + "/" + Shard::getFileName(i));
+    }
+
+    bool ok = true;
+    for (const bool conflicting : { false, true }) {
+        shards[1].links[0].mass = conflicting ? 2.0 : link.mass;
+        for (std::size_t i = 0; i < shards.size(); i++) {
+            ok = check(shards[i].save(filenames[i]), "the file of shard " + std::to_string(i) + " is written") && ok;
+        }
+        std::map<std::string, ShardLink> merged;
+        std::vector<std::string> warnings;
+        const bool merged_ok = mergeShardFiles(filenames, { 0, 0 }, merged, warnings);
+        if (conflicting) {
+            ok = check(!merged_ok && warnings.size() == 1 && warnings[0].find(link.name) != std::string::npos,
+                       "a link with different mass properties in two shards is reported") && ok;
+        }
+        else {
+            ok = check(merged_ok && warnings.empty() && merged.size() == 1, "a link with the same mass properties in two shards is merged") && ok;
+        }
+    }
+    for (const auto& filename : filenames) {
+        std::remove(filename.c_str());
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: shard_merge_check <path of shard_worker_standin> [number of shards] [number of components]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::size_t nr_of_shards = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    const std::size_t nr_of_components = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 37;
+    const std::string output_path = ".";
+
+    bool ok = checkParse();
+
+    const std::string command = "\"" + std::string(argv[1]) + "\" \"{asm}\" \"{yaml}\" \"{csv}\" \"{output}\" \"{shard}\"";
+    std::vector<std::string> commands;
+    for (std::size_t i = 0; i < nr_of_shards; i++) {
+        const ShardSpec spec{ i, nr_of_shards };
+        commands.push_back(expandWorkerCommand(command, std::to_string(nr_of_components), "config.yml", "joints.csv", output_path, spec));
+        ok = check(commands.back().find("\"" + spec.toString() + "\"") != std::string::npos, "the command of shard " + spec.toString() + " is expanded") && ok;
+    }
+
+    const auto exit_codes = runWorkerCommands(commands);
+    for (std::size_t i = 0; i < exit_codes.size(); i++) {
+        ok = check(exit_codes[i] == 0, "worker " + std::to_string(i) + " exits with 0, got " + std::to_string(exit_codes[i])) && ok;
+    }
+
+    // The links of all the shards are merged by name, as in Creo2Urdf::mergeShards
+    std::vector<std::string> filenames;
+    for (std::size_t i = 0; i < nr_of_shards; i++) {
+        filenames.push_back(output_path + "/" + Shard::getFileName(i));
+    }
+    std::map<std::string, ShardLink> merged;
+    std::vector<std::string> warnings;
+    ok = check(mergeShardFiles(filenames, exit_codes, merged, warnings) && warnings.empty(), "the shards are merged without warnings") && ok;
+    for (const auto& warning : warnings) {
+        std::cerr << warning << std::endl;
+    }
+
+    // Without the file of the last shard the merge fails, reporting it
+    if (nr_of_shards > 1) {
+        std::remove(filenames.back().c_str());
+        std::map<std::string, ShardLink> partial;
+        std::vector<std::string> missing_warnings;
+        ok = check(!mergeShardFiles(filenames, exit_codes, partial, missing_warnings) && missing_warnings.size() == 1 &&
+                   missing_warnings[0].find(Shard::getFileName(nr_of_shards - 1)) != std::string::npos, "a missing shard is reported") && ok;
+    }
+    for (const auto& filename : filenames) {
+        std::remove(filename.c_str());
+    }
+
+    ok = check(merged.size() == nr_of_components, "all the components are merged, got " + std::to_string(merged.size())) && ok;
+    for (std::size_t position = 0; position < nr_of_components; position++) {
+        const auto link = merged.find("PART_" + std::to_string(position) + ".PRT");
+        if (link == merged.end()) {
+            continue;
+        }
+        const double p = static_cast<double>(position);
+        ok = check(link->second.mass == p + 1.0 && link->second.com[2] == 3.0 * p && link->second.inertia[8] == p + 3.0 &&
+                   link->second.volume == 0.5 * (p + 1.0), link->first + " keeps its mass properties") && ok;
+    }
+
+    ok = checkDuplicateLinks(output_path) && ok;
+
+    std::cout << (ok ? "Merged " : "Failed to merge ") << nr_of_components << " components from " << nr_of_shards << " shards" << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
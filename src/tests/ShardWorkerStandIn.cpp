@@ -0,0 +1,52 @@
+/**
+ * @file ShardWorkerStandIn.cpp
+ * @brief Stand-in for a batch Creo worker of a sharded export, writing the shard file of a synthetic assembly
+ * without using Creo. It takes the arguments of the worker command: assembly, yaml, csv, output folder and shard.
+ * In place of the path of the assembly it reads the number of top-level components of the synthetic assembly.
+ * @copyright (C) 2006-2024 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <creo2urdf/Shard.h>
+
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+    if (argc != 6) {
+        std::cerr << "Usage: shard_worker_standin <number of components> <yaml> <csv> <output folder> <shard>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Shard shard;
+    if (!shard.spec.parse(argv[5])) {
+        std::cerr << "Invalid shard " << argv[5] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The mass properties of each component are derived from its position, so that the merge can be checked
+    const std::size_t nr_of_components = std::strtoul(argv[1], nullptr, 10);
+    for (std::size_t position = 0; position < nr_of_components; position++) {
+        if (!shard.spec.owns(position)) {
+            continue;
+        }
+        const double p = static_cast<double>(position);
+        ShardLink link;
+        link.name = "PART_" + std::to_string(position) + ".PRT";
+        link.mass = p + 1.0;
+        link.com = { { p, 2.0 * p, 3.0 * p } };
+        link.inertia = { { p + 1.0, 0.0, 0.0, 0.0, p + 2.0, 0.0, 0.0, 0.0, p + 3.0 } };
+        link.volume = 0.5 * (p + 1.0);
+        shard.links.push_back(link);
+    }
+
+    const std::string shard_file = std::string(argv[4]) + "/" + Shard::getFileName(shard.spec.index);
+    if (!shard.save(shard_file)) {
+        std::cerr << "Failed to write " << shard_file << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}